@@ -16,14 +16,17 @@ DEFINES += QT_DEPRECATED_WARNINGS
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    appregistry/appregistry.cpp \
     arcprogressbar/arcprogressbar.cpp \
     backlightwidget/backlightwidget.cpp \
     calculatorwidget/calculatorwidget.cpp \
     camerawidget/camerawidget.cpp \
     colordashboard/colordashboard.cpp \
     dynamicline/dynamicline.cpp \
+    dynamicline/minmaxpyramid.cpp \
+    dynamicline/stripchart.cpp \
     electricitywidget/electricitywidget.cpp \
-    illuminationwidget/illuminationthread.cpp \
+    frameclock/frameclock.cpp \
     illuminationwidget/illuminationwidget.cpp \
     infraredwidget/infraredwidget.cpp \
     keywidget/keywidget.cpp \
@@ -31,26 +34,36 @@ SOURCES += \
     mainwindowctrl.cpp \
     mainwindowui.cpp \
     mapwidget/mapwidget.cpp \
+    modulemanager/modulemanager.cpp \
     musicwidget/musicwidget.cpp \
     oledwidget/drawwidget.cpp \
+    oledwidget/oleddisplay.cpp \
     oledwidget/oledwidget.cpp \
     other/other.cpp \
+    perfhud/perfapplication.cpp \
+    perfhud/perfhud.cpp \
     photosensitivewidget/photosensitivewidget.cpp \
     recorderwidget/recorderwidget.cpp \
     remotecontrolwidget/remotectrlwidget.cpp \
+    sensorengine/iiodevice.cpp \
+    sensorengine/sensorengine.cpp \
     simplemessagebox/simplemessagebox.cpp \
+    stylesheet/stylesheetcache.cpp \
     sliderwidget/sliderwidget.cpp \
     systemwidget/systemwidget.cpp \
-    temperaturewidget/temperaturethread.cpp \
     temperaturewidget/temperaturewidget.cpp \
     topwidget/topwidget.cpp \
-    ultrasonicwavewidget/ultrasonicwavethread.cpp \
+    tsstore/blockarchive.cpp \
+    tsstore/gorillacodec.cpp \
+    tsstore/ringfile.cpp \
+    tsstore/timeseriesstore.cpp \
     ultrasonicwavewidget/ultrasonicwavewidget.cpp \
     videowidget/videowidget.cpp \
     wareprogressbar/wareprogressbar.cpp \
     weatherwidget/weatherwidget.cpp
 
 HEADERS += \
+    appregistry/appregistry.h \
     arcprogressbar/arcprogressbar.h \
     backlightwidget/backlightwidget.h \
     calculatorwidget/calculatorwidget.h \
@@ -58,27 +71,41 @@ HEADERS += \
     colordashboard/colordashboard.h \
     commonhelper.h \
     dynamicline/dynamicline.h \
+    dynamicline/minmaxpyramid.h \
+    dynamicline/stripchart.h \
     electricitywidget/electricitywidget.h \
-    illuminationwidget/illuminationthread.h \
+    frameclock/frameclock.h \
     illuminationwidget/illuminationwidget.h \
     infraredwidget/infraredwidget.h \
     keywidget/keywidget.h \
     mainwindow.h \
     mapwidget/mapwidget.h \
+    modulemanager/modulemanager.h \
     musicwidget/musicwidget.h \
     oledwidget/drawwidget.h \
+    oledwidget/oleddisplay.h \
     oledwidget/oledwidget.h \
     other/other.h \
+    perfhud/perfapplication.h \
+    perfhud/perfhud.h \
     photosensitivewidget/photosensitivewidget.h \
     recorderwidget/recorderwidget.h \
     remotecontrolwidget/remotectrlwidget.h \
+    sensorengine/iiodevice.h \
+    sensorengine/sensorengine.h \
+    sensorengine/seqlockcell.h \
+    sensorengine/spscring.h \
     simplemessagebox/simplemessagebox.h \
+    stylesheet/stylesheetcache.h \
     sliderwidget/sliderwidget.h \
     systemwidget/systemwidget.h \
-    temperaturewidget/temperaturethread.h \
     temperaturewidget/temperaturewidget.h \
     topwidget/topwidget.h \
-    ultrasonicwavewidget/ultrasonicwavethread.h \
+    tsstore/blockarchive.h \
+    tsstore/checksum.h \
+    tsstore/gorillacodec.h \
+    tsstore/ringfile.h \
+    tsstore/timeseriesstore.h \
     ultrasonicwavewidget/ultrasonicwavewidget.h \
     videowidget/videowidget.h \
     wareprogressbar/wareprogressbar.h \
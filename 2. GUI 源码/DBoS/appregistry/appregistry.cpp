@@ -0,0 +1,253 @@
+#include "appregistry.h"
+
+#include <QCursor>
+#include <QDir>
+#include <QKeyEvent>
+#include <QPixmap>
+
+#include <algorithm>
+#include <malloc.h>
+
+namespace {
+
+constexpr int PrewarmIntervalMs = 100;  // 两次预热构造之间的间隔，期间处理触摸等输入事件
+
+qint64 heapUsage()
+{
+    struct mallinfo info = ::mallinfo();
+
+    // uordblks：brk 堆中已分配的字节；hblkhd：mmap 分配的大块（图片像素数据等）
+    return qint64(uint(info.uordblks)) + qint64(uint(info.hblkhd));
+}
+
+}
+
+AppRegistry::AppRegistry(QWidget *host) : QObject(host), m_pHost(host),
+    m_settings(QDir::homePath() + "/.dbos/apps.ini", QSettings::IniFormat)
+{
+    m_prewarmTimer.setInterval(PrewarmIntervalMs);
+    connect(&m_prewarmTimer, &QTimer::timeout, this, &AppRegistry::prewarmNext);
+}
+
+AppRegistry::~AppRegistry()
+{
+    // 页面是宿主窗口的子对象，由宿主窗口销毁
+    qDeleteAll(m_apps);
+}
+
+void AppRegistry::registerApp(const QString &id, const Factory &factory, bool isPoolable)
+{
+    auto app = new App;
+    app->id = id;
+    app->factory = factory;
+    app->isPoolable = isPoolable;
+
+    m_apps.append(app);
+    m_appIds.insert(id, app);
+}
+
+void AppRegistry::setMemoryBudget(qint64 bytes)
+{
+    m_memoryBudget = bytes;
+
+    evict();
+}
+
+void AppRegistry::prewarm(int delayMs)
+{
+    loadLaunches();
+
+    m_prewarmQueue.clear();
+    for (auto app : m_apps) {
+        if (app->isPoolable) {
+            m_prewarmQueue.append(app);
+        }
+    }
+
+    // 打开次数多的页面优先；次数相同时按注册顺序
+    std::stable_sort(m_prewarmQueue.begin(), m_prewarmQueue.end(), [](const App *a, const App *b) {
+        return a->launches > b->launches;
+    });
+
+    QTimer::singleShot(delayMs, &m_prewarmTimer, static_cast<void (QTimer::*)()>(&QTimer::start));
+}
+
+void AppRegistry::prewarmNext()
+{
+    // 有页面正在显示时暂停，不与用户操作争抢 CPU
+    if (m_pCurrent != nullptr) {
+        return;
+    }
+
+    while (!m_prewarmQueue.isEmpty() && !m_prewarmQueue.first()->dialog.isNull()) {
+        m_prewarmQueue.removeFirst();
+    }
+
+    if (m_prewarmQueue.isEmpty() || pooledCost() >= m_memoryBudget) {
+        m_prewarmTimer.stop();
+        m_prewarmQueue.clear();
+        return;
+    }
+
+    auto app = m_prewarmQueue.takeFirst();
+    construct(app);
+
+    // 超出预算时撤销本次预热，后面的页面更少使用，不再继续
+    if (pooledCost() > m_memoryBudget) {
+        delete app->dialog;
+        app->cost = 0;
+        m_prewarmTimer.stop();
+        m_prewarmQueue.clear();
+    }
+}
+
+void AppRegistry::launch(const QString &id)
+{
+    auto app = m_appIds.value(id);
+    if (app == nullptr) {
+        return;
+    }
+
+    m_prewarmQueue.removeAll(app);
+
+    if (app->dialog.isNull()) {
+        construct(app);
+    }
+
+    m_pCurrent = app;
+    app->dialog->show();
+    app->dialog->raise();
+    app->dialog->activateWindow();
+
+    app->lastUsed = ++m_clock;
+    ++app->launches;
+    saveLaunches(app);
+}
+
+void AppRegistry::construct(App *app)
+{
+    qint64 before = heapUsage();
+
+    auto dialog = app->factory(m_pHost);
+    dialog->installEventFilter(this);
+    dialog->setFixedSize(m_pHost->size());
+    dialog->setCursor(QCursor(QPixmap(":/misc/resource/image/point.png"), -1, -1));
+
+    // 样式表在第一次显示前才真正应用，在此提前完成，使预热页面显示时无需再解析
+    dialog->ensurePolished();
+
+    app->dialog = dialog;
+    app->cost = qMax<qint64>(heapUsage() - before, 0);
+}
+
+void AppRegistry::dismiss(App *app)
+{
+    auto dialog = app->dialog;
+
+    if (m_pCurrent == app) {
+        m_pCurrent = nullptr;
+    }
+
+    dialog->hide();
+
+    if (app->isPoolable) {
+        evict(app);
+    }
+    else {
+        dialog->removeEventFilter(this);
+        dialog->deleteLater();
+        app->dialog = nullptr;
+        app->cost = 0;
+    }
+}
+
+qint64 AppRegistry::pooledCost() const
+{
+    qint64 ret = 0;
+
+    for (auto app : m_apps) {
+        if (app->isPoolable && !app->dialog.isNull()) {
+            ret += app->cost;
+        }
+    }
+
+    return ret;
+}
+
+void AppRegistry::evict(const App *keep)
+{
+    while (pooledCost() > m_memoryBudget) {
+        App *victim = nullptr;
+
+        // 最久未使用的隐藏页面；刚关闭的页面最后考虑
+        for (auto app : m_apps) {
+            if (!app->isPoolable || app->dialog.isNull() || app == m_pCurrent || app == keep) {
+                continue;
+            }
+            if (victim == nullptr || app->lastUsed < victim->lastUsed) {
+                victim = app;
+            }
+        }
+
+        if (victim == nullptr) {
+            // 只剩刚关闭的页面：它自身超出预算，也销毁
+            if (keep == nullptr || keep->dialog.isNull()) {
+                return;
+            }
+            victim = const_cast<App *>(keep);
+        }
+
+        victim->dialog->deleteLater();
+        victim->dialog = nullptr;
+        victim->cost = 0;
+    }
+}
+
+bool AppRegistry::eventFilter(QObject *obj, QEvent *event)
+{
+    auto dialog = qobject_cast<QDialog *>(obj);
+    if (dialog == nullptr) {
+        return false;
+    }
+
+    bool isDismiss = (event->type() == QEvent::Close);
+    if (event->type() == QEvent::KeyPress) {
+        auto keyEvt = static_cast<QKeyEvent *>(event);
+        isDismiss = (keyEvt->key() == Qt::Key_Escape);
+    }
+
+    auto app = isDismiss ? find(dialog) : nullptr;
+    if (app == nullptr) {
+        return false;
+    }
+
+    dismiss(app);
+
+    return true;
+}
+
+AppRegistry::App *AppRegistry::find(const QDialog *dialog) const
+{
+    for (auto app : m_apps) {
+        if (app->dialog == dialog) {
+            return app;
+        }
+    }
+
+    return nullptr;
+}
+
+void AppRegistry::loadLaunches()
+{
+    m_settings.beginGroup("launches");
+    for (auto app : m_apps) {
+        app->launches = m_settings.value(app->id, 0).toInt();
+    }
+    m_settings.endGroup();
+}
+
+void AppRegistry::saveLaunches(const App *app)
+{
+    // QSettings 在事件循环空闲时才写入文件
+    m_settings.setValue("launches/" + app->id, app->launches);
+}
@@ -0,0 +1,73 @@
+#ifndef APPREGISTRY_H
+#define APPREGISTRY_H
+
+#include <QDialog>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QSettings>
+#include <QTimer>
+
+#include <functional>
+
+/* 桌面应用注册表
+ * 1. 页面在第一次打开时才构造
+ * 2. 无状态页面关闭时只隐藏，放入预热池，再次打开无需重新解析样式表、加载图片和布局
+ * 3. 其他页面（占用驱动、串口、摄像头等）关闭时销毁，释放硬件
+ * 4. 启动后在空闲时按打开次数预先构造最常用的无状态页面
+ * 5. 预热池按构造时的堆内存增量估算占用，超过预算时销毁最久未使用的隐藏页面
+ */
+class AppRegistry : public QObject
+{
+    Q_OBJECT
+
+public:
+    using Factory = std::function<QDialog *(QWidget *parent)>;
+
+    explicit AppRegistry(QWidget *host);
+    ~AppRegistry();
+
+    void registerApp(const QString &id, const Factory &factory, bool isPoolable = false);
+    void setMemoryBudget(qint64 bytes);
+    void prewarm(int delayMs);                  // delayMs 后开始在空闲时构造预热页面
+
+    void launch(const QString &id);
+
+protected:
+    bool eventFilter(QObject *obj, QEvent *event);
+
+private:
+    struct App {
+        QString id;
+        Factory factory;
+        bool isPoolable = false;
+        QPointer<QDialog> dialog;
+        qint64 cost = 0;                        // 构造时的堆内存增量
+        quint64 lastUsed = 0;
+        int launches = 0;
+    };
+
+    App *find(const QDialog *dialog) const;
+    void construct(App *app);
+    void dismiss(App *app);
+    void evict(const App *keep = nullptr);
+    qint64 pooledCost() const;
+    void prewarmNext();
+    void loadLaunches();
+    void saveLaunches(const App *app);
+
+private:
+    QWidget *m_pHost = nullptr;
+    QList<App *> m_apps;
+    QHash<QString, App *> m_appIds;
+    App *m_pCurrent = nullptr;
+    quint64 m_clock = 0;
+    qint64 m_memoryBudget = 16 * 1024 * 1024;
+    QSettings m_settings;                       // 各页面的打开次数，决定预热顺序
+
+    QTimer m_prewarmTimer;
+    QList<App *> m_prewarmQueue;
+};
+
+#endif // APPREGISTRY_H
@@ -16,20 +16,53 @@ ArcProgressBar::~ArcProgressBar()
 
 void ArcProgressBar::paintEvent(QPaintEvent *event)
 {
+    if (m_layerDirty || m_staticLayer.devicePixelRatioF() != devicePixelRatioF()) {
+        updateLayer();
+    }
+
     QPainter painter(this);
 
     painter.setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing, true);
+    painter.drawPixmap(0, 0, m_staticLayer);
     painter.translate(width()/2.0, height()/2.0);
-    m_radius = qMin(width(), height()) / 2.0;
 
     drawArc(&painter);
     drawValue(&painter);
-    drawTitle(&painter);
 
     return QWidget::paintEvent(event);
 }
 
-void ArcProgressBar::drawArc(QPainter *painter)
+void ArcProgressBar::resizeEvent(QResizeEvent *event)
+{
+    invalidateLayer();
+
+    return QWidget::resizeEvent(event);
+}
+
+void ArcProgressBar::invalidateLayer()
+{
+    m_layerDirty = true;
+    update();
+}
+
+void ArcProgressBar::updateLayer()
+{
+    m_radius = qMin(width(), height()) / 2.0;
+    m_layerDirty = false;
+
+    m_staticLayer = QPixmap(size() * devicePixelRatioF());
+    m_staticLayer.setDevicePixelRatio(devicePixelRatioF());
+    m_staticLayer.fill(Qt::transparent);
+
+    QPainter painter(&m_staticLayer);
+    painter.setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing, true);
+    painter.translate(width()/2.0, height()/2.0);
+
+    drawBaseArc(&painter);
+    drawTitle(&painter);
+}
+
+void ArcProgressBar::drawBaseArc(QPainter *painter)
 {
     double pen_width = m_radius * 0.17;
     double radius    = m_radius - pen_width;
@@ -40,16 +73,35 @@ void ArcProgressBar::drawArc(QPainter *painter)
     QPen pen;
     pen.setWidthF(pen_width);
     pen.setCapStyle(Qt::RoundCap);
+    pen.setColor(m_baseColor);
 
+    // 整段底色圆弧，进度圆弧画在其上
     painter->setBrush(Qt::NoBrush);
+    painter->setPen(pen);
+    painter->drawArc(rect, (270 - m_startAngle) * 16, -(m_endAngle - m_startAngle) * 16);
+
+    painter->restore();
+}
+
+void ArcProgressBar::drawArc(QPainter *painter)
+{
+    double pen_width = m_radius * 0.17;
+    double radius    = m_radius - pen_width;
+    QRectF rect(-radius, -radius, 2.0*radius, 2.0*radius);
 
     double allAngle   = m_endAngle - m_startAngle;
     double curAngle   = allAngle * (m_curValue - m_minValue) / (m_maxValue - m_minValue);
-    double otherAngle = allAngle - curAngle;
+    if (curAngle <= 0) {
+        return;
+    }
 
-    pen.setColor(m_baseColor);
-    painter->setPen(pen);
-    painter->drawArc(rect, (270 - m_startAngle-curAngle)*16, -otherAngle * 16);
+    painter->save();
+
+    QPen pen;
+    pen.setWidthF(pen_width);
+    pen.setCapStyle(Qt::RoundCap);
+
+    painter->setBrush(Qt::NoBrush);
 
     pen.setColor(m_arcColor);
     painter->setPen(pen);
@@ -129,7 +181,7 @@ void ArcProgressBar::setArcColor(const QColor &color)
 void ArcProgressBar::setBaseColor(const QColor &color)
 {
     m_baseColor = color;
-    update();
+    invalidateLayer();
 }
 
 void ArcProgressBar::setTextColor(const QColor &color)
@@ -141,13 +193,13 @@ void ArcProgressBar::setTextColor(const QColor &color)
 void ArcProgressBar::setTitleColor(const QColor &color)
 {
     m_titleColor = color;
-    update();
+    invalidateLayer();
 }
 
 void ArcProgressBar::setTitle(const QString &title)
 {
     m_title = title;
-    update();
+    invalidateLayer();
 }
 
 void ArcProgressBar::setRange(int minValue, int maxValue)
@@ -173,19 +225,19 @@ void ArcProgressBar::setAngleRange(int startAngle, int endAngle)
 {
     m_startAngle = startAngle;
     m_endAngle   = endAngle;
-    update();
+    invalidateLayer();
 }
 
 void ArcProgressBar::setStartAngle(int startAngle)
 {
     m_startAngle = startAngle;
-    update();
+    invalidateLayer();
 }
 
 void ArcProgressBar::setEndAngle(int endAngle)
 {
     m_endAngle   = endAngle;
-    update();
+    invalidateLayer();
 }
 
 void ArcProgressBar::setAnimationStepTime(int msec)
@@ -3,6 +3,7 @@
 
 #include <QWidget>
 #include <QColor>
+#include <QPixmap>
 #include <QString>
 #include <QPropertyAnimation>
 
@@ -13,6 +14,7 @@
  * 4. 可设置仪表盘标题
  * 5. 可设置背景、进度条、值、标题颜色
  * 6. 自适应窗体拉伸，文字自动缩放
+ * 7. 底色圆弧和标题缓存为 QPixmap，尺寸、角度或颜色变化时重绘，动画过程中只绘制进度圆弧和值
  */
 
 class ArcProgressBar : public QWidget
@@ -69,7 +71,12 @@ public slots:
 
 protected:
     void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
 
+    void invalidateLayer();                             // 静态图层失效，下次绘制时重绘
+    void updateLayer();
+
+    void drawBaseArc(QPainter *painter);
     void drawArc(QPainter *painter);
     void drawValue(QPainter *painter);
     void drawTitle(QPainter *painter);
@@ -100,6 +107,9 @@ private:
     QPropertyAnimation m_animation;
     int m_animationStepTime              = 5;
     QEasingCurve::Type m_easingCurveType = QEasingCurve::Linear;
+
+    QPixmap m_staticLayer;                              // 底色圆弧、标题
+    bool m_layerDirty = true;
 };
 
 #endif // ARCPROGRESSBAR_H
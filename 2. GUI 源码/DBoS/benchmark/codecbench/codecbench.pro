@@ -0,0 +1,15 @@
+QT       -= gui
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = codecbench
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    main.cpp \
+    ../../tsstore/gorillacodec.cpp
+
+HEADERS += \
+    ../../tsstore/gorillacodec.h
@@ -0,0 +1,168 @@
+#include "tsstore/gorillacodec.h"
+
+#include <QElapsedTimer>
+#include <QVector>
+
+#include <math.h>
+#include <random>
+#include <stdio.h>
+
+/* Gorilla 编码基准
+ * 按各传感器的采样周期与数值特征生成一周的模拟数据，按 BlockArchive 的块大小编码，
+ * 输出每个样本的字节数、编码与解码吞吐量，以及解码一周数据所需的时间
+ */
+
+namespace {
+
+constexpr int BlockSamples    = 4096;   // 与 BlockArchive::BlockSamples 一致
+constexpr int BlockHeaderSize = 40;     // BlockArchive 每块的块头字节数
+constexpr qint64 WeekMsecs    = 7 * 24 * 3600 * 1000LL;
+
+struct Sample {
+    qint64 msecs;
+    double value;
+};
+
+struct Profile {
+    const char *name;
+    int intervalMs;
+    Gorilla::Coding coding;
+    double (*next)(std::mt19937 &rng, double last);
+};
+
+double nextTemperature(std::mt19937 &rng, double last)
+{
+    // DHT11：0.1 ℃ 分辨率，缓慢变化
+    if (rng() % 20 != 0) {
+        return last;
+    }
+    return round((last + ((rng() % 2) ? 0.1 : -0.1)) * 10) / 10;
+}
+
+double nextHumidity(std::mt19937 &rng, double last)
+{
+    if (rng() % 30 != 0) {
+        return last;
+    }
+    return qBound(5.0, last + ((rng() % 2) ? 1.0 : -1.0), 95.0);
+}
+
+double nextAls(std::mt19937 &rng, double last)
+{
+    // AP3216C：16 位计数值，带少量噪声
+    return qBound(0.0, last + int(rng() % 11) - 5, 65535.0);
+}
+
+double nextDistance(std::mt19937 &rng, double last)
+{
+    // SR04：毫米整数，噪声较大
+    return qBound(20.0, last + int(rng() % 41) - 20, 4000.0);
+}
+
+QVector<Sample> generate(const Profile &profile, double first)
+{
+    std::mt19937 rng(1);
+    QVector<Sample> ret;
+    qint64 msecs = 1600000000000LL;
+    double value = first;
+
+    ret.reserve(int(WeekMsecs / profile.intervalMs) + 1);
+    for (qint64 t=0; t<WeekMsecs; t+=profile.intervalMs) {
+        // 采样时刻由单调时钟换算而来，带几毫秒的抖动
+        msecs += profile.intervalMs + int(rng() % 5) - 2;
+        value = profile.next(rng, value);
+        ret.append(Sample{msecs, value});
+    }
+
+    return ret;
+}
+
+void run(const Profile &profile, double first)
+{
+    QVector<Sample> samples = generate(profile, first);
+    QVector<QByteArray> blocks;
+    QVector<int> counts;
+    QElapsedTimer timer;
+
+    timer.start();
+    Gorilla::Encoder encoder(profile.coding);
+    for (const auto &sample : samples) {
+        encoder.append(sample.msecs, sample.value);
+        if (encoder.count() == BlockSamples) {
+            blocks.append(encoder.data());
+            counts.append(encoder.count());
+            encoder.clear();
+        }
+    }
+    if (encoder.count() > 0) {
+        blocks.append(encoder.data());
+        counts.append(encoder.count());
+    }
+    qint64 encodeNs = timer.nsecsElapsed();
+
+    qint64 bytes = 0;
+    for (const auto &block : blocks) {
+        bytes += block.size() + BlockHeaderSize;
+    }
+
+    timer.restart();
+    qint64 decoded = 0;
+    double checksum = 0;
+    for (int i=0; i<blocks.count(); ++i) {
+        Gorilla::Decoder decoder(blocks.at(i).constData(), blocks.at(i).size(), counts.at(i), profile.coding);
+        qint64 msecs;
+        double value;
+        while (decoder.next(msecs, value)) {
+            checksum += value;
+            ++decoded;
+        }
+    }
+    qint64 decodeNs = timer.nsecsElapsed();
+
+    bool isExact = (decoded == samples.count());
+    for (int i=0, n=0; isExact && i<blocks.count(); ++i) {
+        Gorilla::Decoder decoder(blocks.at(i).constData(), blocks.at(i).size(), counts.at(i), profile.coding);
+        qint64 msecs;
+        double value;
+        while (isExact && decoder.next(msecs, value)) {
+            isExact = (msecs == samples.at(n).msecs) && (value == samples.at(n).value);
+            ++n;
+        }
+    }
+
+    printf("%-18s %-11s %9d %10.3f %12.2f %12.2f %10.1f  %s\n",
+           profile.name,
+           (profile.coding == Gorilla::XorFloat) ? "XorFloat" : "DeltaVarint",
+           samples.count(),
+           double(bytes) / samples.count(),
+           samples.count() * 1000.0 / qMax<qint64>(encodeNs, 1),
+           decoded * 1000.0 / qMax<qint64>(decodeNs, 1),
+           decodeNs / 1e6,
+           isExact ? "ok" : "MISMATCH");
+
+    Q_UNUSED(checksum)
+}
+
+}
+
+int main()
+{
+    const Profile profiles[] = {
+        {"dht11_temperature", 1500, Gorilla::XorFloat,    nextTemperature},
+        {"dht11_humidity",    1500, Gorilla::XorFloat,    nextHumidity},
+        {"ap3216c_als",        200, Gorilla::DeltaVarint, nextAls},
+        {"ap3216c_als",        200, Gorilla::XorFloat,    nextAls},
+        {"sr04_distance",      300, Gorilla::DeltaVarint, nextDistance},
+        {"sr04_distance",      300, Gorilla::XorFloat,    nextDistance},
+    };
+    const double firsts[] = {23.4, 45, 300, 300, 1200, 1200};
+
+    printf("one week per series, %d samples per block, %d-byte block header included\n\n", BlockSamples, BlockHeaderSize);
+    printf("%-18s %-11s %9s %10s %12s %12s %10s\n", "series", "coding", "samples", "B/sample", "enc Msps", "dec Msps", "week ms");
+
+    for (int i=0; i<int(sizeof(profiles) / sizeof(profiles[0])); ++i) {
+        run(profiles[i], firsts[i]);
+    }
+
+    return 0;
+}
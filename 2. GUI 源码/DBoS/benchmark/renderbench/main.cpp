@@ -0,0 +1,450 @@
+#include "arcprogressbar/arcprogressbar.h"
+#include "colordashboard/colordashboard.h"
+#include "dynamicline/dynamicline.h"
+#include "oledwidget/drawwidget.h"
+#include "sliderwidget/sliderwidget.h"
+#include "wareprogressbar/wareprogressbar.h"
+
+#include <QApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QGridLayout>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMouseEvent>
+#include <QPaintEvent>
+#include <QPushButton>
+#include <QThread>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* 自绘控件渲染基准
+ * 在 offscreen 平台上按 1024x600 屏幕中的实际尺寸逐帧驱动各控件，每帧计时的范围为：
+ *   修改控件状态（值、样本、翻页、鼠标轨迹）+ 处理事件（合并刷新、动画时钟、重绘到 backing store）
+ * 输出每帧耗时、堆分配次数、paintEvent 次数，以及各 paintEvent 重绘区域的面积之和（退化为整控件重绘时明显增大）
+ * 用法：renderbench [-n 帧数] [--json] [场景名前缀 ...]
+ *   --json 时结果以 JSON 输出到标准输出，便于不同提交之间比较
+ * 不需要显示设备，未设置 QT_QPA_PLATFORM 时使用 offscreen
+ */
+
+namespace {
+
+std::atomic<bool> g_isCounting(false);
+std::atomic<long> g_allocs(0);
+
+}
+
+#ifdef __GLIBC__
+// 替换 glibc 的分配函数统计堆分配次数，Qt 容器与 operator new 最终都经过这里
+extern "C" {
+
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size) __THROW
+{
+    if (g_isCounting.load(std::memory_order_relaxed)) {
+        g_allocs.fetch_add(1, std::memory_order_relaxed);
+    }
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) __THROW
+{
+    if (g_isCounting.load(std::memory_order_relaxed)) {
+        g_allocs.fetch_add(1, std::memory_order_relaxed);
+    }
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) __THROW
+{
+    if (g_isCounting.load(std::memory_order_relaxed)) {
+        g_allocs.fetch_add(1, std::memory_order_relaxed);
+    }
+    return __libc_realloc(ptr, size);
+}
+
+}
+#endif
+
+namespace {
+
+constexpr int WarmupFrames = 10;
+
+struct Scenario {
+    const char *name;
+    QSize size;
+    int paceMs;                                         // 0 为连续渲染；否则按该周期推进，等待时间不计入
+    std::function<QWidget *()> create;
+    std::function<void(QWidget *, int frame)> step;
+};
+
+struct Result {
+    QString name;
+    QSize size;
+    int frames = 0;
+    double meanNs = 0;
+    qint64 p50Ns = 0;
+    qint64 p99Ns = 0;
+    qint64 maxNs = 0;
+    double allocs = 0;
+    double paints = 0;
+    double paintedPixels = 0;
+};
+
+class PaintCounter : public QObject
+{
+public:
+    long count = 0;
+    qint64 area = 0;                                    // 重绘区域面积之和，逻辑像素
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override
+    {
+        if (event->type() == QEvent::Paint && watched->isWidgetType() && g_isCounting.load(std::memory_order_relaxed)) {
+            ++count;
+            for (const QRect &rect : static_cast<QPaintEvent *>(event)->region()) {
+                area += qint64(rect.width()) * rect.height();
+            }
+        }
+        return false;
+    }
+};
+
+// QChartView 的场景更新先排队再请求重绘，处理两轮才能保证本帧的修改绘制完成
+void pump()
+{
+    QCoreApplication::processEvents();
+    QCoreApplication::processEvents();
+}
+
+Result run(const Scenario &scenario, int frames, PaintCounter &counter)
+{
+    QScopedPointer<QWidget> widget(scenario.create());
+    widget->resize(scenario.size);
+    widget->show();
+    pump();
+
+    QVector<qint64> times;
+    long allocs = 0;
+    long paints = 0;
+    qint64 paintedPixels = 0;
+    QElapsedTimer pace;
+    qint64 deadline = 0;
+
+    times.reserve(frames);
+    pace.start();
+
+    for (int frame=-WarmupFrames; frame<frames; ++frame) {
+        if (scenario.paceMs > 0) {
+            deadline += scenario.paceMs;
+            qint64 wait = deadline - pace.elapsed();
+            if (wait > 0) {
+                QThread::msleep(wait);
+            }
+        }
+
+        QElapsedTimer timer;
+        g_allocs = 0;
+        counter.count = 0;
+        counter.area = 0;
+        g_isCounting = true;
+
+        timer.start();
+        scenario.step(widget.data(), frame + WarmupFrames);
+        pump();
+        qint64 ns = timer.nsecsElapsed();
+
+        g_isCounting = false;
+
+        if (frame < 0) {
+            continue;
+        }
+
+        times.append(ns);
+        allocs += g_allocs;
+        paints += counter.count;
+        paintedPixels += counter.area;
+    }
+
+    Result ret;
+    ret.name = scenario.name;
+    ret.size = scenario.size;
+    ret.frames = frames;
+
+    if (frames > 0) {
+        qint64 total = 0;
+        for (auto ns : times) {
+            total += ns;
+        }
+
+        std::sort(times.begin(), times.end());
+        ret.meanNs = double(total) / frames;
+        ret.p50Ns = times.at(frames / 2);
+        ret.p99Ns = times.at(qMin(frames - 1, frames * 99 / 100));
+        ret.maxNs = times.last();
+        ret.allocs = double(allocs) / frames;
+        ret.paints = double(paints) / frames;
+        ret.paintedPixels = double(paintedPixels) / frames;
+    }
+
+    return ret;
+}
+
+QWidget *createDynamicLine(DynamicLine::Backend backend)
+{
+    auto line = new DynamicLine;
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    line->setUpdateMode(DynamicLine::SampleDriven);
+    line->setBackend(backend);
+    line->setTimeAxisXSpanSecs(60);
+    line->setAxisYRange(0, 100);
+    line->addSplineSeries("temperature", QPen(QColor(255, 107, 107), 2));
+    line->addSplineSeries("humidity", QPen(QColor(24, 189, 155), 2));
+
+    // 回填一分钟的历史，图表从满屏开始滚动
+    for (int index=0; index<line->count(); ++index) {
+        QVector<QPointF> points;
+        for (qint64 msecs=now-60000; msecs<now; msecs+=40) {
+            points.append(QPointF(msecs, 50 + 40 * sin(msecs / 1000.0 + index)));
+        }
+        line->backfill(index, points);
+    }
+
+    line->start();
+
+    return line;
+}
+
+void stepDynamicLine(QWidget *widget, int frame)
+{
+    Q_UNUSED(frame)
+
+    auto line = static_cast<DynamicLine *>(widget);
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    for (int index=0; index<line->count(); ++index) {
+        line->appendSample(index, now, 50 + 40 * sin(now / 1000.0 + index));
+    }
+}
+
+QWidget *createSliderWidget()
+{
+    auto slider = new SliderWidget;
+
+    for (int page=0; page<2; ++page) {
+        auto pWidget = new QWidget;
+        auto pLayout = new QGridLayout(pWidget);
+
+        for (int i=0; i<10; ++i) {
+            auto pButton = new QPushButton(QString("应用 %1").arg(page * 10 + i + 1));
+            pButton->setFixedSize(140, 140);
+            pLayout->addWidget(pButton, i / 5, i % 5);
+        }
+
+        slider->addWidget(pWidget);
+    }
+
+    return slider;
+}
+
+void stepSliderWidget(QWidget *widget, int frame)
+{
+    // 每 20 帧翻一页，翻页动画 200 ms
+    if (frame % 20 == 0) {
+        static_cast<SliderWidget *>(widget)->setCurrentIndex((frame / 20) % 2);
+    }
+}
+
+void stepDrawWidget(QWidget *widget, int frame)
+{
+    // 每 60 帧画完一笔，已完成的笔画每帧都会重绘
+    int stroke = frame / 60;
+    double t = (frame % 60) / 60.0 * 2 * M_PI;
+    QPointF pos(512 + 400 * sin(t + stroke), 300 + 250 * sin(2 * t + stroke));
+    QEvent::Type type = QEvent::MouseMove;
+    Qt::MouseButton button = Qt::NoButton;
+    Qt::MouseButtons buttons = Qt::LeftButton;
+
+    if (frame % 60 == 0) {
+        type = QEvent::MouseButtonPress;
+        button = Qt::LeftButton;
+    }
+    else if (frame % 60 == 59) {
+        type = QEvent::MouseButtonRelease;
+        button = Qt::LeftButton;
+        buttons = Qt::NoButton;
+    }
+
+    QMouseEvent event(type, pos, button, buttons, Qt::NoModifier);
+    QCoreApplication::sendEvent(widget, &event);
+}
+
+QJsonObject toJson(const Result &result)
+{
+    QJsonObject ret;
+
+    ret["name"] = result.name;
+    ret["width"] = result.size.width();
+    ret["height"] = result.size.height();
+    ret["frames"] = result.frames;
+    ret["ns_per_frame"] = result.meanNs;
+    ret["p50_ns"] = double(result.p50Ns);
+    ret["p99_ns"] = double(result.p99Ns);
+    ret["max_ns"] = double(result.maxNs);
+#ifdef __GLIBC__
+    ret["allocs_per_frame"] = result.allocs;
+#else
+    ret["allocs_per_frame"] = QJsonValue();
+#endif
+    ret["paints_per_frame"] = result.paints;
+    ret["painted_pixels_per_frame"] = result.paintedPixels;
+
+    return ret;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QApplication app(argc, argv);
+
+    int frames = 300;
+    bool isJson = false;
+    QStringList filters;
+
+    const QStringList args = app.arguments().mid(1);
+    for (int i=0; i<args.count(); ++i) {
+        if (args.at(i) == "-n" && i + 1 < args.count()) {
+            frames = qMax(1, args.at(++i).toInt());
+        }
+        else if (args.at(i) == "--json") {
+            isJson = true;
+        }
+        else {
+            filters << args.at(i);
+        }
+    }
+
+    // 尺寸取自各页面在 1024x600 屏幕上的布局
+    const Scenario scenarios[] = {
+        {"colordashboard", QSize(480, 480), 0,
+         []() {
+             auto dashboard = new ColorDashboard;
+             dashboard->setRange(0, 4096);
+             dashboard->setScaleMajor(9);
+             dashboard->setScaleMinor(10);
+             dashboard->setAnimationStepTime(0);
+             dashboard->setPointerStyle(ColorDashboard::PointerStyle_Triangle);
+             return dashboard;
+         },
+         [](QWidget *widget, int frame) {
+             static_cast<ColorDashboard *>(widget)->setValue(int(2048 + 2000 * sin(frame * 0.05)));
+         }},
+        {"colordashboard_small", QSize(240, 240), 0,
+         []() {
+             auto dashboard = new ColorDashboard;
+             dashboard->setAnimationStepTime(0);
+             dashboard->setPieStyle(ColorDashboard::PieStyle_Three);
+             return dashboard;
+         },
+         [](QWidget *widget, int frame) {
+             static_cast<ColorDashboard *>(widget)->setValue(int(120 + 110 * sin(frame * 0.05)));
+         }},
+        {"arcprogressbar", QSize(300, 300), 0,
+         []() {
+             auto bar = new ArcProgressBar;
+             bar->setRange(0, 100);
+             bar->setAnimationStepTime(0);
+             return bar;
+         },
+         [](QWidget *widget, int frame) {
+             static_cast<ArcProgressBar *>(widget)->setValue(frame % 101);
+         }},
+        {"wareprogressbar", QSize(300, 300), 0,
+         []() { return new WareProgressBar; },
+         [](QWidget *widget, int frame) {
+             static_cast<WareProgressBar *>(widget)->setValue(int(50 + 45 * sin(frame * 0.05)));
+         }},
+        {"wareprogressbar_small", QSize(150, 150), 0,
+         []() { return new WareProgressBar; },
+         [](QWidget *widget, int frame) {
+             static_cast<WareProgressBar *>(widget)->setValue(int(50 + 45 * sin(frame * 0.05)));
+         }},
+        {"dynamicline_chart", QSize(1024, 480), 40,
+         []() { return createDynamicLine(DynamicLine::ChartBackend); },
+         stepDynamicLine},
+        {"dynamicline_raster", QSize(1024, 480), 40,
+         []() { return createDynamicLine(DynamicLine::RasterBackend); },
+         stepDynamicLine},
+        {"sliderwidget", QSize(1024, 600), 16,
+         createSliderWidget,
+         stepSliderWidget},
+        {"drawwidget", QSize(1024, 600), 0,
+         []() { return new DrawWidget; },
+         stepDrawWidget},
+    };
+
+    PaintCounter counter;
+    app.installEventFilter(&counter);
+
+    QJsonArray results;
+
+    if (!isJson) {
+        printf("platform %s, %d frames per scenario after %d warm-up frames\n\n", qPrintable(QGuiApplication::platformName()), frames, WarmupFrames);
+        printf("%-22s %9s %12s %12s %12s %10s %8s %12s\n", "scenario", "size", "ns/frame", "p99 ns", "max ns", "allocs", "paints", "painted px");
+    }
+
+    for (const auto &scenario : scenarios) {
+        bool isSelected = filters.isEmpty();
+        for (const auto &filter : filters) {
+            isSelected = isSelected || QString(scenario.name).startsWith(filter);
+        }
+        if (!isSelected) {
+            continue;
+        }
+
+        Result result = run(scenario, frames, counter);
+
+        if (isJson) {
+            results.append(toJson(result));
+            continue;
+        }
+
+        printf("%-22s %4dx%-4d %12.0f %12lld %12lld %10.1f %8.2f %12.0f\n",
+               scenario.name,
+               result.size.width(), result.size.height(),
+               result.meanNs,
+               result.p99Ns,
+               result.maxNs,
+               result.allocs,
+               result.paints,
+               result.paintedPixels);
+    }
+
+    if (isJson) {
+        QJsonObject root;
+        root["qt"] = QString(qVersion());
+        root["platform"] = QGuiApplication::platformName();
+        root["time"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+        root["warmup_frames"] = WarmupFrames;
+        root["results"] = results;
+
+        printf("%s", QJsonDocument(root).toJson().constData());
+    }
+
+    return 0;
+}
@@ -0,0 +1,31 @@
+QT       += core gui widgets charts
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = renderbench
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    main.cpp \
+    ../../arcprogressbar/arcprogressbar.cpp \
+    ../../colordashboard/colordashboard.cpp \
+    ../../dynamicline/dynamicline.cpp \
+    ../../dynamicline/minmaxpyramid.cpp \
+    ../../dynamicline/stripchart.cpp \
+    ../../frameclock/frameclock.cpp \
+    ../../oledwidget/drawwidget.cpp \
+    ../../sliderwidget/sliderwidget.cpp \
+    ../../wareprogressbar/wareprogressbar.cpp
+
+HEADERS += \
+    ../../arcprogressbar/arcprogressbar.h \
+    ../../colordashboard/colordashboard.h \
+    ../../dynamicline/dynamicline.h \
+    ../../dynamicline/minmaxpyramid.h \
+    ../../dynamicline/stripchart.h \
+    ../../frameclock/frameclock.h \
+    ../../oledwidget/drawwidget.h \
+    ../../sliderwidget/sliderwidget.h \
+    ../../wareprogressbar/wareprogressbar.h
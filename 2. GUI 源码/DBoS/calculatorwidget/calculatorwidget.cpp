@@ -36,11 +36,11 @@ void CalculatorWidget::initUi()
             pLayout->addWidget(&m_buttons[i*5 + j], i+1, j);
 
             if ((i*5 + j) == 3 || (i*5 + j) == 4 || (i*5 + j) == 8 || (i*5 + j) == 9 || (i*5 + j) == 13 || (i*5 + j) == 14 || (i*5 + j) == 18 || (i*5 + j) == 19)
-                m_buttons[i*5 + j].setStyleSheet("color:white; border-radius: 5px; background-color:rgb(16, 63, 145); font: normal bold 35px;outline: none;");
+                m_buttons[i*5 + j].setProperty("role", "operator");
             else if ((i*5 + j) == 17)
-                m_buttons[i*5 + j].setStyleSheet("color:white; border-radius: 5px; background-color:rgb(71, 177, 233); font: normal bold 35px;outline: none;");
+                m_buttons[i*5 + j].setProperty("role", "equal");
             else
-                m_buttons[i*5 + j].setStyleSheet("color:white; border-radius: 5px; background-color:rgb(55, 60, 66); font: normal bold 35px;outline: none;");
+                m_buttons[i*5 + j].setProperty("role", "digit");
 
             connect(&m_buttons[i*5 + j], &QPushButton::clicked, this, &CalculatorWidget::buttonClicked);
         }
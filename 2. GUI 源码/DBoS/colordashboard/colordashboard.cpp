@@ -23,27 +23,95 @@ ColorDashboard::~ColorDashboard()
 
 void ColorDashboard::paintEvent(QPaintEvent *e)
 {
+    if (m_layersDirty || m_backLayer.devicePixelRatioF() != devicePixelRatioF()) {
+        updateLayers();
+    }
+
     QPainter painter(this);
+    QPointF origin(-width()/2.0, -height()/2.0);
 
     painter.setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing, true);
     painter.translate(width()/2.0, height()/2.0);
-    m_radius = qMin(width(), height()) /2;;
-
-    drawOuterCircle(&painter);
-    drawScaleCircle(&painter);
-    drawPieCircle(&painter);
-    drawInnerCircle(&painter);
-    drawScaleNum(&painter);
-    drawScale(&painter);
-    drawPointerCircle(&painter);
+
+    // 静态图层与动态部分按原来的绘制顺序叠加
+    painter.drawPixmap(origin, m_backLayer);
+    if (m_pieStyle == PieStyle_Current) {
+        drawCurrentPieCircle(&painter, pieRadius());
+        painter.drawPixmap(origin, m_scaleLayer);
+    }
     drawPointer(&painter);
     drawCenterCircel(&painter);
     drawText(&painter);
-    if (m_isOverlayVisible) drawOverlay(&painter);
+    painter.drawPixmap(origin, m_overlayLayer);
 
     return QWidget::paintEvent(e);
 }
 
+void ColorDashboard::resizeEvent(QResizeEvent *e)
+{
+    invalidateLayers();
+
+    return QWidget::resizeEvent(e);
+}
+
+void ColorDashboard::invalidateLayers()
+{
+    m_layersDirty = true;
+    update();
+}
+
+void ColorDashboard::updateLayers()
+{
+    m_radius = qMin(width(), height()) /2;
+    m_layersDirty = false;
+
+    m_backLayer = createLayer();
+    QPainter back(&m_backLayer);
+    back.setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing, true);
+    back.translate(width()/2.0, height()/2.0);
+    drawOuterCircle(&back);
+    drawScaleCircle(&back);
+
+    // 三色圆环与值无关，刻度层直接画在底层上，省去一次合成
+    QPixmap *scaleLayer = &m_backLayer;
+    if (m_pieStyle == PieStyle_Current) {
+        m_scaleLayer = createLayer();
+        scaleLayer = &m_scaleLayer;
+    }
+    else {
+        drawThreePieCircle(&back, pieRadius());
+        m_scaleLayer = QPixmap();
+    }
+    back.end();
+
+    QPainter scale(scaleLayer);
+    scale.setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing, true);
+    scale.translate(width()/2.0, height()/2.0);
+    drawInnerCircle(&scale);
+    drawScaleNum(&scale);
+    drawScale(&scale);
+    drawPointerCircle(&scale);
+    scale.end();
+
+    m_overlayLayer = QPixmap();
+    if (m_isOverlayVisible) {
+        m_overlayLayer = createLayer();
+        QPainter overlay(&m_overlayLayer);
+        overlay.setRenderHints(QPainter::Antialiasing, true);
+        overlay.translate(width()/2.0, height()/2.0);
+        drawOverlay(&overlay);
+    }
+}
+
+QPixmap ColorDashboard::createLayer() const
+{
+    QPixmap pixmap(size() * devicePixelRatioF());
+    pixmap.setDevicePixelRatio(devicePixelRatioF());
+    pixmap.fill(Qt::transparent);
+
+    return pixmap;
+}
+
 inline void ColorDashboard::drawGenericCircle(QPainter *painter, double radius, const QColor &color)
 {
     painter->save();
@@ -67,20 +135,9 @@ void ColorDashboard::drawScaleCircle(QPainter *painter)
     drawGenericCircle(painter, radius, m_scaleCircleColor);
 }
 
-void ColorDashboard::drawPieCircle(QPainter *painter)
+double ColorDashboard::pieRadius() const
 {
-    double radius = m_radius * 0.58;
-
-    switch (m_pieStyle)
-    {
-        case PieStyle_Three:
-            drawThreePieCircle(painter, radius);
-            break;
-
-        case PieStyle_Current:
-          drawCurrentPieCircle(painter, radius);
-            break;
-    }
+    return m_radius * 0.58;
 }
 
 void ColorDashboard::drawThreePieCircle(QPainter *painter, double radius)
@@ -227,10 +284,11 @@ void ColorDashboard::drawOverlay(QPainter *painter)
 
     QPainterPath hightCircle = circle_2 - circel_1;
     QLinearGradient gradient(-radius/2, 0, 0, 0);
-    m_overlayColor.setAlpha(100);
-    gradient.setColorAt(0.0, m_overlayColor);
-    m_overlayColor.setAlpha(30);
-    gradient.setColorAt(1.0, m_overlayColor);
+    QColor color = m_overlayColor;
+    color.setAlpha(100);
+    gradient.setColorAt(0.0, color);
+    color.setAlpha(30);
+    gradient.setColorAt(1.0, color);
 
     painter->setBrush(gradient);
     painter->rotate(65);
@@ -349,19 +407,19 @@ void ColorDashboard::setRange(int minValue, int maxValue)
 {
     m_minValue = minValue;
     m_maxValue = maxValue;
-    update();
+    invalidateLayers();
 }
 
 void ColorDashboard::setMinValue(int minValue)
 {
     m_minValue = minValue;
-    update();
+    invalidateLayers();
 }
 
 void ColorDashboard::setMaxValue(int maxValue)
 {
     m_maxValue = maxValue;
-    update();
+    invalidateLayers();
 }
 
 void ColorDashboard::setValue(int value)
@@ -390,32 +448,32 @@ void ColorDashboard::setValue(int value)
 void ColorDashboard::setScaleMajor(int scaleMajor)
 {
     m_scaleMajor = scaleMajor;
-    update();
+    invalidateLayers();
 }
 
 void ColorDashboard::setScaleMinor(int scaleMinor)
 {
     m_scaleMinor = scaleMinor;
-    update();
+    invalidateLayers();
 }
 
 void ColorDashboard::setAngleRange(int startAngle, int endAngle)
 {
     m_startAngle = startAngle;
     m_endAngle   = endAngle;
-    update();
+    invalidateLayers();
 }
 
 void ColorDashboard::setStartAngle(int startAngle)
 {
     m_startAngle = startAngle;
-    update();
+    invalidateLayers();
 }
 
 void ColorDashboard::setEndAngle(int endAngle)
 {
     m_endAngle = endAngle;
-    update();
+    invalidateLayers();
 }
 
 void ColorDashboard::setAnimationStepTime(int msec)
@@ -426,55 +484,55 @@ void ColorDashboard::setAnimationStepTime(int msec)
 void ColorDashboard::setOuterCircleColor(const QColor &outerCircleColor)
 {
     m_outerCircleColor = outerCircleColor;
-    update();
+    invalidateLayers();
 }
 
 void ColorDashboard::setInnerCircleColor(const QColor &innerCircleColor)
 {
     m_innerCircleColor = innerCircleColor;
-    update();
+    invalidateLayers();
 }
 
 void ColorDashboard::setPieStartColor(const QColor &scaleStartColor)
 {
     m_pieColorStart = scaleStartColor;
-    update();
+    invalidateLayers();
 }
 
 void ColorDashboard::setPieMidColor(const QColor &scaleMidColor)
 {
     m_pieColorMid = scaleMidColor;
-    update();
+    invalidateLayers();
 }
 
 void ColorDashboard::setPieEndColor(const QColor &scaleEndColor)
 {
     m_pieColorEnd = scaleEndColor;
-    update();
+    invalidateLayers();
 }
 
 void ColorDashboard::setScaleColor(const QColor &scaleColor)
 {
     m_scaleColor = scaleColor;
-    update();
+    invalidateLayers();
 }
 
 void ColorDashboard::setScalCircleColor(const QColor &scaleCircleColor)
 {
     m_scaleCircleColor = scaleCircleColor;
-    update();
+    invalidateLayers();
 }
 
 void ColorDashboard::setScaleNumColor(const QColor &scaleNumColor)
 {
     m_scaleNumColor = scaleNumColor;
-    update();
+    invalidateLayers();
 }
 
 void ColorDashboard::setPointerColor(const QColor &pointerColor)
 {
     m_pointerColor = pointerColor;
-    update();
+    invalidateLayers();
 }
 
 void ColorDashboard::setCenterCircleColor(const QColor &centerCircleColor)
@@ -492,19 +550,19 @@ void ColorDashboard::setTextColor(const QColor &textColor)
 void ColorDashboard::setOverlayVisible(bool overlay)
 {
     m_isOverlayVisible = overlay;
-    update();
+    invalidateLayers();
 }
 
 void ColorDashboard::setOverlayColor(const QColor &overlayColor)
 {
     m_overlayColor = overlayColor;
-    update();
+    invalidateLayers();
 }
 
 void ColorDashboard::setPieStyle(PieStyle pieStyle)
 {
     m_pieStyle = pieStyle;
-    update();
+    invalidateLayers();
 }
 
 void ColorDashboard::setPointerStyle(PointerStyle pointerStyle)
@@ -2,6 +2,7 @@
 #define COLORDASHBOARD_H
 
 #include <QColor>
+#include <QPixmap>
 #include <QPropertyAnimation>
 #include <QWidget>
 
@@ -15,6 +16,7 @@
  * 7. 可设置圆环样式，三色圆环、当前圆环
  * 8. 可设置指示器样式，球形、指针形、圆角指针、三角形指示器
  * 8. 自适应窗体拉伸、刻度尺和文字自动缩放
+ * 9. 圆、刻度、刻度值、遮蔽罩等静态图层缓存为 QPixmap，尺寸或外观属性变化时重绘，值变化时只绘制饼圆、指针和文本
  */
 
 class ColorDashboard : public QWidget
@@ -139,11 +141,16 @@ public slots:
 
 protected:
     void paintEvent(QPaintEvent *e) override;
+    void resizeEvent(QResizeEvent *e) override;
+
+    void invalidateLayers();                                    // 静态图层失效，下次绘制时重绘
+    void updateLayers();
+    QPixmap createLayer() const;
 
     inline void drawGenericCircle(QPainter *painter, double radius, const QColor &cokor);
     void drawOuterCircle(QPainter *painter);
     void drawScaleCircle(QPainter *painter);
-    void drawPieCircle(QPainter *painter);
+    double pieRadius() const;                                   // 饼图半径，缓存的三色圆环与每帧绘制的当前值圆环共用
     void drawThreePieCircle(QPainter *painter, double radius);
     void drawCurrentPieCircle(QPainter *painter, double radius);
     void drawInnerCircle(QPainter *painter);
@@ -198,6 +205,11 @@ private:
     QPropertyAnimation m_animation;                                 // 指针属性动画
     int m_animationStepTime   = 50;                                 // 每刻度动画持续时间
     QEasingCurve::Type m_easingCurveType = QEasingCurve::OutQuad;   // 指针动画缓和曲线类型
+
+    QPixmap m_backLayer;                                            // 外圆、刻度圆，三色圆环样式时含饼圆及刻度层
+    QPixmap m_scaleLayer;                                           // 内圆、刻度值、刻度、指针圆，位于当前圆环之上
+    QPixmap m_overlayLayer;                                         // 遮蔽罩
+    bool m_layersDirty        = true;                               // 静态图层是否需要重绘
 };
 
 #endif // COLORDASHBOARD_H
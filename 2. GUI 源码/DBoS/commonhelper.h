@@ -13,6 +13,8 @@
 #include <QTime>
 #include <QTranslator>
 
+#include "stylesheet/stylesheetcache.h"
+
 /**
  * @brief 公共辅助类
  * 1. 设置皮肤样式
@@ -29,9 +31,14 @@ public:
     CommonHelper(const CommonHelper&) = delete;
     CommonHelper &operator=(const CommonHelper&) = delete;
 
-    // 设置皮肤样式
+    // 设置皮肤样式；启动时已编译进应用样式表的文件只设置作用域，不再解析
     static void setStyleSheet(const QString &styleSheet, QObject *widget)
     {
+        QWidget *target = qobject_cast<QWidget *>(widget);
+        if (target && StyleSheetCache::instance()->apply(styleSheet, target)) {
+            return;
+        }
+
         QFile file(styleSheet);
         if (file.open(QIODevice::ReadOnly))
         {
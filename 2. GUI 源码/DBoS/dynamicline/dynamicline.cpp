@@ -3,6 +3,13 @@
 #include <QDateTime>
 #include <QStringLiteral>
 #include <QVBoxLayout>
+#include <QWheelEvent>
+
+namespace {
+
+constexpr qint64 MaxSpanSecs = 7 * 24 * 3600;
+
+}
 
 DynamicLine::DynamicLine(QWidget *parent)
     : QWidget(parent), m_pChartView(new QChartView(this)), m_pChart(new QChart), m_pTimeAxisX(new QDateTimeAxis(this)), m_pAxisY(new QValueAxis(this))
@@ -31,6 +38,7 @@ void DynamicLine::initUi()
     m_pChartView->setRenderHint(QPainter::Antialiasing);
     m_pChartView->setRubberBand(QChartView::RectangleRubberBand);
     m_pChartView->installEventFilter(this);
+    m_pChartView->viewport()->installEventFilter(this);
 
     QFont font("微软雅黑", 12);
     font.setBold(true);
@@ -69,6 +77,14 @@ QLineSeries *DynamicLine::createSeries(QChart *chart, const QString &name, const
 void DynamicLine::initCtrl()
 {
     connect(&m_timer, &QTimer::timeout, this, &DynamicLine::updateChart);
+
+    // 同一轮事件循环内到达的样本合并为一次刷新
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(0);
+    connect(&m_flushTimer, &QTimer::timeout, this, &DynamicLine::flushSeries);
+
+    // 框选缩放、双击复位或滚轮缩放后，按新的时间范围重新取点
+    connect(m_pTimeAxisX, &QDateTimeAxis::rangeChanged, this, &DynamicLine::onTimeAxisXRangeChanged);
 }
 
 void DynamicLine::start(int intervalMsec)
@@ -76,12 +92,116 @@ void DynamicLine::start(int intervalMsec)
     if (m_timer.isActive())
         m_timer.stop();
 
-    m_timer.start(intervalMsec);
+    if (m_backend == RasterBackend)
+        m_pStripChart->start();
+    else if (m_updateMode == TimerDriven)
+        m_timer.start(intervalMsec);
 }
 
 void DynamicLine::stop()
 {
     m_timer.stop();
+    m_flushTimer.stop();
+
+    if (m_pStripChart != nullptr)
+        m_pStripChart->stop();
+}
+
+DynamicLine::UpdateMode DynamicLine::updateMode() const
+{
+    return m_updateMode;
+}
+
+void DynamicLine::setUpdateMode(UpdateMode mode)
+{
+    m_updateMode = mode;
+
+    // replace() 整体替换数据点，序列动画会使整条曲线重新过渡
+    m_pChart->setAnimationOptions((mode == SampleDriven) ? QChart::NoAnimation : QChart::SeriesAnimations);
+}
+
+DynamicLine::Backend DynamicLine::backend() const
+{
+    return m_backend;
+}
+
+void DynamicLine::setBackend(Backend backend)
+{
+    if (backend == m_backend)
+        return;
+
+    m_backend = backend;
+
+    if ((backend == RasterBackend) && (m_pStripChart == nullptr))
+    {
+        m_pStripChart = new StripChart(this);
+        m_pStripChart->setFont(m_pAxisY->labelsFont());
+        m_pStripChart->setHistoryCapacity(m_bufferCapacity, m_historyBudget);
+        layout()->addWidget(m_pStripChart);
+        syncStripChart();
+    }
+
+    m_pChartView->setVisible(backend == ChartBackend);
+
+    if (m_pStripChart != nullptr)
+        m_pStripChart->setVisible(backend == RasterBackend);
+
+    // 切换后端时释放或分配图表侧的金字塔
+    for (auto &history : m_histories)
+    {
+        history.pyramid = createPyramid();
+        history.dirty = true;
+    }
+}
+
+void DynamicLine::syncStripChart()
+{
+    m_pStripChart->setTitle(m_pChart->title());
+    m_pStripChart->setTimeSpanSecs(m_setSpanSecs);
+    m_pStripChart->setTimeFormat(m_pTimeAxisX->format());
+    m_pStripChart->setTimeTickCount(m_pTimeAxisX->tickCount());
+    m_pStripChart->setRange(m_axisRange.min, m_axisRange.max);
+    m_pStripChart->setValueTickCount(m_pAxisY->tickCount());
+    m_pStripChart->setValueLabelFormat(m_pAxisY->labelFormat());
+
+    for (int i=m_pStripChart->count(); i<m_series.count(); ++i)
+    {
+        m_pStripChart->addSeries(m_series[i]->pen(), m_series[i]->pointsVisible());
+        m_pStripChart->setSeriesVisible(i, m_series[i]->isVisible());
+    }
+}
+
+void DynamicLine::setBufferCapacity(int points)
+{
+    m_bufferCapacity = qMax(points, 2);
+    resetHistory();
+}
+
+void DynamicLine::setHistoryBudget(int bytes)
+{
+    m_historyBudget = bytes;
+    resetHistory();
+}
+
+void DynamicLine::resetHistory()
+{
+    for (auto &history : m_histories)
+    {
+        history.pyramid = createPyramid();
+        history.dirty = true;
+    }
+
+    if (m_pStripChart != nullptr)
+        m_pStripChart->setHistoryCapacity(m_bufferCapacity, m_historyBudget);
+}
+
+MinMaxPyramid DynamicLine::createPyramid() const
+{
+    // RasterBackend 下样本直接转给 StripChart，只保留一个最小的空金字塔
+    if (m_backend == RasterBackend)
+        return MinMaxPyramid(0, 0);
+
+    return MinMaxPyramid(m_bufferCapacity, m_historyBudget);
 }
 
 int DynamicLine::count() const
@@ -98,19 +218,74 @@ void DynamicLine::setSeriesVisible(int index, bool visible)
 {
     if (index < m_series.count())
         m_series[index]->setVisible(visible);
+
+    if (m_pStripChart != nullptr)
+        m_pStripChart->setSeriesVisible(index, visible);
 }
 
 void DynamicLine::setChartTitle(const QString &title)
 {
     m_pChart->setTitle(title);
+
+    if (m_pStripChart != nullptr)
+        m_pStripChart->setTitle(title);
 }
 
 void DynamicLine::setSeriesValues(int index, double value)
 {
-    if (index < m_lastValues.count())
+    if ((m_updateMode == SampleDriven) || (m_backend == RasterBackend))
+        appendSample(index, QDateTime::currentMSecsSinceEpoch(), value);
+    else if (index < m_lastValues.count())
         m_lastValues[index] = value;
 }
 
+void DynamicLine::appendSample(int index, qint64 msecs, double value)
+{
+    if (m_backend == RasterBackend)
+    {
+        m_pStripChart->appendSample(index, msecs, value);
+        return;
+    }
+
+    if (index >= m_histories.count())
+        return;
+
+    auto &history = m_histories[index];
+
+    // 时间戳不晚于上一个点的样本属于重复数据，不再绘制
+    if (!history.pyramid.isEmpty() && (msecs <= history.pyramid.last().x()))
+        return;
+
+    // 缓冲已满时直接覆盖最旧的点，不再移动整条序列
+    history.pyramid.append(msecs, value);
+    history.dirty = true;
+
+    m_lastMsecs = qMax(m_lastMsecs, msecs);
+
+    if (!m_flushTimer.isActive())
+        m_flushTimer.start();
+}
+
+void DynamicLine::backfill(int index, const QVector<QPointF> &points)
+{
+    if (m_backend == RasterBackend)
+    {
+        m_pStripChart->backfill(index, points);
+        return;
+    }
+
+    if (index >= m_histories.count() || points.isEmpty())
+        return;
+
+    m_histories[index].pyramid.prepend(points);
+    m_histories[index].dirty = true;
+
+    m_lastMsecs = qMax(m_lastMsecs, qint64(m_histories[index].pyramid.last().x()));
+
+    if (!m_flushTimer.isActive())
+        m_flushTimer.start();
+}
+
 void DynamicLine::addSplineSeries(const QString &name, const QPen &pen, bool pointsVisible)
 {
     QLineSeries *series = new QLineSeries(m_pChart);
@@ -125,6 +300,13 @@ void DynamicLine::addSplineSeries(const QString &name, const QPen &pen, bool poi
 
     m_series.append(series);
     m_lastValues.append(0);
+
+    History history;
+    history.pyramid = createPyramid();
+    m_histories.append(history);
+
+    if (m_pStripChart != nullptr)
+        m_pStripChart->addSeries(pen, pointsVisible);
 }
 
 void DynamicLine::setTimeAxisXSpanSecs(qint64 secs)
@@ -132,16 +314,37 @@ void DynamicLine::setTimeAxisXSpanSecs(qint64 secs)
     m_setSpanSecs = secs;
 
     m_curSpanSecs = m_setSpanSecs;
+
+    if (m_pStripChart != nullptr)
+        m_pStripChart->setTimeSpanSecs(secs);
 }
 
 void DynamicLine::setTimeAxisXFormat(const QString &format)
 {
     m_pTimeAxisX->setFormat(format);
+
+    if (m_pStripChart != nullptr)
+        m_pStripChart->setTimeFormat(format);
 }
 
 void DynamicLine::setTimeAxisXTickCount(int tickCount)
 {
     m_pTimeAxisX->setTickCount(tickCount);
+
+    if (m_pStripChart != nullptr)
+        m_pStripChart->setTimeTickCount(tickCount);
+}
+
+void DynamicLine::zoomTimeAxisX(qreal factor)
+{
+    if (m_pStripChart != nullptr)
+        m_pStripChart->setTimeSpanSecs(qint64(m_pStripChart->timeSpanSecs() * factor));
+
+    m_curSpanSecs = qBound<qint64>(1, qint64(m_curSpanSecs * factor), MaxSpanSecs);
+
+    // 以当前右边界为基准缩放，保持最新数据可见
+    QDateTime endTime = m_pTimeAxisX->max();
+    m_pTimeAxisX->setRange(endTime.addSecs(-m_curSpanSecs), endTime);
 }
 
 void DynamicLine::setAxisYRange(qreal min, qreal max)
@@ -150,16 +353,25 @@ void DynamicLine::setAxisYRange(qreal min, qreal max)
     m_axisRange.min = min;
 
     m_pAxisY->setRange(min, max);
+
+    if (m_pStripChart != nullptr)
+        m_pStripChart->setRange(min, max);
 }
 
 void DynamicLine::setpAxisYTickCount(int count)
 {
     m_pAxisY->setTickCount(count);
+
+    if (m_pStripChart != nullptr)
+        m_pStripChart->setValueTickCount(count);
 }
 
 void DynamicLine::setAxisYLabelFormat(const QString &format)
 {
     m_pAxisY->setLabelFormat(format);
+
+    if (m_pStripChart != nullptr)
+        m_pStripChart->setValueLabelFormat(format);
 }
 
 void DynamicLine::mouseDoubleClickEvent(QMouseEvent *event)
@@ -174,6 +386,9 @@ void DynamicLine::mouseDoubleClickEvent(QMouseEvent *event)
         QDateTime beginTime = endTime.addSecs(-m_setSpanSecs);
         m_pTimeAxisX->setMin(beginTime);
         m_pTimeAxisX->setMax(endTime);
+
+        if (m_pStripChart != nullptr)
+            m_pStripChart->setTimeSpanSecs(m_setSpanSecs);
     }
 }
 
@@ -184,13 +399,21 @@ bool DynamicLine::eventFilter(QObject *o, QEvent *e)
         m_curSpanSecs = m_pTimeAxisX->max().toSecsSinceEpoch() - m_pTimeAxisX->min().toSecsSinceEpoch();
     }
 
+    // 框选只能放大，滚轮用于缩小到更长的历史跨度
+    if ((o == m_pChartView->viewport()) && (e->type() == QEvent::Wheel) && (m_updateMode == SampleDriven))
+    {
+        int delta = static_cast<QWheelEvent *>(e)->angleDelta().y();
+        if (delta != 0)
+            zoomTimeAxisX((delta > 0) ? 0.5 : 2.0);
+
+        return true;
+    }
+
     return false;
 }
 
-void DynamicLine::updateChart()
+void DynamicLine::scrollTimeAxisX(const QDateTime &dateTime)
 {
-    QDateTime dateTime = QDateTime::currentDateTime();
-
     if (!m_isFirstTime)
     {
         m_isFirstTime = true;
@@ -201,18 +424,71 @@ void DynamicLine::updateChart()
         m_pTimeAxisX->setMax(endTime);
     }
 
-    for (int i=0; i<m_series.count(); ++i)
-    {
-        m_series[i]->append(QDateTime::currentMSecsSinceEpoch(), m_lastValues.at(i));
-    }
-
     if (m_pTimeAxisX->max() < dateTime)
     {
         QDateTime endTime   = dateTime;
         QDateTime beginTime = endTime.addSecs(-m_curSpanSecs);
         m_pTimeAxisX->setMin(beginTime);
         m_pTimeAxisX->setMax(endTime);
+    }
+}
+
+void DynamicLine::flushSeries()
+{
+    // 先滚动坐标轴再取点，滚动引起的范围变化不必再次触发刷新
+    if (m_lastMsecs > 0)
+    {
+        m_isScrolling = true;
+        scrollTimeAxisX(QDateTime::fromMSecsSinceEpoch(m_lastMsecs));
+        m_isScrolling = false;
+    }
+
+    qint64 begin = m_pTimeAxisX->min().toMSecsSinceEpoch();
+    qint64 end   = m_pTimeAxisX->max().toMSecsSinceEpoch();
+
+    // 每个像素列最多两个点（最小值与最大值），点数与时间跨度无关
+    int maxPoints = qMax(int(m_pChart->plotArea().width()) * 2, 200);
+
+    for (int i=0; i<m_histories.count(); ++i)
+    {
+        auto &history = m_histories[i];
+
+        if (!history.dirty)
+            continue;
+
+        m_series[i]->replace(history.pyramid.query(begin, end, maxPoints));
+        history.dirty = false;
+    }
+}
+
+void DynamicLine::onTimeAxisXRangeChanged()
+{
+    if (m_isScrolling || (m_updateMode != SampleDriven))
+        return;
 
+    for (auto &history : m_histories)
+    {
+        history.dirty = true;
+    }
+
+    if (!m_flushTimer.isActive())
+        m_flushTimer.start();
+}
+
+void DynamicLine::updateChart()
+{
+    QDateTime dateTime = QDateTime::currentDateTime();
+    bool isScrolled = m_isFirstTime && (m_pTimeAxisX->max() < dateTime);
+
+    for (int i=0; i<m_series.count(); ++i)
+    {
+        m_series[i]->append(QDateTime::currentMSecsSinceEpoch(), m_lastValues.at(i));
+    }
+
+    scrollTimeAxisX(dateTime);
+
+    if (isScrolled)
+    {
         int pointCnt = m_setSpanSecs *  (1000 / m_timer.interval());
         int totalPointCnt = pointCnt * 8;
 
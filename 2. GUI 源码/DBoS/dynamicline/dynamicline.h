@@ -1,6 +1,9 @@
 #ifndef DYNAMICLINE_H
 #define DYNAMICLINE_H
 
+#include "minmaxpyramid.h"
+#include "stripchart.h"
+
 #include <QChart>
 #include <QChartView>
 #include <QDateTime>
@@ -21,6 +24,10 @@ using namespace QtCharts;
  * 4. 可设置曲线更新时间间隔
  * 5. 可选择隐藏曲线
  * 6. 自适应窗体拉伸，图表自动缩放
+ * 7. 样本驱动模式：数据写入预分配的环形缓冲，按样本时间戳批量刷新到图表
+ * 8. 可选 QPainter 滚动条带图后端，接口不变，适合 linuxfb 软件渲染
+ * 9. 样本驱动模式下历史数据保存在最小/最大值金字塔中，可用滚轮缩放到数小时的跨度，按屏幕宽度取点
+ * 10. 可回填持久化的历史数据，页面打开时即显示之前的曲线
  */
 
 class DynamicLine : public QWidget
@@ -32,7 +39,22 @@ class DynamicLine : public QWidget
         qreal min;
     };
 
+    struct History {
+        MinMaxPyramid pyramid{0, 0};    // 只在 ChartBackend 下按预算分配，RasterBackend 的历史由 StripChart 保存
+        bool dirty = false;
+    };
+
 public:
+    enum UpdateMode {
+        TimerDriven,        // 定时器按固定间隔追加最新值
+        SampleDriven        // 样本到达时追加，合并后通过 replace() 批量刷新
+    };
+
+    enum Backend {
+        ChartBackend,       // QtCharts，支持框选缩放
+        RasterBackend       // StripChart，离屏图像滚动，只绘制新增部分
+    };
+
     explicit DynamicLine(QWidget *parent = nullptr);
     ~DynamicLine();
 
@@ -43,14 +65,25 @@ public:
     qint64 timeAxisXSpanSecs() const;                           // X 轴时间跨度
     void addSplineSeries(const QString &name = "", const QPen &pen = QPen(), bool pointsVisible = false);  // 添加一条新的曲线
 
+    UpdateMode updateMode() const;
+    void setUpdateMode(UpdateMode mode);                        // 设置更新模式，需在 start() 之前调用
+    void setBufferCapacity(int points);                         // 样本驱动模式下每条曲线保留的原始点数
+    void setHistoryBudget(int bytes);                           // 样本驱动模式下每条曲线历史数据（含降采样层）的内存上限
+
+    Backend backend() const;
+    void setBackend(Backend backend);                           // 设置绘制后端，需在 start() 之前调用
+
 public slots:
     void setSeriesValues(int index, double value);              // 设置曲线值
+    void appendSample(int index, qint64 msecs, double value);   // 样本驱动模式：追加带时间戳的样本
+    void backfill(int index, const QVector<QPointF> &points);   // 样本驱动模式：回填早于现有样本的历史数据
     void setSeriesVisible(int index, bool visible);             // 设置曲线是否可见
     void setChartTitle(const QString &title);                   // 设置图表标题
 
     void setTimeAxisXSpanSecs(qint64 secs);                     // 设置 X 轴时间跨度
     void setTimeAxisXFormat(const QString &format = "HH:mm");   // 设置 X 轴时间格式
     void setTimeAxisXTickCount(int tickCount);                  // 设置 X 轴 tick 数量
+    void zoomTimeAxisX(qreal factor);                           // 按倍数缩放当前 X 轴时间跨度，大于 1 为缩小
 
     void setAxisYRange(qreal min, qreal max);                   // 设置 Y 轴范围
     void setpAxisYTickCount(int count);                         // 设置 Y 轴 tick 数量
@@ -64,9 +97,15 @@ private:
     void initUi();
     void initCtrl();
     QLineSeries *createSeries(QChart *chart, const QString &name, const QPen &pen, bool pointsVisible = false);
+    void scrollTimeAxisX(const QDateTime &dateTime);
+    void syncStripChart();
+    void resetHistory();
+    MinMaxPyramid createPyramid() const;
 
 private slots:
     void updateChart();
+    void flushSeries();
+    void onTimeAxisXRangeChanged();
 
 private:
     QVector<QLineSeries*> m_series;
@@ -82,6 +121,17 @@ private:
     Range m_axisRange;
 
     QTimer m_timer;
+
+    UpdateMode m_updateMode = TimerDriven;
+    int m_bufferCapacity = 1024;
+    int m_historyBudget  = 256 * 1024;
+    qint64 m_lastMsecs = 0;
+    QVector<History> m_histories;
+    QTimer m_flushTimer;
+    bool m_isScrolling = false;
+
+    Backend m_backend = ChartBackend;
+    StripChart *m_pStripChart = nullptr;
 };
 
 #endif // DYNAMICLINE_H
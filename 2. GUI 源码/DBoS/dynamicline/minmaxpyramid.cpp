@@ -0,0 +1,313 @@
+#include "minmaxpyramid.h"
+
+#include <QtGlobal>
+
+namespace {
+
+constexpr int MaxLevels = 16;
+
+}
+
+void MinMaxPyramid::Bucket::merge(const Bucket &other, bool isFirst)
+{
+    if (isFirst)
+    {
+        *this = other;
+        return;
+    }
+
+    last = other.last;
+
+    if (other.min < min)
+    {
+        min = other.min;
+        minTime = other.minTime;
+    }
+
+    if (other.max > max)
+    {
+        max = other.max;
+        maxTime = other.maxTime;
+    }
+}
+
+template <typename T>
+void MinMaxPyramid::Ring<T>::reset(int capacity)
+{
+    data.fill(T(), capacity);
+    head  = 0;
+    count = 0;
+}
+
+template <typename T>
+void MinMaxPyramid::Ring<T>::push(const T &value)
+{
+    data[head] = value;
+    head  = (head + 1) % data.count();
+    count = qMin(count + 1, data.count());
+}
+
+template <typename T>
+const T &MinMaxPyramid::Ring<T>::at(int index) const
+{
+    return data.at((head - count + index + data.count()) % data.count());
+}
+
+template <typename T>
+bool MinMaxPyramid::Ring<T>::isFull() const
+{
+    return count == data.count();
+}
+
+MinMaxPyramid::MinMaxPyramid(int rawCapacity, int budgetBytes, int factor) : m_factor(qMax(factor, 2))
+{
+    rawCapacity = qMax(rawCapacity, 2);
+    m_raw.reset(rawCapacity);
+
+    // 每个桶展开为两个点，每层取原始层一半的桶数，使各层的显示密度一致
+    int levelCapacity = qMax(rawCapacity / 2, 16);
+    int levelBytes    = levelCapacity * int(sizeof(Bucket));
+    int remain        = budgetBytes - rawCapacity * int(sizeof(QPointF));
+    int levelCount    = qBound(0, remain / levelBytes, MaxLevels);
+
+    m_levels.resize(levelCount);
+    for (auto &level : m_levels)
+    {
+        level.ring.reset(levelCapacity);
+    }
+}
+
+void MinMaxPyramid::append(qint64 msecs, double value)
+{
+    m_raw.push(QPointF(msecs, value));
+
+    if (m_levels.isEmpty())
+        return;
+
+    Bucket bucket;
+    bucket.first = bucket.last = bucket.minTime = bucket.maxTime = msecs;
+    bucket.min = bucket.max = value;
+
+    appendBucket(0, bucket);
+}
+
+void MinMaxPyramid::appendBucket(int level, const Bucket &bucket)
+{
+    Bucket current = bucket;
+
+    // 逐层向上合并，每层满 factor 个子桶时生成一个完整的桶，并继续合并到上一层
+    for (; level < m_levels.count(); ++level)
+    {
+        auto &target = m_levels[level];
+
+        target.pending.merge(current, target.children == 0);
+        if (++target.children < m_factor)
+            return;
+
+        current = target.pending;
+        target.ring.push(current);
+        target.children = 0;
+    }
+}
+
+void MinMaxPyramid::prepend(const QVector<QPointF> &points)
+{
+    QVector<QPointF> recent = samples();
+
+    clear();
+
+    // 历史数据与现有样本可能重叠，按时间顺序合并并去掉重复的部分
+    for (const auto &point : points)
+    {
+        if (isEmpty() || point.x() > last().x())
+            append(qint64(point.x()), point.y());
+    }
+
+    for (const auto &point : recent)
+    {
+        if (isEmpty() || point.x() > last().x())
+            append(qint64(point.x()), point.y());
+    }
+}
+
+void MinMaxPyramid::clear()
+{
+    m_raw.reset(m_raw.data.count());
+
+    for (auto &level : m_levels)
+    {
+        level.ring.reset(level.ring.data.count());
+        level.children = 0;
+    }
+}
+
+bool MinMaxPyramid::isEmpty() const
+{
+    return m_raw.count == 0;
+}
+
+QPointF MinMaxPyramid::last() const
+{
+    return m_raw.count > 0 ? m_raw.at(m_raw.count - 1) : QPointF();
+}
+
+QVector<QPointF> MinMaxPyramid::samples() const
+{
+    QVector<QPointF> ret;
+
+    ret.reserve(m_raw.count);
+    for (int i=0; i<m_raw.count; ++i)
+    {
+        ret.append(m_raw.at(i));
+    }
+
+    return ret;
+}
+
+int MinMaxPyramid::levelCount() const
+{
+    return m_levels.count();
+}
+
+int MinMaxPyramid::memoryUsage() const
+{
+    int ret = m_raw.data.count() * int(sizeof(QPointF));
+
+    for (const auto &level : m_levels)
+    {
+        ret += level.ring.data.count() * int(sizeof(Bucket));
+    }
+
+    return ret;
+}
+
+int MinMaxPyramid::rawLowerBound(qint64 msecs) const
+{
+    int lo = 0, hi = m_raw.count;
+    while (lo < hi)
+    {
+        int mid = (lo + hi) / 2;
+        if (m_raw.at(mid).x() < msecs) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+int MinMaxPyramid::rawUpperBound(qint64 msecs) const
+{
+    int lo = 0, hi = m_raw.count;
+    while (lo < hi)
+    {
+        int mid = (lo + hi) / 2;
+        if (m_raw.at(mid).x() <= msecs) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+int MinMaxPyramid::bucketLowerBound(const Ring<Bucket> &ring, qint64 msecs) const
+{
+    int lo = 0, hi = ring.count;
+    while (lo < hi)
+    {
+        int mid = (lo + hi) / 2;
+        if (ring.at(mid).last < msecs) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+int MinMaxPyramid::bucketUpperBound(const Ring<Bucket> &ring, qint64 msecs) const
+{
+    int lo = 0, hi = ring.count;
+    while (lo < hi)
+    {
+        int mid = (lo + hi) / 2;
+        if (ring.at(mid).first <= msecs) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+void MinMaxPyramid::appendBucketPoints(QVector<QPointF> &points, const Bucket &bucket)
+{
+    if (bucket.minTime == bucket.maxTime)
+    {
+        points.append(QPointF(bucket.minTime, bucket.min));
+    }
+    else if (bucket.minTime < bucket.maxTime)
+    {
+        points.append(QPointF(bucket.minTime, bucket.min));
+        points.append(QPointF(bucket.maxTime, bucket.max));
+    }
+    else
+    {
+        points.append(QPointF(bucket.maxTime, bucket.max));
+        points.append(QPointF(bucket.minTime, bucket.min));
+    }
+}
+
+QVector<QPointF> MinMaxPyramid::levelPoints(int level, qint64 begin, qint64 end) const
+{
+    QVector<QPointF> ret;
+    const auto &ring = m_levels.at(level).ring;
+
+    // 多取前后各一个桶，使曲线延伸到可视区域之外
+    int lo = qMax(bucketLowerBound(ring, begin) - 1, 0);
+    int hi = qMin(bucketUpperBound(ring, end) + 1, ring.count);
+
+    ret.reserve((hi - lo + level + 1) * 2);
+    for (int i=lo; i<hi; ++i)
+    {
+        appendBucketPoints(ret, ring.at(i));
+    }
+
+    // 较新的数据仍在本层及以下各层的未完成桶中，按时间顺序补齐
+    for (int i=level; i>=0; --i)
+    {
+        const auto &pending = m_levels.at(i);
+        if (pending.children > 0 && pending.pending.first <= end)
+            appendBucketPoints(ret, pending.pending);
+    }
+
+    return ret;
+}
+
+QVector<QPointF> MinMaxPyramid::query(qint64 begin, qint64 end, int maxPoints) const
+{
+    QVector<QPointF> ret;
+
+    if (isEmpty() || begin > end)
+        return ret;
+
+    maxPoints = qMax(maxPoints, 2);
+
+    // 原始层：未发生覆盖或最旧样本早于查询起点即可覆盖整个范围
+    int lo = qMax(rawLowerBound(begin) - 1, 0);
+    int hi = qMin(rawUpperBound(end) + 1, m_raw.count);
+    bool isCovered = !m_raw.isFull() || (m_raw.at(0).x() <= begin);
+
+    if ((isCovered && (hi - lo <= maxPoints)) || m_levels.isEmpty())
+    {
+        ret.reserve(hi - lo);
+        for (int i=lo; i<hi; ++i)
+        {
+            ret.append(m_raw.at(i));
+        }
+        return ret;
+    }
+
+    int coarsest = -1;
+    for (int i=0; i<m_levels.count(); ++i)
+    {
+        const auto &ring = m_levels.at(i).ring;
+
+        if (ring.count == 0 && m_levels.at(i).children == 0)
+            break;
+
+        coarsest = i;
+        isCovered = !ring.isFull() || (ring.at(0).first <= begin);
+
+        int buckets = bucketUpperBound(ring, end) - bucketLowerBound(ring, begin) + 2 + i + 1;
+        if (isCovered && (buckets * 2 <= maxPoints))
+            return levelPoints(i, begin, end);
+    }
+
+    return (coarsest >= 0) ? levelPoints(coarsest, begin, end) : ret;
+}
@@ -0,0 +1,73 @@
+#ifndef MINMAXPYRAMID_H
+#define MINMAXPYRAMID_H
+
+#include <QPointF>
+#include <QVector>
+
+/* 多分辨率最小/最大值金字塔
+ * 1. 第 0 层保存原始样本，第 k 层每个桶合并第 k-1 层的 factor 个桶
+ * 2. 每个桶记录区间内的最小值、最大值及其时刻，降采样后仍保留峰谷包络
+ * 3. 查询时选择能够覆盖时间范围、且点数不超过上限的最细一层
+ * 4. 各层均为定长环形缓冲，总内存不超过构造时给定的预算
+ */
+class MinMaxPyramid
+{
+    struct Bucket {
+        qint64 first   = 0;         // 桶内第一个样本的时刻
+        qint64 last    = 0;         // 桶内最后一个样本的时刻
+        qint64 minTime = 0;
+        qint64 maxTime = 0;
+        double min     = 0;
+        double max     = 0;
+
+        void merge(const Bucket &other, bool isFirst);
+    };
+
+    template <typename T>
+    struct Ring {
+        QVector<T> data;
+        int head  = 0;
+        int count = 0;
+
+        void reset(int capacity);
+        void push(const T &value);
+        const T &at(int index) const;   // 0 为最旧的元素
+        bool isFull() const;
+    };
+
+    struct Level {
+        Ring<Bucket> ring;
+        Bucket pending;                 // 正在合并、尚未满 factor 个子桶的桶
+        int children = 0;
+    };
+
+public:
+    explicit MinMaxPyramid(int rawCapacity = 1024, int budgetBytes = 256 * 1024, int factor = 4);
+
+    void append(qint64 msecs, double value);
+    void prepend(const QVector<QPointF> &points);                       // 插入早于现有样本的历史数据，现有样本只保留原始层中的部分
+    void clear();
+
+    bool isEmpty() const;
+    QPointF last() const;                                               // 最新的原始样本
+    int levelCount() const;                                             // 不含原始样本层
+    int memoryUsage() const;                                            // 预分配的字节数
+    QVector<QPointF> query(qint64 begin, qint64 end, int maxPoints) const;
+
+private:
+    void appendBucket(int level, const Bucket &bucket);
+    int rawLowerBound(qint64 msecs) const;
+    int rawUpperBound(qint64 msecs) const;
+    int bucketLowerBound(const Ring<Bucket> &ring, qint64 msecs) const;
+    int bucketUpperBound(const Ring<Bucket> &ring, qint64 msecs) const;
+    QVector<QPointF> samples() const;
+    static void appendBucketPoints(QVector<QPointF> &points, const Bucket &bucket);
+    QVector<QPointF> levelPoints(int level, qint64 begin, qint64 end) const;
+
+private:
+    Ring<QPointF> m_raw;
+    QVector<Level> m_levels;
+    int m_factor;
+};
+
+#endif // MINMAXPYRAMID_H
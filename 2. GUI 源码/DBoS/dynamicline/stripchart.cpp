@@ -0,0 +1,480 @@
+#include "stripchart.h"
+
+#include "frameclock/frameclock.h"
+
+#include <QDateTime>
+#include <QFontMetrics>
+#include <QPainter>
+#include <QRegularExpression>
+#include <QWheelEvent>
+
+#include <string.h>
+
+namespace {
+
+const QColor BackgroundColor(46, 48, 58);
+const QColor PlotColor(30, 32, 40);
+const QColor GridColor(70, 72, 84);
+const QColor LabelColor(200, 200, 200);
+
+constexpr int Spacing = 8;
+constexpr qint64 MaxSpanSecs = 7 * 24 * 3600;
+
+}
+
+StripChart::StripChart(QWidget *parent) : QWidget(parent)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent, true);
+}
+
+StripChart::~StripChart()
+{
+    FrameClock::instance()->unsubscribe(this);
+}
+
+void StripChart::start(int intervalMsec)
+{
+    FrameClock::instance()->subscribe(this, intervalMsec, [this](qint64) { advance(); });
+}
+
+void StripChart::stop()
+{
+    FrameClock::instance()->unsubscribe(this);
+}
+
+int StripChart::count() const
+{
+    return m_series.count();
+}
+
+void StripChart::addSeries(const QPen &pen, bool pointsVisible)
+{
+    Series series;
+    series.pen = pen;
+    series.pointsVisible = pointsVisible;
+    series.history = MinMaxPyramid(m_rawCapacity, m_budgetBytes);
+
+    m_series.append(series);
+}
+
+void StripChart::appendSample(int index, qint64 msecs, double value)
+{
+    if (index >= m_series.count())
+        return;
+
+    auto &series = m_series[index];
+
+    // 金字塔要求时间单调递增
+    if (!series.history.isEmpty() && msecs <= series.history.last().x())
+        return;
+
+    series.history.append(msecs, value);
+    series.pending.enqueue(QPointF(msecs, value));
+
+    // 暂停滚动期间积压过多时丢弃，恢复后从历史样本重建
+    if (series.pending.count() > m_rawCapacity)
+    {
+        series.pending.clear();
+        m_headMsecs = 0;
+    }
+}
+
+void StripChart::backfill(int index, const QVector<QPointF> &points)
+{
+    if (index >= m_series.count())
+        return;
+
+    m_series[index].history.prepend(points);
+
+    rebuildPlot();
+    update();
+}
+
+void StripChart::setSeriesVisible(int index, bool visible)
+{
+    if (index < m_series.count() && m_series[index].visible != visible)
+    {
+        m_series[index].visible = visible;
+        rebuildPlot();
+        update();
+    }
+}
+
+void StripChart::setTitle(const QString &title)
+{
+    m_title = title;
+    updateLayout();
+}
+
+void StripChart::setHistoryCapacity(int rawCapacity, int budgetBytes)
+{
+    m_rawCapacity = rawCapacity;
+    m_budgetBytes = budgetBytes;
+
+    for (auto &series : m_series)
+    {
+        series.history = MinMaxPyramid(m_rawCapacity, m_budgetBytes);
+    }
+
+    rebuildPlot();
+    update();
+}
+
+void StripChart::setTimeSpanSecs(qint64 secs)
+{
+    secs = qBound<qint64>(1, secs, MaxSpanSecs);
+    if (secs == m_spanSecs)
+        return;
+
+    m_spanSecs = secs;
+    m_timeLabelTexts.clear();
+    rebuildPlot();
+    update();
+}
+
+qint64 StripChart::timeSpanSecs() const
+{
+    return m_spanSecs;
+}
+
+void StripChart::setTimeFormat(const QString &format)
+{
+    m_timeFormat = format;
+    m_timeLabelTexts.clear();
+    update();
+}
+
+void StripChart::setTimeTickCount(int count)
+{
+    m_timeTickCount = qMax(count, 2);
+    m_timeLabelTexts.clear();
+    update();
+}
+
+void StripChart::setRange(qreal min, qreal max)
+{
+    m_min = min;
+    m_max = max;
+    updateLayout();
+}
+
+void StripChart::setValueTickCount(int count)
+{
+    m_valueTickCount = qMax(count, 2);
+    updateLayout();
+}
+
+void StripChart::setValueLabelFormat(const QString &format)
+{
+    m_valueFormat = format;
+    updateLayout();
+}
+
+void StripChart::resizeEvent(QResizeEvent *event)
+{
+    updateLayout();
+
+    QWidget::resizeEvent(event);
+}
+
+void StripChart::wheelEvent(QWheelEvent *event)
+{
+    // 向上滚动放大（跨度减半），向下滚动缩小（跨度加倍）
+    if (event->angleDelta().y() > 0)
+        setTimeSpanSecs(m_spanSecs / 2);
+    else if (event->angleDelta().y() < 0)
+        setTimeSpanSecs(m_spanSecs * 2);
+
+    event->accept();
+}
+
+void StripChart::updateLayout()
+{
+    QFontMetrics metrics(font());
+
+    int labelWidth = 0;
+    for (int i=0; i<m_valueTickCount; ++i)
+    {
+        labelWidth = qMax(labelWidth, metrics.boundingRect(formatValue(m_min + i * (m_max - m_min) / (m_valueTickCount - 1))).width());
+    }
+
+    int top    = m_title.isEmpty() ? Spacing : metrics.height() + Spacing * 2;
+    int bottom = metrics.height() + Spacing;
+    int left   = labelWidth + Spacing * 2;
+
+    m_plotRect = QRect(left, top, qMax(width() - left - Spacing * 2, 1), qMax(height() - top - bottom - Spacing, 1));
+    m_timeLabelRect = QRect(0, m_plotRect.bottom() + 1, width(), height() - m_plotRect.bottom() - 1);
+
+    if (m_plot.size() != m_plotRect.size())
+        m_plot = QImage(m_plotRect.size(), QImage::Format_RGB32);
+
+    m_axesDirty = true;
+    m_timeLabelTexts.clear();
+
+    rebuildPlot();
+    update();
+}
+
+void StripChart::renderAxes()
+{
+    m_axes = QPixmap(size());
+    m_axes.fill(BackgroundColor);
+
+    QPainter painter(&m_axes);
+    painter.setRenderHint(QPainter::TextAntialiasing, true);
+    painter.setPen(LabelColor);
+
+    if (!m_title.isEmpty())
+    {
+        QFont titleFont = font();
+        titleFont.setPointSize(titleFont.pointSize() + 3);
+        painter.setFont(titleFont);
+        painter.drawText(QRect(0, 0, width(), m_plotRect.top()), Qt::AlignCenter, m_title);
+        painter.setFont(font());
+    }
+
+    int labelHeight = QFontMetrics(font()).height();
+    for (int i=0; i<m_valueTickCount; ++i)
+    {
+        int y = m_plotRect.top() + i * (m_plotRect.height() - 1) / (m_valueTickCount - 1);
+        QRect rect(0, y - labelHeight / 2, m_plotRect.left() - Spacing, labelHeight);
+        painter.drawText(rect, Qt::AlignRight | Qt::AlignVCenter, formatValue(m_max - i * (m_max - m_min) / (m_valueTickCount - 1)));
+    }
+
+    painter.setPen(GridColor);
+    painter.drawRect(m_plotRect.adjusted(-1, -1, 0, 0));
+
+    m_axesDirty = false;
+}
+
+bool StripChart::renderTimeLabels()
+{
+    QStringList texts;
+    double pxPerMsec = m_plotRect.width() / (m_spanSecs * 1000.0);
+
+    for (int i=0; i<m_timeTickCount; ++i)
+    {
+        int x = i * (m_plotRect.width() - 1) / (m_timeTickCount - 1);
+        qint64 msecs = qint64(m_headMsecs - (m_plotRect.width() - x) / pxPerMsec);
+        texts.append(QDateTime::fromMSecsSinceEpoch(msecs).toString(m_timeFormat));
+    }
+
+    // 标签文本不变时直接复用缓存
+    if (texts == m_timeLabelTexts)
+        return false;
+
+    m_timeLabelTexts = texts;
+    m_timeLabels = QPixmap(m_timeLabelRect.size());
+    m_timeLabels.fill(BackgroundColor);
+
+    QPainter painter(&m_timeLabels);
+    painter.setRenderHint(QPainter::TextAntialiasing, true);
+    painter.setPen(LabelColor);
+
+    QFontMetrics metrics(font());
+    for (int i=0; i<texts.count(); ++i)
+    {
+        int x = m_plotRect.left() + i * (m_plotRect.width() - 1) / (m_timeTickCount - 1);
+        int w = metrics.boundingRect(texts.at(i)).width();
+        int left = qBound(0, x - w / 2, qMax(width() - w, 0));
+        painter.drawText(QRect(left, Spacing / 2, w, metrics.height()), Qt::AlignCenter, texts.at(i));
+    }
+
+    return true;
+}
+
+void StripChart::drawGrid(QPainter *painter, int x, int width)
+{
+    painter->fillRect(x, 0, width, m_plot.height(), PlotColor);
+    painter->setPen(GridColor);
+
+    for (int i=1; i<m_valueTickCount-1; ++i)
+    {
+        int y = i * (m_plot.height() - 1) / (m_valueTickCount - 1);
+        painter->drawLine(x, y, x + width - 1, y);
+    }
+}
+
+void StripChart::rebuildPlot()
+{
+    if (m_plot.isNull())
+        return;
+
+    QPainter painter(&m_plot);
+    drawGrid(&painter, 0, m_plot.width());
+    painter.setRenderHint(QPainter::Antialiasing, true);
+
+    for (auto &series : m_series)
+    {
+        series.pending.clear();
+        series.hasLast = !series.history.isEmpty();
+        if (series.hasLast)
+            series.last = series.history.last();
+
+        if (!series.visible || series.history.isEmpty() || m_headMsecs == 0)
+            continue;
+
+        // 每个像素列最多取两个点（最小值与最大值），峰谷不会因降采样丢失
+        qint64 beginMsecs = qint64(m_headMsecs) - m_spanSecs * 1000;
+        QVector<QPointF> points = series.history.query(beginMsecs, qint64(m_headMsecs), m_plot.width() * 2);
+        for (auto &point : points)
+        {
+            point = mapToPlot(point);
+        }
+
+        painter.setPen(series.pen);
+        painter.drawPolyline(points.constData(), points.count());
+
+        // 点过于密集时不再绘制样本圆点
+        if (series.pointsVisible && points.count() * 4 <= m_plot.width())
+        {
+            painter.setBrush(series.pen.color());
+            for (const auto &point : points)
+            {
+                painter.drawEllipse(point, 2.5, 2.5);
+            }
+            painter.setBrush(Qt::NoBrush);
+        }
+    }
+}
+
+void StripChart::scrollPlot(int dx)
+{
+    int w = m_plot.width();
+
+    if (dx >= w)
+    {
+        rebuildPlot();
+        return;
+    }
+
+    // 逐行整体左移，只有右侧新露出的 dx 列需要重绘
+    int bytesPerPixel = m_plot.depth() / 8;
+    for (int y=0; y<m_plot.height(); ++y)
+    {
+        uchar *line = m_plot.scanLine(y);
+        memmove(line, line + dx * bytesPerPixel, size_t(w - dx) * bytesPerPixel);
+    }
+
+    QPainter painter(&m_plot);
+    drawGrid(&painter, w - dx, dx);
+}
+
+void StripChart::drawPending()
+{
+    QPainter painter(&m_plot);
+    painter.setRenderHint(QPainter::Antialiasing, true);
+
+    for (auto &series : m_series)
+    {
+        while (!series.pending.isEmpty())
+        {
+            QPointF sample = series.pending.dequeue();
+
+            if (series.visible)
+            {
+                QPointF point = mapToPlot(sample);
+
+                painter.setPen(series.pen);
+                if (series.hasLast)
+                    painter.drawLine(mapToPlot(series.last), point);
+
+                if (series.pointsVisible)
+                {
+                    painter.setBrush(series.pen.color());
+                    painter.drawEllipse(point, 2.5, 2.5);
+                    painter.setBrush(Qt::NoBrush);
+                }
+            }
+
+            series.last = sample;
+            series.hasLast = true;
+        }
+    }
+}
+
+void StripChart::advance()
+{
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    if (m_headMsecs == 0 || now < m_headMsecs)
+    {
+        m_headMsecs = now;
+        rebuildPlot();
+        update();
+        return;
+    }
+
+    double pxPerMsec = m_plotRect.width() / (m_spanSecs * 1000.0);
+    int dx = int((now - m_headMsecs) * pxPerMsec);
+
+    bool hasPending = false;
+    for (const auto &series : m_series)
+    {
+        hasPending = hasPending || !series.pending.isEmpty();
+    }
+
+    if (dx == 0 && !hasPending)
+        return;
+
+    if (dx > 0)
+    {
+        m_headMsecs += dx / pxPerMsec;
+        scrollPlot(dx);
+
+        if (renderTimeLabels())
+            update(m_timeLabelRect);
+    }
+
+    drawPending();
+
+    update(m_plotRect);
+}
+
+void StripChart::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event)
+
+    if (m_axesDirty)
+        renderAxes();
+
+    if (m_timeLabelTexts.isEmpty() && m_headMsecs != 0)
+        renderTimeLabels();
+
+    QPainter painter(this);
+    painter.drawPixmap(0, 0, m_axes);
+    painter.drawImage(m_plotRect.topLeft(), m_plot);
+
+    if (!m_timeLabels.isNull())
+        painter.drawPixmap(m_timeLabelRect.topLeft(), m_timeLabels);
+}
+
+QPointF StripChart::mapToPlot(const QPointF &sample) const
+{
+    double pxPerMsec = m_plot.width() / (m_spanSecs * 1000.0);
+    double x = m_plot.width() - (m_headMsecs - sample.x()) * pxPerMsec;
+    double y = (m_max - sample.y()) / (m_max - m_min) * (m_plot.height() - 1);
+
+    return QPointF(x, y);
+}
+
+QString StripChart::formatValue(qreal value) const
+{
+    // 与 QValueAxis 一致的 printf 风格格式，只替换第一个数值占位符，其余文本原样保留
+    static const QRegularExpression re("%[-+ #0]*\\d*(?:\\.(\\d+))?([fFeEgGdi])");
+
+    auto match = re.match(m_valueFormat);
+    if (!match.hasMatch())
+        return QString::number(value);
+
+    QString number;
+    char conversion = match.captured(2).at(0).toLatin1();
+    int precision = match.captured(1).isEmpty() ? 6 : match.captured(1).toInt();
+
+    if (conversion == 'd' || conversion == 'i')
+        number = QString::number(qRound(value));
+    else
+        number = QString::number(value, (conversion == 'F') ? 'f' : conversion, precision);
+
+    return QString(m_valueFormat).replace(match.capturedStart(), match.capturedLength(), number);
+}
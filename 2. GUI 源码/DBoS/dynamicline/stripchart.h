@@ -0,0 +1,106 @@
+#ifndef STRIPCHART_H
+#define STRIPCHART_H
+
+#include "minmaxpyramid.h"
+
+#include <QImage>
+#include <QPen>
+#include <QPixmap>
+#include <QPointF>
+#include <QQueue>
+#include <QRect>
+#include <QStringList>
+#include <QVector>
+#include <QWidget>
+
+class QPainter;
+
+/* 滚动条带图，DynamicLine 的轻量级 QPainter 后端
+ * 1. 曲线绘制在离屏 QImage 上，每帧按流逝的像素整体左移，只重绘新露出的列
+ * 2. 新样本只绘制它与上一个样本之间的线段
+ * 3. 背景、标题与 Y 轴标签缓存为 QPixmap，仅在范围、格式或尺寸变化时重新生成
+ * 4. X 轴时间标签缓存为 QPixmap，仅在标签文本变化时重新生成
+ * 5. 历史样本保存在最小/最大值金字塔中，滚轮缩放时间跨度后按像素宽度取点重建
+ * 6. 滚动由全局动画时钟驱动，控件不可见时暂停，重新可见时按流逝时间一次补齐
+ */
+class StripChart : public QWidget
+{
+    Q_OBJECT
+
+    struct Series {
+        QPen pen;
+        bool pointsVisible = false;
+        bool visible = true;
+        MinMaxPyramid history;      // 历史样本，尺寸、跨度或范围变化后用于重建
+        QQueue<QPointF> pending;    // 尚未绘制到离屏图像的样本
+        QPointF last;               // 最后一个已绘制的样本
+        bool hasLast = false;
+    };
+
+public:
+    explicit StripChart(QWidget *parent = nullptr);
+    ~StripChart();
+
+    void start(int intervalMsec = 40);                          // 开始滚动，默认 25 帧/秒
+    void stop();                                                // 停止滚动
+
+    int count() const;                                          // 曲线数量
+    void addSeries(const QPen &pen, bool pointsVisible = false);
+    void appendSample(int index, qint64 msecs, double value);   // 追加带时间戳的样本
+    void backfill(int index, const QVector<QPointF> &points);   // 在已有样本之前插入历史样本
+    void setSeriesVisible(int index, bool visible);
+    void setTitle(const QString &title);
+
+    void setHistoryCapacity(int rawCapacity, int budgetBytes);  // 原始样本数与每条曲线的历史内存预算，清空已有历史
+    void setTimeSpanSecs(qint64 secs);
+    qint64 timeSpanSecs() const;
+    void setTimeFormat(const QString &format);
+    void setTimeTickCount(int count);
+    void setRange(qreal min, qreal max);
+    void setValueTickCount(int count);
+    void setValueLabelFormat(const QString &format);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+
+private slots:
+    void advance();
+
+private:
+    void updateLayout();
+    void renderAxes();
+    bool renderTimeLabels();
+    void rebuildPlot();
+    void scrollPlot(int dx);
+    void drawGrid(QPainter *painter, int x, int width);
+    void drawPending();
+    QPointF mapToPlot(const QPointF &sample) const;
+    QString formatValue(qreal value) const;
+
+private:
+    QVector<Series> m_series;
+    QString m_title;
+    QString m_timeFormat  = "HH:mm";
+    QString m_valueFormat = "%.1f";
+    qint64 m_spanSecs     = 60;
+    int m_rawCapacity     = 1024;
+    int m_budgetBytes     = 256 * 1024;
+    int m_timeTickCount   = 5;
+    int m_valueTickCount  = 5;
+    qreal m_min           = 0;
+    qreal m_max           = 100;
+
+    QRect m_plotRect;
+    QRect m_timeLabelRect;
+    QImage m_plot;                  // 离屏曲线图像，尺寸与 m_plotRect 相同
+    QPixmap m_axes;                 // 背景、标题、Y 轴标签与边框
+    QPixmap m_timeLabels;           // X 轴时间标签
+    QStringList m_timeLabelTexts;
+    bool m_axesDirty = true;
+
+    double m_headMsecs = 0;         // 离屏图像右边缘对应的时刻
+};
+
+#endif // STRIPCHART_H
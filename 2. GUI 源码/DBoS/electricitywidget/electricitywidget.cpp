@@ -1,17 +1,39 @@
 #include "electricitywidget.h"
 
 #include "commonhelper.h"
+#include "modulemanager/modulemanager.h"
 #include "simplemessagebox/simplemessagebox.h"
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/ioctl.h>
 #include <fcntl.h>
 #include <unistd.h>
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QSizePolicy>
-#include <QProcess>
+
+namespace {
+
+// 与 dac_drv.c 中的定义一致
+struct DacWave {
+    quint32 shape;
+    quint32 freqMilliHz;
+    quint32 rateHz;
+    quint16 amplitude;
+    quint16 offset;
+};
+
+const unsigned long DAC_IOC_WAVE = _IOW('D', 1, DacWave);
+const unsigned long DAC_IOC_STOP = _IO('D', 2);
+
+const int DacValueMax = 1023;
+const int DacRateMin = 1000;
+const int DacRateMax = 20000;
+const int SamplesPerPeriod = 100;   // 采样率取频率的 100 倍，不低于 DacRateMin，不超过 DacRateMax
+
+}
 
 ElectricityWidget::ElectricityWidget(QWidget *parent) : QDialog(parent)
 {
@@ -24,11 +46,12 @@ ElectricityWidget::~ElectricityWidget()
 {
     if (m_fd != -1) {
         unsigned short value = 0;
+        ::ioctl(m_fd, DAC_IOC_STOP);
         ::write(m_fd, &value, 2);
         ::close(m_fd);
     }
 
-    QProcess::execute("rmmod /driver/dac_drv.ko");
+    ModuleManager::instance()->release("/driver/dac_drv.ko");
 }
 
 void ElectricityWidget::initUi()
@@ -53,14 +76,35 @@ void ElectricityWidget::initUi()
     m_valueLbl.setObjectName("electricity_valueLbl");
     m_valueLbl.setText("0000 mv");
 
+    // 下标减一为驱动中的波形编号
+    m_waveBox.addItems(QStringList() << "直流" << "正弦波" << "方波" << "三角波" << "锯齿波");
+    m_waveBox.setObjectName("electricity_waveBox");
+    m_waveBox.setFocusPolicy(Qt::NoFocus);
+
+    m_freqSlider.setObjectName("electricity_slider");
+    m_freqSlider.setOrientation(Qt::Horizontal);
+    m_freqSlider.setRange(1, 200);
+    m_freqSlider.setEnabled(false);
+
+    m_freqLbl.setObjectName("electricity_valueLbl");
+    m_freqLbl.setText("001 Hz");
+
     auto *pHLayout = new QHBoxLayout;
     pHLayout->addWidget(&m_slider);
     pHLayout->addWidget(&m_valueLbl);
     pHLayout->setMargin(0);
     pHLayout->setSpacing(20);
 
+    auto *pWaveLayout = new QHBoxLayout;
+    pWaveLayout->addWidget(&m_waveBox);
+    pWaveLayout->addWidget(&m_freqSlider, 1);
+    pWaveLayout->addWidget(&m_freqLbl);
+    pWaveLayout->setMargin(0);
+    pWaveLayout->setSpacing(20);
+
     auto *pVLayout = new QVBoxLayout;
     pVLayout->addWidget(&m_dashboard, 1);
+    pVLayout->addLayout(pWaveLayout, 0);
     pVLayout->addLayout(pHLayout, 0);
     pVLayout->setSpacing(40);
     pVLayout->setContentsMargins(30, 20, 30, 30);
@@ -72,14 +116,32 @@ void ElectricityWidget::initUi()
 
 void ElectricityWidget::initCtrl()
 {
-    QProcess::execute("insmod /driver/dac_drv.ko");
+    m_applyTimer.setSingleShot(true);
+    m_applyTimer.setInterval(0);
+    connect(&m_applyTimer, &QTimer::timeout, this, &ElectricityWidget::applyOutput);
+
+    connect(&m_slider, &QSlider::valueChanged, this, &ElectricityWidget::valueChanged);
+    connect(&m_freqSlider, &QSlider::valueChanged, this, &ElectricityWidget::frequencyChanged);
+    connect(&m_waveBox, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this, [this](int index) {
+        m_freqSlider.setEnabled(index != 0);
+        scheduleOutput();
+    });
+
+    ModuleManager::instance()->acquire("/driver/dac_drv.ko", this, [this](bool) {
+        openDevice();
+    });
+}
 
+void ElectricityWidget::openDevice()
+{
     m_fd = ::open("/dev/dac", O_WRONLY);
     if (m_fd < 0) {
         SimpleMessageBox::infomationMessageBox("未检测到设备，请重试");
+        return;
     }
 
-    connect(&m_slider, &QSlider::valueChanged, this, &ElectricityWidget::valueChanged);
+    // 驱动加载期间滑块可能已被拖动
+    applyOutput();
 }
 
 void ElectricityWidget::valueChanged(int value)
@@ -87,12 +149,47 @@ void ElectricityWidget::valueChanged(int value)
     m_dashboard.setValue(value);
     m_valueLbl.setText(QString("%1 mv").arg(value, 4, 10, QChar('0')));
 
-    if (m_fd != -1) {
-        unsigned short t = value / 4;
+    scheduleOutput();
+}
+
+void ElectricityWidget::frequencyChanged(int value)
+{
+    m_freqLbl.setText(QString("%1 Hz").arg(value, 3, 10, QChar('0')));
+
+    scheduleOutput();
+}
+
+void ElectricityWidget::scheduleOutput()
+{
+    if (!m_applyTimer.isActive())
+        m_applyTimer.start();
+}
 
-        if (t > 1023) t = 1023;
+// 波形由驱动中的定时器生成，波形模式下驱动原地更新参数，拖动滑块时不会从头开始
+void ElectricityWidget::applyOutput()
+{
+    m_applyTimer.stop();
+
+    if (m_fd == -1) {
+        return;
+    }
+
+    unsigned short t = qMin(m_slider.value() / 4, DacValueMax);
+
+    if (m_waveBox.currentIndex() == 0) {
+        ::ioctl(m_fd, DAC_IOC_STOP);
         ::write(m_fd, &t, 2);
+        return;
     }
+
+    DacWave wave;
+    wave.shape = m_waveBox.currentIndex() - 1;
+    wave.freqMilliHz = m_freqSlider.value() * 1000;
+    wave.rateHz = qBound(DacRateMin, m_freqSlider.value() * SamplesPerPeriod, DacRateMax);
+    wave.amplitude = t / 2;
+    wave.offset = t / 2;
+
+    ::ioctl(m_fd, DAC_IOC_WAVE, &wave);
 }
 
 
@@ -6,8 +6,10 @@
 #include "colordashboard/colordashboard.h"
 
 #include <QDialog>
+#include <QComboBox>
 #include <QSlider>
 #include <QLabel>
+#include <QTimer>
 
 class ElectricityWidget : public QDialog
 {
@@ -19,15 +21,24 @@ public:
 private:
     void initUi();
     void initCtrl();
+    void openDevice();
+    void scheduleOutput();
 
 private slots:
+    void applyOutput();
     void valueChanged(int value);
+    void frequencyChanged(int value);
 
 private:
     ColorDashboard m_dashboard;
     QSlider m_slider;
     QLabel m_valueLbl;
 
+    QComboBox m_waveBox;            // 直流或驱动生成的波形，滑块为波形的峰值
+    QSlider m_freqSlider;
+    QLabel m_freqLbl;
+
+    QTimer m_applyTimer;            // 同一轮事件循环内的参数变化合并为一次 ioctl
     int m_fd = -1;
 };
 
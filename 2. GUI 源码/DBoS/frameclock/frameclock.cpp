@@ -0,0 +1,222 @@
+#include "frameclock.h"
+
+#include <QApplication>
+#include <QEvent>
+#include <QMovie>
+#include <QWidget>
+
+FrameClock *FrameClock::instance()
+{
+    static FrameClock clock;
+
+    return &clock;
+}
+
+FrameClock::FrameClock() : QObject(NULL)
+{
+    m_clock.start();
+
+    connect(&m_timer, &QTimer::timeout, this, &FrameClock::tick);
+}
+
+FrameClock::~FrameClock()
+{
+}
+
+void FrameClock::subscribe(QWidget *widget, int intervalMs, const Callback &callback)
+{
+    Subscriber subscriber;
+    subscriber.intervalMs = qMax(1, intervalMs);
+    subscriber.callback = callback;
+
+    add(widget, subscriber);
+}
+
+void FrameClock::subscribe(QWidget *widget, QMovie *movie)
+{
+    Subscriber subscriber;
+    subscriber.movie = movie;
+
+    add(widget, subscriber);
+}
+
+void FrameClock::add(QWidget *widget, const Subscriber &subscriber)
+{
+    unsubscribe(widget);
+
+    auto &ret = m_subscribers[widget];
+    ret = subscriber;
+    ret.widget = widget;
+
+    // 控件在构造时可能还没有父窗口，显示后再监视其所在窗口
+    widget->installEventFilter(this);
+    widget->window()->installEventFilter(this);
+    connect(widget, &QObject::destroyed, this, [this, widget]() {
+        m_subscribers.remove(widget);
+        updateTimer();
+    });
+
+    setActive(ret, isExposed(widget));
+    updateTimer();
+}
+
+void FrameClock::unsubscribe(QWidget *widget)
+{
+    auto it = m_subscribers.find(widget);
+    if (it == m_subscribers.end()) {
+        return;
+    }
+
+    setActive(*it, false);
+    m_subscribers.erase(it);
+
+    widget->removeEventFilter(this);
+    disconnect(widget, &QObject::destroyed, this, nullptr);
+
+    updateTimer();
+}
+
+void FrameClock::refresh()
+{
+    if (m_isRefreshPending) {
+        return;
+    }
+
+    // 显示、隐藏等事件发生时布局与窗口状态可能尚未更新，合并到下一轮事件循环计算
+    m_isRefreshPending = true;
+    QTimer::singleShot(0, this, [this]() {
+        m_isRefreshPending = false;
+        updateActive();
+        updateTimer();
+    });
+}
+
+bool FrameClock::eventFilter(QObject *watched, QEvent *event)
+{
+    switch (event->type()) {
+    case QEvent::Show:
+    case QEvent::ParentChange:
+        if (watched->isWidgetType()) {
+            static_cast<QWidget *>(watched)->window()->installEventFilter(this);
+        }
+        refresh();
+        break;
+
+    case QEvent::Hide:
+    case QEvent::WindowActivate:
+    case QEvent::WindowDeactivate:
+    case QEvent::WindowStateChange:
+        refresh();
+        break;
+
+    default:
+        break;
+    }
+
+    return QObject::eventFilter(watched, event);
+}
+
+bool FrameClock::isExposed(const QWidget *widget) const
+{
+    if (!widget->isVisible() || widget->window()->isMinimized()) {
+        return false;
+    }
+
+    // 滚动区域之外（如 SliderWidget 不可见的页面）或被父控件裁剪掉的控件可见区域为空
+    if (widget->visibleRegion().isEmpty()) {
+        return false;
+    }
+
+    // 其他窗口中的模态对话框完全覆盖了本窗口
+    auto modal = QApplication::activeModalWidget();
+    if (modal != nullptr && modal != widget->window() && !modal->isAncestorOf(widget)) {
+        return !modal->frameGeometry().contains(widget->window()->frameGeometry());
+    }
+
+    return true;
+}
+
+void FrameClock::setActive(Subscriber &subscriber, bool isActive)
+{
+    if (subscriber.isActive == isActive) {
+        return;
+    }
+
+    subscriber.isActive = isActive;
+    subscriber.lastMs = m_clock.elapsed();
+
+    if (subscriber.movie.isNull()) {
+        return;
+    }
+
+    if (!isActive && subscriber.movie->state() == QMovie::Running) {
+        subscriber.movie->setPaused(true);
+        subscriber.isMoviePaused = true;
+    }
+    else if (isActive && subscriber.isMoviePaused) {
+        if (subscriber.movie->state() == QMovie::Paused) {
+            subscriber.movie->setPaused(false);
+        }
+        subscriber.isMoviePaused = false;
+    }
+}
+
+void FrameClock::updateActive()
+{
+    for (auto &subscriber : m_subscribers) {
+        setActive(subscriber, isExposed(subscriber.widget));
+    }
+}
+
+void FrameClock::updateTimer()
+{
+    int interval = 0;
+
+    for (const auto &subscriber : m_subscribers) {
+        if (subscriber.isActive && subscriber.callback) {
+            interval = (interval == 0) ? subscriber.intervalMs : qMin(interval, subscriber.intervalMs);
+        }
+    }
+
+    if (interval == 0) {
+        m_timer.stop();
+    }
+    else if (!m_timer.isActive() || m_timer.interval() != interval) {
+        m_timer.start(interval);
+    }
+}
+
+void FrameClock::tick()
+{
+    qint64 now = m_clock.elapsed();
+    bool isChanged = false;
+
+    // 回调中可能订阅或取消订阅，先取出本帧的控件列表
+    const auto widgets = m_subscribers.keys();
+    for (auto widget : widgets) {
+        auto it = m_subscribers.find(widget);
+        if (it == m_subscribers.end() || !it->isActive || !it->callback) {
+            continue;
+        }
+
+        if (!isExposed(widget)) {
+            setActive(*it, false);
+            isChanged = true;
+            continue;
+        }
+
+        // 允许提前半个定时器间隔，避免间隔为整数倍的订阅者因抖动推迟一帧
+        qint64 elapsed = now - it->lastMs;
+        if (elapsed + m_timer.interval() / 2 < it->intervalMs) {
+            continue;
+        }
+
+        it->lastMs = now;
+        Callback callback = it->callback;
+        callback(elapsed);
+    }
+
+    if (isChanged) {
+        updateTimer();
+    }
+}
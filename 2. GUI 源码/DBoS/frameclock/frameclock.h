@@ -0,0 +1,68 @@
+#ifndef FRAMECLOCK_H
+#define FRAMECLOCK_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+
+#include <functional>
+
+class QMovie;
+class QWidget;
+
+/* 全局动画时钟
+ * 1. 所有自绘动画共用一个定时器，同一时刻到期的订阅者在一次唤醒中回调，update() 合并为一次重绘
+ * 2. 定时器间隔取可见订阅者中最小的期望间隔，间隔更大的订阅者在累计时间足够时才回调
+ * 3. 控件隐藏、所在窗口最小化或被模态对话框覆盖、位于 SliderWidget 不可见的页面时暂停回调，没有可见订阅者时定时器停止
+ * 4. QMovie 仍由自身定时器驱动，控件不可见时暂停，重新可见时恢复
+ * 5. 可见性随显示、隐藏与窗口激活事件重新计算；滚动、翻页等不产生事件的变化由调用者 refresh()
+ * 6. 所有接口只能在 GUI 线程调用
+ */
+class FrameClock : public QObject
+{
+    Q_OBJECT
+
+public:
+    using Callback = std::function<void(qint64 elapsedMs)>;     // 参数为距上次回调的毫秒数
+
+    static FrameClock *instance();
+
+    void subscribe(QWidget *widget, int intervalMs, const Callback &callback);
+    void subscribe(QWidget *widget, QMovie *movie);
+    void unsubscribe(QWidget *widget);
+    void refresh();                                             // 稍后重新计算所有订阅者的可见性
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    struct Subscriber {
+        QWidget *widget = nullptr;
+        int intervalMs = 0;
+        Callback callback;
+        QPointer<QMovie> movie;
+        bool isActive = false;
+        bool isMoviePaused = false;     // 影片由时钟暂停，恢复可见时继续播放
+        qint64 lastMs = 0;
+    };
+
+    FrameClock();
+    ~FrameClock();
+
+    void add(QWidget *widget, const Subscriber &subscriber);
+    bool isExposed(const QWidget *widget) const;
+    void setActive(Subscriber &subscriber, bool isActive);
+    void updateActive();
+    void updateTimer();
+    void tick();
+
+private:
+    QHash<QWidget *, Subscriber> m_subscribers;
+    QElapsedTimer m_clock;
+    QTimer m_timer;
+    bool m_isRefreshPending = false;
+};
+
+#endif // FRAMECLOCK_H
@@ -1,13 +1,13 @@
 #include "illuminationwidget.h"
 
+#include "modulemanager/modulemanager.h"
 #include "simplemessagebox/simplemessagebox.h"
 #include "commonhelper.h"
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
-#include <QProcess>
 
-IlluminationWidget::IlluminationWidget(QWidget *parent) : QDialog(parent), m_thread("/dev/ap3216c")
+IlluminationWidget::IlluminationWidget(QWidget *parent) : QDialog(parent)
 {
     initUi();
     initCtrl();
@@ -16,10 +16,10 @@ IlluminationWidget::IlluminationWidget(QWidget *parent) : QDialog(parent), m_thr
 
 IlluminationWidget::~IlluminationWidget()
 {
-    m_thread.quit();
-    m_thread.wait();
+    delete m_pChannel;
+    m_device.close();
 
-    QProcess::execute("rmmod /driver/ap3216c_drv.ko");
+    ModuleManager::instance()->release("/driver/ap3216c_drv.ko");
 }
 
 void IlluminationWidget::initUi()
@@ -89,14 +89,36 @@ void IlluminationWidget::initUi()
 
 void IlluminationWidget::initCtrl()
 {
-    QProcess::execute("insmod /driver/ap3216c_drv.ko");
-
     setValue(0, 0, 0);
 
-    connect(&m_thread, &IlluminationThread::readReady, this, &IlluminationWidget::setValue);
-
-    if (m_thread.start()) {
+    ModuleManager::instance()->acquire("/driver/ap3216c_drv.ko", this, [this](bool) {
+        openDevice();
+    });
+}
 
+void IlluminationWidget::openDevice()
+{
+    // 驱动在后台定时采样，光强或距离超出阈值窗口时推入 IIO 缓冲区
+    SensorConfig config;
+    if (m_device.open("ap3216c", config)) {
+        config.history = QStringList{"ap3216c_ir", "ap3216c_ps", "ap3216c_als"};
+
+        // 扫描顺序为 ir、als（lux）、ps
+        auto decode = config.decoder;
+        config.decoder = [decode](const char *data, int len, SensorSample &sample) {
+            if (!decode(data, len, sample) || sample.count != 3) {
+                return false;
+            }
+            double als = sample.values[1];
+            sample.values[1] = sample.values[2];
+            sample.values[2] = qRound(als);
+            return true;
+        };
+
+        m_pChannel = SensorEngine::instance()->open(config, this);
+    }
+    if (m_pChannel != nullptr) {
+        connect(m_pChannel, &SensorChannel::readyRead, this, &IlluminationWidget::readSample);
     }
     else {
         SimpleMessageBox::infomationMessageBox("未检测到设备，请重试");
@@ -114,5 +136,15 @@ void IlluminationWidget::setValue(unsigned short ir, unsigned short ps, unsigned
     m_alsProgressBar.setValue(als);
 }
 
+void IlluminationWidget::readSample()
+{
+    SensorSample sample;
+    if (!m_pChannel->latest(sample)) {
+        return;
+    }
+
+    setValue(sample.values[0], sample.values[1], sample.values[2]);
+}
+
 
 
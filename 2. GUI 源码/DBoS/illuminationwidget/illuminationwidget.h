@@ -2,7 +2,8 @@
 #define ILLUMINATIONWIDGET_H
 
 #include "wareprogressbar/wareprogressbar.h"
-#include "illuminationthread.h"
+#include "sensorengine/iiodevice.h"
+#include "sensorengine/sensorengine.h"
 
 #include <QDialog>
 #include <QLabel>
@@ -17,9 +18,11 @@ public:
 private:
     void initUi();
     void initCtrl();
+    void openDevice();
 
 private slots:
     void setValue(uint16_t ir, uint16_t ps, uint16_t als);
+    void readSample();
 
 private:
     WareProgressBar m_irProgressBar;
@@ -30,7 +33,8 @@ private:
     QLabel m_psLbl;
     QLabel m_alsLbl;
 
-    IlluminationThread m_thread;
+    IioDevice m_device;
+    SensorChannel *m_pChannel = nullptr;
 };
 
 #endif // ILLUMINATIONWIDGET_H
@@ -1,17 +1,16 @@
 #include "infraredwidget.h"
 
 #include "commonhelper.h"
+#include "frameclock/frameclock.h"
+#include "modulemanager/modulemanager.h"
 #include "simplemessagebox/simplemessagebox.h"
+#include "stylesheet/stylesheetcache.h"
 
 #include <QVBoxLayout>
 #include <QMovie>
 #include <QFile>
-#include <QProcess>
 
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <fcntl.h>
-#include <unistd.h>
+#include <string.h>
 
 InfraredWidget::InfraredWidget(QWidget *parent) : QDialog(parent)
 {
@@ -22,11 +21,9 @@ InfraredWidget::InfraredWidget(QWidget *parent) : QDialog(parent)
 
 InfraredWidget::~InfraredWidget()
 {
-    if (m_fd != -1) {
-        ::close(m_fd);
-    }
+    delete m_pChannel;
 
-    QProcess::execute("rmmod /driver/sr501_drv.ko");
+    ModuleManager::instance()->release("/driver/sr501_drv.ko");
 }
 
 void InfraredWidget::initUi()
@@ -37,6 +34,7 @@ void InfraredWidget::initUi()
 
     m_iconLbl.setObjectName("infrared_icon");
     m_iconLbl.setAlignment(Qt::AlignCenter);
+    FrameClock::instance()->subscribe(&m_iconLbl, &m_move);
 
     m_statusLbl.setObjectName("infrared_state");
     m_statusLbl.setAlignment(Qt::AlignCenter);
@@ -53,14 +51,38 @@ void InfraredWidget::initUi()
 
 void InfraredWidget::initCtrl()
 {
-    QProcess::execute("insmod /driver/sr501_drv.ko");
-
     setStatus(false);
-    connect(&m_timer, &QTimer::timeout, this, &InfraredWidget::timerTimeout);
 
-    m_fd = ::open("/dev/sr501", O_RDONLY | O_NONBLOCK);
-    if (m_fd != -1) {
-        m_timer.start(20);
+    ModuleManager::instance()->acquire("/driver/sr501_drv.ko", this, [this](bool) {
+        openDevice();
+    });
+}
+
+void InfraredWidget::openDevice()
+{
+    SensorConfig config;
+    config.path = "/dev/sr501";
+    config.readSize = 16;
+    config.intervalMs = 0;      // 驱动在电平变化时产生事件，空闲时不占用 CPU
+    config.nonBlock = true;
+    config.decoder = [](const char *data, int len, SensorSample &sample) {
+        // 电平变化的时刻（CLOCK_MONOTONIC 纳秒）、电平、序号；打开后的第一个事件为当前电平
+        qint64 timestamp;
+        quint32 status;
+        if (len != 16) {
+            return false;
+        }
+        memcpy(&timestamp, data, sizeof(timestamp));
+        memcpy(&status, data + 8, sizeof(status));
+        sample.timestamp = timestamp;
+        sample.count = 1;
+        sample.values[0] = !!status;
+        return true;
+    };
+
+    m_pChannel = SensorEngine::instance()->open(config, this);
+    if (m_pChannel != nullptr) {
+        connect(m_pChannel, &SensorChannel::readyRead, this, &InfraredWidget::readSample);
     }
     else {
         SimpleMessageBox::infomationMessageBox("未检测到设备，请重试");
@@ -71,22 +93,30 @@ void InfraredWidget::setStatus(bool isActive)
 {
     if (isActive) {
         m_statusLbl.setText("Have People");
-        m_statusLbl.setStyleSheet("background: rgb(17, 209, 105)");
+        StyleSheetCache::setState(&m_statusLbl, "active", true);
         m_iconLbl.setMovie(&m_move);
         m_move.start();
     }
     else {
         m_move.stop();
         m_statusLbl.setText("No One");
-        m_statusLbl.setStyleSheet("background: rgb(221, 0, 27)");
+        StyleSheetCache::setState(&m_statusLbl, "active", false);
         m_iconLbl.setPixmap(QPixmap());
     }
 }
 
-void InfraredWidget::timerTimeout()
+void InfraredWidget::readSample()
 {
-    int status = 0;
-    if (::read(m_fd, &status, 4) == 4) {
+    SensorSample sample;
+    if (!m_pChannel->latest(sample)) {
+        return;
+    }
+
+    int status = int(sample.values[0]);
+
+    // 状态变化时才更新界面，避免重复设置样式表
+    if (status != m_status) {
+        m_status = status;
         setStatus(!!status);
     }
 }
@@ -1,10 +1,11 @@
 #ifndef INFRAREDWIDGET_H
 #define INFRAREDWIDGET_H
 
+#include "sensorengine/sensorengine.h"
+
 #include <QDialog>
 #include <QLabel>
 #include <QMovie>
-#include <QTimer>
 
 class InfraredWidget : public QDialog
 {
@@ -16,18 +17,19 @@ public:
 private:
     void initUi();
     void initCtrl();
+    void openDevice();
 
 private slots:
     void setStatus(bool isActive = false);
-    void timerTimeout();
+    void readSample();
 
 private:
     QLabel m_iconLbl;
     QLabel m_statusLbl;
     QMovie m_move;
 
-    QTimer m_timer;
-    int m_fd = -1;
+    SensorChannel *m_pChannel = nullptr;
+    int m_status = -1;
 };
 
 #endif // INFRAREDWIDGET_H
@@ -1,6 +1,7 @@
 #include "keywidget.h"
 
 #include "commonhelper.h"
+#include "frameclock/frameclock.h"
 
 #include <QVBoxLayout>
 #include <QMovie>
@@ -37,6 +38,7 @@ void KeyWidget::keyPressEvent(QKeyEvent *event)
 
     if (m_lbl.movie() == nullptr) {
         m_lbl.setMovie(new QMovie(":/misc/keywidget/images/icon.gif", QByteArray(), &m_lbl));
+        FrameClock::instance()->subscribe(&m_lbl, m_lbl.movie());
     }
 
     m_isPlay = !m_isPlay;
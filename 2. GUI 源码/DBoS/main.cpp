@@ -1,14 +1,14 @@
 #include "mainwindow.h"
 
-#include "commonhelper.h"
-
-#include <QApplication>
+#include "perfhud/perfapplication.h"
+#include "stylesheet/stylesheetcache.h"
 
 int main(int argc, char *argv[])
 {
-    QApplication a(argc, argv);
+    PerfApplication a(argc, argv);
 
-    CommonHelper::setStyleSheet(":/misc/resource/style/default.qss", qApp);
+    // 所有页面的样式在启动时合并为一份应用样式表，只解析一次
+    StyleSheetCache::instance()->load(":/misc/resource/style/default.qss", ":/misc");
 
     MainWindow w;
 
@@ -8,7 +8,9 @@
 #include <QSize>
 #include <QWidget>
 
+#include "appregistry/appregistry.h"
 #include "other/other.h"
+#include "perfhud/perfhud.h"
 #include "topwidget/topwidget.h"
 #include "sliderwidget/sliderwidget.h"
 #include "musicwidget/musicwidget.h"
@@ -41,14 +43,13 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+    void initModules();
     void updateSysInfo();
 
-protected:
-    bool eventFilter(QObject *obj, QEvent *event);
-
 private:
     void initUi();
     void initCtrl();
+    void initApps();
 
     void setBackground(const QPixmap &pixmap);
     QWidget *initPage1();
@@ -81,6 +82,7 @@ private:
     SliderWidget *m_pSliderWidget = new SliderWidget(this);
 
     MusicWidget  *m_pMusicWidget = new MusicWidget("/music", this);
-    QDialog *m_pGenericWidget    = nullptr;
+    AppRegistry  *m_pAppRegistry = new AppRegistry(this);
+    PerfHud      *m_pPerfHud     = new PerfHud(this);     // F12 或三指触摸开关
 };
 #endif // MAINWINDOW_H
@@ -1,5 +1,7 @@
 #include "mainwindow.h"
 
+#include "modulemanager/modulemanager.h"
+
 #include <QDateTime>
 #include <QLabel>
 #include <QDateTime>
@@ -8,12 +10,54 @@
 void MainWindow::initCtrl()
 {
     updateSysInfo();
+    initModules();
+    initApps();
 
     m_pMusicWidget->hide();
     m_pMusicWidget->setFixedSize(this->size());
     m_pMusicWidget->setCursor(QCursor(QPixmap(":/misc/resource/image/point.png"), -1, -1));
 }
 
+void MainWindow::initModules()
+{
+    auto manager = ModuleManager::instance();
+
+    // 引脚分配见设备树：dht11、sr501 与 sr04 的 trig 共用 GPIO4_19，sr04 的 echo 与 oled 的 dc 共用 GPIO4_20
+    manager->registerModule("/driver/dht11_drv.ko",   {"gpio4_19"});
+    manager->registerModule("/driver/sr501_drv.ko",   {"gpio4_19"});
+    manager->registerModule("/driver/sr04_drv.ko",    {"gpio4_19", "gpio4_20"});
+    manager->registerModule("/driver/oled_drv.ko",    {"gpio4_20"});
+    manager->registerModule("/driver/ap3216c_drv.ko");
+    manager->registerModule("/driver/dac_drv.ko");
+
+    // 启动后在后台预加载互不冲突的模块，首次打开页面时无需等待
+    manager->preload({"/driver/dht11_drv.ko", "/driver/oled_drv.ko", "/driver/ap3216c_drv.ko", "/driver/dac_drv.ko"});
+}
+
+void MainWindow::initApps()
+{
+    // 第三个参数为 true 的页面不占用硬件，关闭时只隐藏并参与预热
+    m_pAppRegistry->registerApp("camera", [](QWidget *parent) { return new CameraWidget(parent); });
+    m_pAppRegistry->registerApp("calculator", [](QWidget *parent) { return new CalculatorWidget(parent); }, true);
+    m_pAppRegistry->registerApp("weather", [](QWidget *parent) { return new WeatherWidget(parent); }, true);
+    m_pAppRegistry->registerApp("system", [](QWidget *parent) { return new SystemWidget(parent); }, true);
+    m_pAppRegistry->registerApp("recorder", [](QWidget *parent) { return new RecorderWidget(parent); });
+    m_pAppRegistry->registerApp("backlight", [](QWidget *parent) { return new BacklightWidget(parent); }, true);
+    m_pAppRegistry->registerApp("video", [](QWidget *parent) { return new VideoWidget("/video", parent); });
+    m_pAppRegistry->registerApp("oled", [](QWidget *parent) { return new OledWidget(parent); });
+    m_pAppRegistry->registerApp("remoteCtrl", [](QWidget *parent) { return new RemoteCtrlWidget(parent); });
+    m_pAppRegistry->registerApp("ultrasonicwave", [](QWidget *parent) { return new UltrasonicwaveWidget(parent); });
+    m_pAppRegistry->registerApp("photosensitive", [](QWidget *parent) { return new PhotosensitiveWidget(parent); });
+    m_pAppRegistry->registerApp("electricity", [](QWidget *parent) { return new ElectricityWidget(parent); });
+    m_pAppRegistry->registerApp("infrared", [](QWidget *parent) { return new InfraredWidget(parent); });
+    m_pAppRegistry->registerApp("illumination", [](QWidget *parent) { return new IlluminationWidget(parent); });
+    m_pAppRegistry->registerApp("key", [](QWidget *parent) { return new KeyWidget(parent); });
+    m_pAppRegistry->registerApp("map", [](QWidget *parent) { return new MapWidget(parent); });
+    m_pAppRegistry->registerApp("temperature", [](QWidget *parent) { return new TemperatureWidget(parent); });
+
+    m_pAppRegistry->prewarm(3000);
+}
+
 void MainWindow::updateSysInfo()
 {
     auto timer = new QTimer(this);
@@ -26,11 +70,7 @@ void MainWindow::updateSysInfo()
 
 void MainWindow::cameraBtnClicked()
 {
-    m_pGenericWidget = new CameraWidget(this);
-    m_pGenericWidget->installEventFilter(this);
-    m_pGenericWidget->setFixedSize(this->size());
-    m_pGenericWidget->setCursor(QCursor(QPixmap(":/misc/resource/image/point.png"), -1, -1));
-    m_pGenericWidget->show();
+    m_pAppRegistry->launch("camera");
 }
 
 void MainWindow::musicBtnClicked()
@@ -40,168 +80,80 @@ void MainWindow::musicBtnClicked()
 
 void MainWindow::calculatorBtnClicked()
 {
-    m_pGenericWidget = new CalculatorWidget(this);
-    m_pGenericWidget->installEventFilter(this);
-    m_pGenericWidget->setFixedSize(this->size());
-    m_pGenericWidget->setCursor(QCursor(QPixmap(":/misc/resource/image/point.png"), -1, -1));
-    m_pGenericWidget->show();
+    m_pAppRegistry->launch("calculator");
 }
 
 void MainWindow::weatherBtnClicked()
 {
-    m_pGenericWidget = new WeatherWidget(this);
-    m_pGenericWidget->installEventFilter(this);
-    m_pGenericWidget->setFixedSize(this->size());
-    m_pGenericWidget->setCursor(QCursor(QPixmap(":/misc/resource/image/point.png"), -1, -1));
-    m_pGenericWidget->show();
+    m_pAppRegistry->launch("weather");
 }
 
 void MainWindow::systemBtnClicked()
 {
-    m_pGenericWidget = new SystemWidget(this);
-    m_pGenericWidget->installEventFilter(this);
-    m_pGenericWidget->setFixedSize(this->size());
-    m_pGenericWidget->setCursor(QCursor(QPixmap(":/misc/resource/image/point.png"), -1, -1));
-    m_pGenericWidget->show();
+    m_pAppRegistry->launch("system");
 }
 
 void MainWindow::recorderBtnClicked()
 {
-    m_pGenericWidget = new RecorderWidget(this);
-    m_pGenericWidget->installEventFilter(this);
-    m_pGenericWidget->setFixedSize(this->size());
-    m_pGenericWidget->setCursor(QCursor(QPixmap(":/misc/resource/image/point.png"), -1, -1));
-    m_pGenericWidget->show();
+    m_pAppRegistry->launch("recorder");
 }
 
 void MainWindow::backlightBtnClicked()
 {
-    m_pGenericWidget = new BacklightWidget(this);
-    m_pGenericWidget->installEventFilter(this);
-    m_pGenericWidget->setFixedSize(this->size());
-    m_pGenericWidget->setCursor(QCursor(QPixmap(":/misc/resource/image/point.png"), -1, -1));
-    m_pGenericWidget->show();
+    m_pAppRegistry->launch("backlight");
 }
 
 void MainWindow::videoBtnClicked()
 {
-    m_pGenericWidget = new VideoWidget("/video", this);
-    m_pGenericWidget->installEventFilter(this);
-    m_pGenericWidget->setFixedSize(this->size());
-    m_pGenericWidget->setCursor(QCursor(QPixmap(":/misc/resource/image/point.png"), -1, -1));
-    m_pGenericWidget->show();
+    m_pAppRegistry->launch("video");
 }
 
 void MainWindow::oledBtnClicked()
 {
-    m_pGenericWidget = new OledWidget(this);
-    m_pGenericWidget->installEventFilter(this);
-    m_pGenericWidget->setFixedSize(this->size());
-    m_pGenericWidget->setCursor(QCursor(QPixmap(":/misc/resource/image/point.png"), -1, -1));
-    m_pGenericWidget->show();
+    m_pAppRegistry->launch("oled");
 }
 
 void MainWindow::remoteCtrlBtnClicked()
 {
-    m_pGenericWidget = new RemoteCtrlWidget(this);
-    m_pGenericWidget->installEventFilter(this);
-    m_pGenericWidget->setFixedSize(this->size());
-    m_pGenericWidget->setCursor(QCursor(QPixmap(":/misc/resource/image/point.png"), -1, -1));
-    m_pGenericWidget->show();
+    m_pAppRegistry->launch("remoteCtrl");
 }
 
 void MainWindow::ultrasonicwaveBtnClicked()
 {
-    m_pGenericWidget = new UltrasonicwaveWidget(this);
-    m_pGenericWidget->installEventFilter(this);
-    m_pGenericWidget->setFixedSize(this->size());
-    m_pGenericWidget->setCursor(QCursor(QPixmap(":/misc/resource/image/point.png"), -1, -1));
-    m_pGenericWidget->show();
+    m_pAppRegistry->launch("ultrasonicwave");
 }
 
 void MainWindow::photosensitiveBtnClicked()
 {
-    m_pGenericWidget = new PhotosensitiveWidget(this);
-    m_pGenericWidget->installEventFilter(this);
-    m_pGenericWidget->setFixedSize(this->size());
-    m_pGenericWidget->setCursor(QCursor(QPixmap(":/misc/resource/image/point.png"), -1, -1));
-    m_pGenericWidget->show();
+    m_pAppRegistry->launch("photosensitive");
 }
 
 void MainWindow::electricityBtnClicked()
 {
-    m_pGenericWidget = new ElectricityWidget(this);
-    m_pGenericWidget->installEventFilter(this);
-    m_pGenericWidget->setFixedSize(this->size());
-    m_pGenericWidget->setCursor(QCursor(QPixmap(":/misc/resource/image/point.png"), -1, -1));
-    m_pGenericWidget->show();
+    m_pAppRegistry->launch("electricity");
 }
 
 void MainWindow::infraredBtnClicked()
 {
-    m_pGenericWidget = new InfraredWidget(this);
-    m_pGenericWidget->installEventFilter(this);
-    m_pGenericWidget->setFixedSize(this->size());
-    m_pGenericWidget->setCursor(QCursor(QPixmap(":/misc/resource/image/point.png"), -1, -1));
-    m_pGenericWidget->show();
+    m_pAppRegistry->launch("infrared");
 }
 
 void MainWindow::illuminationBtnClicked()
 {
-    m_pGenericWidget = new IlluminationWidget(this);
-    m_pGenericWidget->installEventFilter(this);
-    m_pGenericWidget->setFixedSize(this->size());
-    m_pGenericWidget->setCursor(QCursor(QPixmap(":/misc/resource/image/point.png"), -1, -1));
-    m_pGenericWidget->show();
+    m_pAppRegistry->launch("illumination");
 }
 
 void MainWindow::keyBtnClicked()
 {
-    m_pGenericWidget = new KeyWidget(this);
-    m_pGenericWidget->installEventFilter(this);
-    m_pGenericWidget->setFixedSize(this->size());
-    m_pGenericWidget->setCursor(QCursor(QPixmap(":/misc/resource/image/point.png"), -1, -1));
-    m_pGenericWidget->show();
+    m_pAppRegistry->launch("key");
 }
 
 void MainWindow::mapBtnClicked()
 {
-    m_pGenericWidget = new MapWidget(this);
-    m_pGenericWidget->installEventFilter(this);
-    m_pGenericWidget->setFixedSize(this->size());
-    m_pGenericWidget->setCursor(QCursor(QPixmap(":/misc/resource/image/point.png"), -1, -1));
-    m_pGenericWidget->show();
+    m_pAppRegistry->launch("map");
 }
 
 void MainWindow::temperatureBtnClicked()
 {
-    m_pGenericWidget = new TemperatureWidget(this);
-    m_pGenericWidget->installEventFilter(this);
-    m_pGenericWidget->setFixedSize(this->size());
-    m_pGenericWidget->setCursor(QCursor(QPixmap(":/misc/resource/image/point.png"), -1, -1));
-    m_pGenericWidget->show();
-}
-
-bool MainWindow::eventFilter(QObject *obj, QEvent *event)
-{
-    auto ptr = m_pGenericWidget;
-    if ((ptr != nullptr) && (ptr == obj)) {
-        if (event->type() == QEvent::KeyPress) {
-            auto keyEvt = reinterpret_cast<QKeyEvent*>(event);
-            if (keyEvt != nullptr && keyEvt->key() == Qt::Key_Escape) {
-                removeEventFilter(ptr);
-                delete ptr;
-                return true;
-            }
-        }
-        else if (event->type() == QEvent::Close) {
-            removeEventFilter(ptr);
-            delete ptr;
-            return true;
-        }
-    }
-
-    return false;
+    m_pAppRegistry->launch("temperature");
 }
-
-
@@ -1,6 +1,7 @@
 #include "mapwidget.h"
 
 #include "simplemessagebox/simplemessagebox.h"
+#include "frameclock/frameclock.h"
 #include "commonhelper.h"
 
 #include <QSslConfiguration>
@@ -33,6 +34,7 @@ void MapWidget::initUi()
     m_logoLabel.setText(QString("当前展示定位坐标：[") +m_location + "]");
 
     m_iconLabel.setMovie(pMovie);
+    FrameClock::instance()->subscribe(&m_iconLabel, pMovie);
     m_iconLabel.setAlignment(Qt::AlignCenter);
     m_logoLabel.setAlignment(Qt::AlignRight);
 
@@ -0,0 +1,285 @@
+#include "modulemanager.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrent>
+
+#include <sys/syscall.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace {
+
+// 在线程池中执行，返回 0 或 errno
+int loadModule(const QByteArray &path)
+{
+    int fd = ::open(path.constData(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return errno;
+    }
+
+    int err = (::syscall(SYS_finit_module, fd, "", 0) == 0) ? 0 : errno;
+
+    // 内核不支持 finit_module 时读入内存后调用 init_module
+    if (err == ENOSYS) {
+        QFile file;
+        if (file.open(fd, QIODevice::ReadOnly)) {
+            QByteArray image = file.readAll();
+            err = (::syscall(SYS_init_module, image.constData(), size_t(image.size()), "") == 0) ? 0 : errno;
+        }
+    }
+
+    ::close(fd);
+
+    return (err == EEXIST) ? 0 : err;
+}
+
+int unloadModule(const QByteArray &name)
+{
+    // O_NONBLOCK：模块仍被使用时立即返回 EWOULDBLOCK，不等待
+    if (::syscall(SYS_delete_module, name.constData(), O_NONBLOCK) == 0) {
+        return 0;
+    }
+
+    return (errno == ENOENT) ? 0 : errno;
+}
+
+}
+
+ModuleManager *ModuleManager::instance()
+{
+    static ModuleManager manager;
+
+    return &manager;
+}
+
+ModuleManager::ModuleManager() : QObject(NULL)
+{
+}
+
+ModuleManager::~ModuleManager()
+{
+    qDeleteAll(m_modules);
+}
+
+void ModuleManager::registerModule(const QString &path, const QStringList &resources)
+{
+    module(path)->resources = resources;
+}
+
+void ModuleManager::setIdleTimeout(int msecs)
+{
+    m_idleTimeout = msecs;
+}
+
+ModuleManager::Module *ModuleManager::module(const QString &path)
+{
+    auto ret = m_modules.value(path);
+    if (ret != nullptr) {
+        return ret;
+    }
+
+    ret = new Module;
+    ret->path = path;
+    ret->name = QFileInfo(path).completeBaseName().replace('-', '_');
+    ret->idleTimer.setSingleShot(true);
+
+    connect(&ret->idleTimer, &QTimer::timeout, this, [this, ret]() {
+        if ((ret->refs == 0) && (ret->state == Loaded)) {
+            startUnload(ret);
+        }
+    });
+
+    m_modules.insert(path, ret);
+
+    return ret;
+}
+
+QList<ModuleManager::Module *> ModuleManager::conflicts(const Module *target) const
+{
+    QList<Module *> ret;
+
+    for (auto other : m_modules) {
+        if (other == target) {
+            continue;
+        }
+
+        for (const auto &resource : target->resources) {
+            if (other->resources.contains(resource)) {
+                ret.append(other);
+                break;
+            }
+        }
+    }
+
+    return ret;
+}
+
+void ModuleManager::preload(const QStringList &paths)
+{
+    for (const auto &path : paths) {
+        module(path)->isPinned = true;
+    }
+
+    schedule();
+}
+
+void ModuleManager::acquire(const QString &path, QObject *context, const Callback &callback)
+{
+    auto target = module(path);
+
+    ++target->refs;
+    target->idleTimer.stop();
+
+    if (target->state == Loaded) {
+        callback(true);
+        return;
+    }
+
+    target->waiters.append(Waiter{context, callback});
+
+    schedule();
+}
+
+void ModuleManager::release(const QString &path)
+{
+    auto target = module(path);
+
+    target->refs = qMax(target->refs - 1, 0);
+
+    if (target->refs == 0) {
+        target->isPinned = false;
+        if (target->state == Loaded) {
+            target->idleTimer.start(m_idleTimeout);
+        }
+    }
+}
+
+bool ModuleManager::isLoaded(const QString &path) const
+{
+    auto target = m_modules.value(path);
+
+    return (target != nullptr) && (target->state == Loaded);
+}
+
+void ModuleManager::schedule()
+{
+    // 回调中可能登记新的模块，遍历副本
+    for (auto target : m_modules.values()) {
+        if (target->state != Unloaded) {
+            continue;
+        }
+
+        bool isRequested = !target->waiters.isEmpty();
+        if (!isRequested && !target->isPinned) {
+            continue;
+        }
+
+        bool isBlocked = false;
+        bool isRefused = false;
+
+        for (auto other : conflicts(target)) {
+            if (other->refs > 0 || (other->isPinned && !isRequested)) {
+                isRefused = true;
+            }
+            else if (other->state == Loaded && isRequested) {
+                // 冲突的模块空闲：立即卸载，不等空闲超时
+                other->isPinned = false;
+                startUnload(other);
+                isBlocked = true;
+            }
+            else if (other->state != Unloaded) {
+                isBlocked = true;
+            }
+        }
+
+        if (isRefused) {
+            // 预加载让位于其他模块；正在使用的冲突模块不能卸载，本次请求失败
+            target->isPinned = false;
+            if (isRequested) {
+                qWarning("ModuleManager: %s conflicts with a module in use", qPrintable(target->name));
+                notify(target, false);
+            }
+        }
+        else if (!isBlocked) {
+            startLoad(target);
+        }
+    }
+}
+
+void ModuleManager::startLoad(Module *target)
+{
+    target->state = Loading;
+
+    auto watcher = new QFutureWatcher<int>(this);
+    connect(watcher, &QFutureWatcher<int>::finished, this, [this, watcher, target]() {
+        int err = watcher->result();
+        watcher->deleteLater();
+
+        if (err != 0) {
+            qWarning("ModuleManager: load %s failed: %s", qPrintable(target->path), strerror(err));
+            target->isPinned = false;
+        }
+
+        target->state = (err == 0) ? Loaded : Unloaded;
+
+        if ((target->state == Loaded) && (target->refs == 0) && !target->isPinned) {
+            target->idleTimer.start(m_idleTimeout);
+        }
+
+        notify(target, err == 0);
+        schedule();
+    });
+
+    watcher->setFuture(QtConcurrent::run(loadModule, QFile::encodeName(target->path)));
+}
+
+void ModuleManager::startUnload(Module *target)
+{
+    target->state = Unloading;
+    target->idleTimer.stop();
+
+    auto watcher = new QFutureWatcher<int>(this);
+    connect(watcher, &QFutureWatcher<int>::finished, this, [this, watcher, target]() {
+        int err = watcher->result();
+        watcher->deleteLater();
+
+        if (err == 0) {
+            target->state = Unloaded;
+            emit moduleUnloaded(target->path);
+        }
+        else {
+            // 设备文件仍被打开等原因卸载失败，稍后再试
+            target->state = Loaded;
+            if (target->refs == 0) {
+                target->idleTimer.start(m_idleTimeout);
+            }
+
+            // 卸载期间到达的 acquire() 在等待队列中，模块仍然可用，直接通知
+            if (!target->waiters.isEmpty()) {
+                notify(target, true);
+            }
+        }
+
+        schedule();
+    });
+
+    watcher->setFuture(QtConcurrent::run(unloadModule, target->name.toLatin1()));
+}
+
+void ModuleManager::notify(Module *target, bool isLoaded)
+{
+    auto waiters = target->waiters;
+    target->waiters.clear();
+
+    for (const auto &waiter : waiters) {
+        if (!waiter.context.isNull()) {
+            waiter.callback(isLoaded);
+        }
+    }
+
+    emit moduleLoaded(target->path, isLoaded);
+}
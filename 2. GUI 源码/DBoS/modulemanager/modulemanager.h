@@ -0,0 +1,81 @@
+#ifndef MODULEMANAGER_H
+#define MODULEMANAGER_H
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QStringList>
+#include <QTimer>
+
+#include <functional>
+
+/* 驱动模块管理
+ * 1. 通过 finit_module / delete_module 系统调用在线程池中加载与卸载，不创建进程，不阻塞 GUI 线程
+ * 2. 按使用者引用计数，最后一个使用者释放后经过空闲超时才卸载，短时间内重复打开页面无需重新加载
+ * 3. 占用相同引脚的模块互斥，加载前先卸载空闲的冲突模块
+ * 4. preload() 预加载的模块在第一次被使用并释放之前不会因空闲而卸载
+ * 5. 所有接口只能在 GUI 线程调用
+ */
+class ModuleManager : public QObject
+{
+    Q_OBJECT
+
+    using Callback = std::function<void(bool isLoaded)>;
+
+    enum State {
+        Unloaded,
+        Loading,
+        Loaded,
+        Unloading
+    };
+
+    struct Waiter {
+        QPointer<QObject> context;
+        Callback callback;
+    };
+
+    struct Module {
+        QString path;
+        QString name;               // 内核中的模块名
+        QStringList resources;      // 占用的引脚等资源，资源相同的模块互斥
+        State state = Unloaded;
+        int refs = 0;
+        bool isPinned = false;
+        QTimer idleTimer;
+        QList<Waiter> waiters;
+    };
+
+public:
+    static ModuleManager *instance();
+
+    void registerModule(const QString &path, const QStringList &resources = QStringList());
+    void setIdleTimeout(int msecs);
+    void preload(const QStringList &paths);
+
+    // 增加引用并在需要时加载；模块可用或加载失败时在 GUI 线程调用 callback，context 析构后不再调用
+    void acquire(const QString &path, QObject *context, const Callback &callback);
+    void release(const QString &path);
+    bool isLoaded(const QString &path) const;
+
+signals:
+    void moduleLoaded(const QString &path, bool isLoaded);
+    void moduleUnloaded(const QString &path);
+
+private:
+    ModuleManager();
+    ~ModuleManager();
+
+    Module *module(const QString &path);
+    QList<Module *> conflicts(const Module *target) const;
+    void schedule();
+    void startLoad(Module *target);
+    void startUnload(Module *target);
+    void notify(Module *target, bool isLoaded);
+
+private:
+    QHash<QString, Module *> m_modules;
+    int m_idleTimeout = 60 * 1000;
+};
+
+#endif // MODULEMANAGER_H
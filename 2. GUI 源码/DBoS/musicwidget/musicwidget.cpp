@@ -1,6 +1,7 @@
 #include "musicwidget.h"
 
 #include "commonhelper.h"
+#include "stylesheet/stylesheetcache.h"
 
 #include <QFile>
 #include <QFileInfoList>
@@ -323,20 +324,20 @@ void MusicWidget::currentIndexChanged(int position)
 void MusicWidget::musicStateChanged(QMediaPlayer::State state)
 {
     if (state == QMediaPlayer::PlayingState) {
-        m_pauseBtn.setStyleSheet("image: url(:/misc/musicwidget/images/pause.png);");
+        StyleSheetCache::setState(&m_pauseBtn, "playing", true);
     }
     else {
-        m_pauseBtn.setStyleSheet("image: url(:/misc/musicwidget/images/play.png);");
+        StyleSheetCache::setState(&m_pauseBtn, "playing", false);
     }
 }
 
 void MusicWidget::mutedChanged(bool muted)
 {
     if (muted) {
-        m_volumeBtn.setStyleSheet("image: url(:/misc/musicwidget/images/mute.png);");
+        StyleSheetCache::setState(&m_volumeBtn, "muted", true);
     }
     else {
-        m_volumeBtn.setStyleSheet("image: url(:/misc/musicwidget/images/sound.png);");
+        StyleSheetCache::setState(&m_volumeBtn, "muted", false);
     }
 }
 
@@ -377,13 +378,13 @@ void MusicWidget::modeBtnClicked()
     m_playlist.setPlaybackMode(static_cast<QMediaPlaylist::PlaybackMode>(index));
 
     if (m_playlist.playbackMode() == QMediaPlaylist::CurrentItemInLoop) {
-        m_modeBtn.setStyleSheet("image: url(:/misc/musicwidget/images/currentitemInloop.png);");
+        StyleSheetCache::setState(&m_modeBtn, "mode", "currentItemInLoop");
     } else if (m_playlist.playbackMode() == QMediaPlaylist::Sequential) {
-        m_modeBtn.setStyleSheet("image: url(:/misc/musicwidget/images/sequential.png);");
+        StyleSheetCache::setState(&m_modeBtn, "mode", "sequential");
     } else if (m_playlist.playbackMode() == QMediaPlaylist::Loop) {
-        m_modeBtn.setStyleSheet("image: url(:/misc/musicwidget/images/loop.png);");
+        StyleSheetCache::setState(&m_modeBtn, "mode", "loop");
     }  else if (m_playlist.playbackMode() == QMediaPlaylist::Random) {
-        m_modeBtn.setStyleSheet("image: url(:/misc/musicwidget/images/random.png);");
+        StyleSheetCache::setState(&m_modeBtn, "mode", "random");
     }
 }
 
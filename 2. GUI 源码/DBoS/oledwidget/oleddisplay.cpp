@@ -0,0 +1,109 @@
+#include "oleddisplay.h"
+
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace {
+
+// 与 oled_drv.c 中的定义一致
+struct OledText {
+    unsigned char row;
+    char text[OledDisplay::Columns];
+};
+
+struct OledScroll {
+    unsigned char direction;
+    unsigned char startRow;
+    unsigned char endRow;
+    unsigned char speed;
+    unsigned char verticalOffset;
+};
+
+const unsigned long OLED_IOC_TEXT        = _IOW('O', 0, OledText);
+const unsigned long OLED_IOC_SCROLL      = _IOW('O', 1, OledScroll);
+const unsigned long OLED_IOC_SCROLL_STOP = _IO('O', 2);
+
+}
+
+OledDisplay::~OledDisplay()
+{
+    close();
+}
+
+bool OledDisplay::open()
+{
+    if (m_fd == -1) {
+        m_fd = ::open("/dev/myoled", O_WRONLY | O_CLOEXEC);
+    }
+
+    return m_fd != -1;
+}
+
+void OledDisplay::close()
+{
+    if (m_fd != -1) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+bool OledDisplay::isOpen() const
+{
+    return m_fd != -1;
+}
+
+bool OledDisplay::showChar(int x, int page, char c)
+{
+    if (m_fd == -1) {
+        return false;
+    }
+
+    char data[3] = {char(x), char(page), c};
+
+    return ::write(m_fd, data, 3) == 3;
+}
+
+bool OledDisplay::showText(int row, const QString &text)
+{
+    if (m_fd == -1 || row < 0 || row >= Rows) {
+        return false;
+    }
+
+    OledText arg;
+    memset(&arg, 0, sizeof(arg));
+    arg.row = row;
+
+    for (int i=0; i<Columns && i<text.size(); i++) {
+        ushort ch = text.at(i).unicode();
+        arg.text[i] = (ch >= ' ' && ch <= '~') ? char(ch) : ' ';
+    }
+
+    return ::ioctl(m_fd, OLED_IOC_TEXT, &arg) == 0;
+}
+
+bool OledDisplay::startScroll(int startRow, int endRow, ScrollDirection direction, int speed, int verticalOffset)
+{
+    if (m_fd == -1) {
+        return false;
+    }
+
+    OledScroll arg;
+    arg.direction = direction;
+    arg.startRow = startRow;
+    arg.endRow = endRow;
+    arg.speed = speed;
+    arg.verticalOffset = verticalOffset;
+
+    return ::ioctl(m_fd, OLED_IOC_SCROLL, &arg) == 0;
+}
+
+bool OledDisplay::stopScroll()
+{
+    if (m_fd == -1) {
+        return false;
+    }
+
+    return ::ioctl(m_fd, OLED_IOC_SCROLL_STOP) == 0;
+}
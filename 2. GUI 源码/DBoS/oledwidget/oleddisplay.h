@@ -0,0 +1,46 @@
+#ifndef OLEDDISPLAY_H
+#define OLEDDISPLAY_H
+
+#include <QString>
+
+/* /dev/myoled 的封装
+ * 1. 屏幕分为 4 行，每行 16 个 8x16 字符
+ * 2. 滚动由 SSD1306 自行完成，启动后不再占用 CPU 与 SPI；之后写入内容会从头开始滚动
+ * 3. 设备关闭时驱动停止滚动并清屏
+ */
+class OledDisplay
+{
+public:
+    enum ScrollDirection {
+        ScrollRight,
+        ScrollLeft,
+        ScrollVerticalRight,
+        ScrollVerticalLeft
+    };
+
+    static constexpr int Rows = 4;
+    static constexpr int Columns = 16;
+    static constexpr int MaxSpeed = 7;
+
+    OledDisplay() = default;
+    ~OledDisplay();
+
+    OledDisplay(const OledDisplay &) = delete;
+    OledDisplay &operator=(const OledDisplay &) = delete;
+
+    bool open();
+    void close();
+    bool isOpen() const;
+
+    bool showChar(int x, int page, char c);                 // x 为像素列 0-127，page 为页 0-7
+    bool showText(int row, const QString &text);            // 超过 16 个字符的部分被截掉，非 ASCII 字符显示为空格
+
+    // speed 0 最慢（256 帧移动一列），7 最快（2 帧）；verticalOffset 仅用于斜向滚动，1-63
+    bool startScroll(int startRow, int endRow, ScrollDirection direction, int speed, int verticalOffset = 1);
+    bool stopScroll();
+
+private:
+    int m_fd = -1;
+};
+
+#endif // OLEDDISPLAY_H
@@ -1,17 +1,14 @@
 #include "oledwidget.h"
 
+#include "modulemanager/modulemanager.h"
 #include "simplemessagebox/simplemessagebox.h"
 #include "commonhelper.h"
 
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <fcntl.h>
-#include <unistd.h>
-
 #include <QHBoxLayout>
+#include <QHostAddress>
+#include <QNetworkInterface>
 #include <QVBoxLayout>
 #include <QtMath>
-#include <QProcess>
 
 OledWidget::OledWidget(QWidget *parent) : QDialog(parent)
 {
@@ -22,11 +19,9 @@ OledWidget::OledWidget(QWidget *parent) : QDialog(parent)
 
 OledWidget::~OledWidget()
 {
-    if (m_fd != -1) {
-        ::close(m_fd);
-    }
+    m_display.close();
 
-    QProcess::execute("rmmod /driver/oled_drv.ko");
+    ModuleManager::instance()->release("/driver/oled_drv.ko");
 }
 
 
@@ -37,7 +32,6 @@ void OledWidget::initUi()
     m_numBox.addItems(numList);
     m_numBox.setObjectName("oled_numBox");
     m_numBox.setFocusPolicy(Qt::NoFocus);
-    m_numBox.setStyleSheet("QComboBox#oled_numBox QAbstractItemView {background: rgb(75, 75, 75);border: none;font: normal normal 28px;outline: none;}");
 
     m_studyBtn.setText("学习");
     m_studyBtn.setObjectName("oled_studyBtn");
@@ -74,18 +68,39 @@ void OledWidget::initUi()
 
 void OledWidget::initCtrl()
 {
-    QProcess::execute("insmod /driver/oled_drv.ko");
-
-    m_fd = ::open("/dev/myoled", O_WRONLY);
-    if (m_fd < 0) {
-        SimpleMessageBox::infomationMessageBox("未检测到设备，请重试");
-    }
-
     initRecord();
 
     connect(&m_studyBtn, &QPushButton::clicked, this, &OledWidget::studyBtnClicked);
     connect(&m_clearBtn, &QPushButton::clicked, this, &OledWidget::clearBtnClicked);
     connect(&m_identifyBtn, &QPushButton::clicked, this, &OledWidget::identifyBtnClicked);
+
+    ModuleManager::instance()->acquire("/driver/oled_drv.ko", this, [this](bool) {
+        openDevice();
+    });
+}
+
+void OledWidget::openDevice()
+{
+    if (!m_display.open()) {
+        SimpleMessageBox::infomationMessageBox("未检测到设备，请重试");
+        return;
+    }
+
+    // 第一行显示本机地址，由面板自行滚动
+    m_display.showText(0, "IP " + localAddress());
+    m_display.startScroll(0, 0, OledDisplay::ScrollLeft, 3);
+}
+
+QString OledWidget::localAddress()
+{
+    const auto addresses = QNetworkInterface::allAddresses();
+    for (const auto &address : addresses) {
+        if (address.protocol() == QAbstractSocket::IPv4Protocol && !address.isLoopback()) {
+            return address.toString();
+        }
+    }
+
+    return "--";
 }
 
 void OledWidget::initRecord()
@@ -240,13 +255,7 @@ void OledWidget::identifyBtnClicked()
         SimpleMessageBox::infomationMessageBox("请首先教我识字喔~~~");
     }
     else {
-        if (m_fd > 0) {
-            char data[3];
-            data[0] = 63;
-            data[1] = 4;
-            data[2] = index + 48;
-            ::write(m_fd, data, 3);
-        }
+        m_display.showChar(63, 4, index + 48);
 
         SimpleMessageBox::infomationMessageBox("本次结果 : [ " + QString::number(index) + " ]");
     }
@@ -2,6 +2,7 @@
 #define OLEDWIDGET_H
 
 #include "drawwidget.h"
+#include "oleddisplay.h"
 
 #include <QDialog>
 #include <QComboBox>
@@ -21,7 +22,9 @@ public:
 private:
     void initUi();
     void initCtrl();
+    void openDevice();
     void initRecord();
+    static QString localAddress();
 
     QByteArray calFeature(QList<QList<QPoint>>* list);
     bool checkRecordIsValid(const QByteArray& input_record, QByteArray& output_record);
@@ -43,7 +46,7 @@ private:
     QVector<QList<QByteArray>> m_record;
     QFile m_file;
 
-    int m_fd = -1;
+    OledDisplay m_display;
 };
 
 #endif // OLEDWIDGET_H
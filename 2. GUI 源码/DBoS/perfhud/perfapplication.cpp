@@ -0,0 +1,56 @@
+#include "perfapplication.h"
+
+#include "perfhud.h"
+
+#include <QElapsedTimer>
+#include <QPointer>
+
+PerfApplication::PerfApplication(int &argc, char **argv) : QApplication(argc, argv)
+{
+}
+
+bool PerfApplication::notify(QObject *receiver, QEvent *event)
+{
+    switch (event->type()) {
+    case QEvent::KeyPress:
+    case QEvent::TouchBegin:
+    case QEvent::TouchUpdate:
+    case QEvent::TouchEnd:
+    case QEvent::TouchCancel:
+        // 输入事件先到达 QWindow 再转发给控件，只在 QWindow 处检查一次
+        if (receiver->isWindowType() && PerfHud::instance() != nullptr && PerfHud::instance()->handleInput(receiver, event)) {
+            return true;
+        }
+        break;
+
+    case QEvent::Paint:
+    case QEvent::UpdateRequest:
+        // 控件只存在于 GUI 线程，其他线程的事件在 isWidgetType() 处返回
+        if (receiver->isWidgetType() && PerfHud::active() != nullptr) {
+            QPointer<QWidget> widget = static_cast<QWidget *>(receiver);
+            bool isPaint = (event->type() == QEvent::Paint);
+            QElapsedTimer timer;
+
+            timer.start();
+            bool ret = QApplication::notify(receiver, event);
+            qint64 ns = timer.nsecsElapsed();
+
+            // HUD 可能在事件处理过程中被关闭，控件可能在事件处理过程中被删除
+            if (PerfHud::active() != nullptr && !widget.isNull()) {
+                if (isPaint) {
+                    PerfHud::active()->recordPaint(widget, ns);
+                }
+                else {
+                    PerfHud::active()->recordFrame(widget, ns);
+                }
+            }
+            return ret;
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    return QApplication::notify(receiver, event);
+}
@@ -0,0 +1,19 @@
+#ifndef PERFAPPLICATION_H
+#define PERFAPPLICATION_H
+
+#include <QApplication>
+
+/* 为 PerfHud 计时的 QApplication
+ * HUD 未开启时只比 QApplication::notify() 多一次事件类型判断
+ */
+class PerfApplication : public QApplication
+{
+    Q_OBJECT
+
+public:
+    PerfApplication(int &argc, char **argv);
+
+    bool notify(QObject *receiver, QEvent *event) override;
+};
+
+#endif // PERFAPPLICATION_H
@@ -0,0 +1,316 @@
+#include "perfhud.h"
+
+#include "sliderwidget/sliderwidget.h"
+
+#include <QAbstractScrollArea>
+#include <QDateTime>
+#include <QFile>
+#include <QKeyEvent>
+#include <QPainter>
+#include <QTextStream>
+#include <QTouchEvent>
+
+#include <algorithm>
+
+PerfHud *PerfHud::s_instance = nullptr;
+
+PerfHud::PerfHud(QWidget *parent)
+    : QWidget(parent, Qt::Tool | Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint | Qt::WindowTransparentForInput)
+{
+    s_instance = this;
+
+    setAttribute(Qt::WA_TransparentForMouseEvents, true);
+    setAttribute(Qt::WA_TranslucentBackground, true);
+    setAttribute(Qt::WA_ShowWithoutActivating, true);
+    setFocusPolicy(Qt::NoFocus);
+    resize(420, 260);
+
+    m_history.resize(HistoryCapacity);
+
+    m_sampleTimer.setInterval(1000);
+    m_lagTimer.setInterval(LagIntervalMs);
+    m_lagTimer.setTimerType(Qt::PreciseTimer);
+
+    connect(&m_sampleTimer, &QTimer::timeout, this, &PerfHud::sample);
+    connect(&m_lagTimer, &QTimer::timeout, this, &PerfHud::checkLag);
+}
+
+PerfHud::~PerfHud()
+{
+    s_instance = nullptr;
+}
+
+PerfHud *PerfHud::instance()
+{
+    return s_instance;
+}
+
+PerfHud *PerfHud::active()
+{
+    return (s_instance != nullptr && s_instance->m_isRunning) ? s_instance : nullptr;
+}
+
+void PerfHud::setRunning(bool isRunning)
+{
+    if (isRunning == m_isRunning) {
+        return;
+    }
+
+    m_isRunning = isRunning;
+
+    if (isRunning) {
+        m_historyHead = 0;
+        m_historyCount = 0;
+        m_current = Record();
+        m_paints.clear();
+
+        m_pOther->getSysCpuUsage();     // 第一次调用只记录基准
+        m_clock.start();
+        m_lastLagNs = 0;
+        m_sampleTimer.start();
+        m_lagTimer.start();
+
+        if (parentWidget() != nullptr) {
+            move(parentWidget()->geometry().topRight() - QPoint(width(), 0));
+        }
+        show();
+        raise();
+    }
+    else {
+        m_sampleTimer.stop();
+        m_lagTimer.stop();
+        hide();
+        dump();
+    }
+}
+
+bool PerfHud::isRunning() const
+{
+    return m_isRunning;
+}
+
+QString PerfHud::dump(const QString &path)
+{
+    if (m_historyCount == 0) {
+        return QString();
+    }
+
+    QString fileName = path.isEmpty() ? QString("/tmp/dbos-perf-%1.csv").arg(QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss")) : path;
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        qWarning("PerfHud: open %s failed", qPrintable(fileName));
+        return QString();
+    }
+
+    QTextStream out(&file);
+
+    out << "time,fps,worst_frame_ms,max_lag_ms,cpu_percent\n";
+    for (int i=0; i<m_historyCount; i++) {
+        const auto &record = m_history.at((m_historyHead - m_historyCount + i + HistoryCapacity) % HistoryCapacity);
+        out << QDateTime::fromMSecsSinceEpoch(record.msecs).toString(Qt::ISODate) << ','
+            << record.frames << ','
+            << record.worstFrameNs / 1e6 << ','
+            << record.maxLagNs / 1e6 << ','
+            << record.cpuUsage << '\n';
+    }
+
+    out << "\nwidget,total_ms,count,max_ms\n";
+    for (const auto &paint : rankedPaints()) {
+        out << paint.first << ',' << paint.second.totalNs / 1e6 << ',' << paint.second.count << ',' << paint.second.maxNs / 1e6 << '\n';
+    }
+
+    return fileName;
+}
+
+bool PerfHud::handleInput(QObject *receiver, QEvent *event)
+{
+    Q_UNUSED(receiver)
+
+    switch (event->type()) {
+    case QEvent::KeyPress: {
+        auto keyEvent = static_cast<QKeyEvent *>(event);
+        if (keyEvent->isAutoRepeat()) {
+            return false;
+        }
+        if (keyEvent->key() == Qt::Key_F12) {
+            setRunning(!m_isRunning);
+            return true;
+        }
+        if (keyEvent->key() == Qt::Key_F11 && m_isRunning) {
+            dump();
+            return true;
+        }
+        return false;
+    }
+
+    case QEvent::TouchBegin:
+    case QEvent::TouchUpdate: {
+        // 同一次触摸只切换一次，触摸事件继续交给控件处理
+        auto touchEvent = static_cast<QTouchEvent *>(event);
+        if (touchEvent->touchPoints().count() >= 3 && !m_isGestureHandled) {
+            m_isGestureHandled = true;
+            setRunning(!m_isRunning);
+        }
+        return false;
+    }
+
+    case QEvent::TouchEnd:
+    case QEvent::TouchCancel:
+        m_isGestureHandled = false;
+        return false;
+
+    default:
+        return false;
+    }
+}
+
+void PerfHud::recordPaint(QWidget *widget, qint64 ns)
+{
+    if (widget->window() == this) {
+        return;
+    }
+
+    for (const auto &key : paintKeys(widget)) {
+        auto &stat = m_paints[key];
+        stat.totalNs += ns;
+        stat.maxNs = qMax(stat.maxNs, ns);
+        stat.count++;
+    }
+}
+
+void PerfHud::recordFrame(QWidget *window, qint64 ns)
+{
+    if (window == this) {
+        return;
+    }
+
+    m_current.frames++;
+    m_current.worstFrameNs = qMax(m_current.worstFrameNs, ns);
+}
+
+QStringList PerfHud::paintKeys(QWidget *widget) const
+{
+    QStringList ret;
+    QWidget *target = widget;
+
+    // QChartView 等滚动区域的内容绘制在 viewport 上
+    auto area = qobject_cast<QAbstractScrollArea *>(widget->parentWidget());
+    if (area != nullptr && area->viewport() == widget) {
+        target = area;
+    }
+
+    QString key = target->metaObject()->className();
+    if (!target->objectName().isEmpty()) {
+        key += "#" + target->objectName();
+    }
+    ret << key;
+
+    // 所在 SliderWidget 页面的合计，页面是 SliderWidget 内部容器的直接子控件
+    QWidgetList ancestors;
+    for (QWidget *parent = target; parent != nullptr; parent = parent->parentWidget()) {
+        auto slider = qobject_cast<SliderWidget *>(parent);
+        if (slider == nullptr) {
+            ancestors << parent;
+            continue;
+        }
+
+        for (auto page : ancestors) {
+            int index = slider->indexOf(page);
+            if (index >= 0) {
+                ret << QString("SliderWidget 第%1页（含子控件）").arg(index + 1);
+                break;
+            }
+        }
+        break;
+    }
+
+    return ret;
+}
+
+QList<QPair<QString, PerfHud::PaintStat>> PerfHud::rankedPaints() const
+{
+    QList<QPair<QString, PaintStat>> ret;
+
+    for (auto it = m_paints.constBegin(); it != m_paints.constEnd(); ++it) {
+        ret.append(qMakePair(it.key(), it.value()));
+    }
+
+    std::sort(ret.begin(), ret.end(), [](const QPair<QString, PaintStat> &a, const QPair<QString, PaintStat> &b) {
+        return a.second.totalNs > b.second.totalNs;
+    });
+
+    return ret;
+}
+
+void PerfHud::sample()
+{
+    m_current.msecs = QDateTime::currentMSecsSinceEpoch();
+    m_current.cpuUsage = m_pOther->getSysCpuUsage();
+
+    m_history[m_historyHead] = m_current;
+    m_historyHead = (m_historyHead + 1) % HistoryCapacity;
+    if (m_historyCount < HistoryCapacity) {
+        m_historyCount++;
+    }
+    m_current = Record();
+
+    // 之后打开的页面可能盖住 HUD
+    raise();
+    update();
+}
+
+void PerfHud::checkLag()
+{
+    qint64 now = m_clock.nsecsElapsed();
+
+    if (m_lastLagNs != 0) {
+        qint64 lag = now - m_lastLagNs - LagIntervalMs * 1000000LL;
+        m_current.maxLagNs = qMax(m_current.maxLagNs, lag);
+    }
+
+    m_lastLagNs = now;
+}
+
+void PerfHud::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event)
+
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(0, 0, 0, 170));
+    painter.setPen(Qt::white);
+    painter.setFont(QFont("Consolas", 9));
+
+    QFontMetrics fm(painter.font());
+    int lineHeight = fm.height();
+    int y = fm.ascent() + 4;
+
+    Record last;
+    if (m_historyCount > 0) {
+        last = m_history.at((m_historyHead - 1 + HistoryCapacity) % HistoryCapacity);
+    }
+
+    painter.drawText(6, y, QString("FPS %1  最长帧 %2 ms  延迟 %3 ms  CPU %4%")
+                     .arg(last.frames)
+                     .arg(last.worstFrameNs / 1e6, 0, 'f', 1)
+                     .arg(last.maxLagNs / 1e6, 0, 'f', 1)
+                     .arg(last.cpuUsage, 0, 'f', 0));
+    y += lineHeight + 4;
+
+    painter.setPen(QColor(200, 200, 200));
+    painter.drawText(6, y, QString("%1 %2 %3 %4").arg("paintEvent 累计", -26).arg("ms", 9).arg("次数", 6).arg("最长", 6));
+    y += lineHeight;
+
+    painter.setPen(Qt::white);
+    for (const auto &paint : rankedPaints()) {
+        if (y > height() - 4) {
+            break;
+        }
+
+        painter.drawText(6, y, QString("%1 %2 %3 %4")
+                         .arg(fm.elidedText(paint.first, Qt::ElideMiddle, fm.horizontalAdvance(QString(26, 'x'))), -26)
+                         .arg(paint.second.totalNs / 1e6, 9, 'f', 1)
+                         .arg(paint.second.count, 6)
+                         .arg(paint.second.maxNs / 1e6, 6, 'f', 1));
+        y += lineHeight;
+    }
+}
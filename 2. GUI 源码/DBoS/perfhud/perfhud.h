@@ -0,0 +1,86 @@
+#ifndef PERFHUD_H
+#define PERFHUD_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+#include <QWidget>
+
+#include "other/other.h"
+
+class QEvent;
+
+/* 性能 HUD
+ * 1. F12 或三指触摸切换显示，开启期间统计帧率、最长帧耗时、事件循环延迟、CPU 占用与各控件 paintEvent 累计耗时
+ * 2. 一帧为一次顶层窗口的 UpdateRequest，包含同步、绘制与刷新；HUD 自身的绘制不计入
+ * 3. 控件按类名（有 objectName 时附加）汇总，滚动区域的 viewport 计入滚动区域，SliderWidget 每页另有含子控件的合计
+ * 4. 事件循环延迟为 50 ms 精确定时器实际触发时刻与预期时刻之差
+ * 5. 每秒一条记录，环形缓冲区保存最近 10 分钟；F11 或关闭 HUD 时写入 /tmp/dbos-perf-<时间>.csv
+ * 6. 计时与按键依赖 PerfApplication::notify()，只在 GUI 线程使用
+ */
+class PerfHud : public QWidget
+{
+    Q_OBJECT
+
+    struct Record {
+        qint64 msecs = 0;           // 记录时刻，UTC 毫秒
+        int frames = 0;
+        qint64 worstFrameNs = 0;
+        qint64 maxLagNs = 0;
+        double cpuUsage = 0.0;
+    };
+
+    struct PaintStat {
+        qint64 totalNs = 0;
+        qint64 maxNs = 0;
+        int count = 0;
+    };
+
+public:
+    explicit PerfHud(QWidget *parent = nullptr);
+    ~PerfHud();
+
+    static PerfHud *instance();                 // 未创建时为空
+    static PerfHud *active();                   // 未开启时为空
+
+    void setRunning(bool isRunning);
+    bool isRunning() const;
+    QString dump(const QString &path = QString());  // 返回写入的文件路径，失败返回空
+
+    bool handleInput(QObject *receiver, QEvent *event);     // 切换与导出的按键、手势，返回 true 表示事件已处理
+    void recordPaint(QWidget *widget, qint64 ns);
+    void recordFrame(QWidget *window, qint64 ns);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    void sample();
+    void checkLag();
+    QStringList paintKeys(QWidget *widget) const;
+    QList<QPair<QString, PaintStat>> rankedPaints() const;
+
+private:
+    static PerfHud *s_instance;
+    static constexpr int HistoryCapacity = 600;
+    static constexpr int LagIntervalMs   = 50;
+
+    QVector<Record> m_history;                  // 环形缓冲区
+    int m_historyHead = 0;
+    int m_historyCount = 0;
+    Record m_current;
+    QHash<QString, PaintStat> m_paints;
+
+    QTimer m_sampleTimer;
+    QTimer m_lagTimer;
+    QElapsedTimer m_clock;
+    qint64 m_lastLagNs = 0;
+    bool m_isRunning = false;
+    bool m_isGestureHandled = false;
+
+    Other *m_pOther = new Other(this);
+};
+
+#endif // PERFHUD_H
@@ -1,13 +1,9 @@
 #include "photosensitivewidget.h"
 
 #include "commonhelper.h"
+#include "sensorengine/iiodevice.h"
 #include "simplemessagebox/simplemessagebox.h"
 
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <fcntl.h>
-#include <unistd.h>
-
 #include <QVBoxLayout>
 
 PhotosensitiveWidget::PhotosensitiveWidget(QWidget *parent) : QDialog(parent)
@@ -19,7 +15,7 @@ PhotosensitiveWidget::PhotosensitiveWidget(QWidget *parent) : QDialog(parent)
 
 PhotosensitiveWidget::~PhotosensitiveWidget()
 {
-    ::close(m_fd);
+    delete m_pChannel;
 }
 
 void PhotosensitiveWidget::initUi()
@@ -40,27 +36,39 @@ void PhotosensitiveWidget::initUi()
 
 void PhotosensitiveWidget::initCtrl()
 {
-    m_fd = ::open("/sys/bus/iio/devices/iio:device0/in_voltage3_raw", O_RDONLY);
-    if (m_fd != -1) {
-        ::close(m_fd);
-        connect(&m_timer, &QTimer::timeout, this, &PhotosensitiveWidget::timerTimeout);
-        m_timer.start(300);
+    SensorConfig config;
+    // 传感器驱动也注册为 IIO 设备，ADC 的编号不一定是 0
+    config.path = IioDevice::findAttribute("in_voltage3_raw");
+    config.readSize = 4;
+    config.intervalMs = 300;
+    config.rewind = true;
+    config.history = QStringList{"photosensitive"};
+    config.decoder = [](const char *data, int len, SensorSample &sample) {
+        bool ok = false;
+        int raw = QByteArray(data, len).trimmed().toInt(&ok);
+        if (!ok) {
+            return false;
+        }
+        sample.count = 1;
+        sample.values[0] = 100 - 100 * raw / 4096;
+        return true;
+    };
+
+    m_pChannel = SensorEngine::instance()->open(config, this);
+    if (m_pChannel != nullptr) {
+        connect(m_pChannel, &SensorChannel::readyRead, this, &PhotosensitiveWidget::readSample);
     }
     else {
         SimpleMessageBox::infomationMessageBox("未检测到设备，请重试");
     }
 }
 
-void PhotosensitiveWidget::timerTimeout()
+void PhotosensitiveWidget::readSample()
 {
-    m_fd = ::open("/sys/bus/iio/devices/iio:device0/in_voltage3_raw", O_RDONLY);
-    if (m_fd != -1) {
-        char data[5] = {0};
-        if (::read(m_fd, data, 4) > 0) {
-            int val = 100 - 100 * QString(data).toInt() / 4096;
-            m_arcProgressBar.setValue(val);
-        }
-        ::close(m_fd);
+    SensorSample sample;
+    if (!m_pChannel->latest(sample)) {
+        return;
     }
-}
 
+    m_arcProgressBar.setValue(int(sample.values[0]));
+}
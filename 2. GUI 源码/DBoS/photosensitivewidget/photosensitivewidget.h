@@ -2,9 +2,9 @@
 #define PHOTOSENSITIVEWIDGET_H
 
 #include "arcprogressbar/arcprogressbar.h"
+#include "sensorengine/sensorengine.h"
 
 #include <QDialog>
-#include <QTimer>
 
 class PhotosensitiveWidget : public QDialog
 {
@@ -14,7 +14,7 @@ public:
     ~PhotosensitiveWidget();
 
 protected slots:
-    void timerTimeout();
+    void readSample();
 
 private:
     void initUi();
@@ -22,9 +22,7 @@ private:
 
 private:
     ArcProgressBar m_arcProgressBar;
-    QTimer m_timer;
-
-    int m_fd = -1;
+    SensorChannel *m_pChannel = nullptr;
 };
 
 #endif // PHOTOSENSITIVEWIDGET_H
@@ -1,6 +1,7 @@
 #include "recorderwidget.h"
 
 #include "commonhelper.h"
+#include "frameclock/frameclock.h"
 #include "simplemessagebox/simplemessagebox.h"
 
 #include <QVBoxLayout>
@@ -34,6 +35,7 @@ void RecorderWidget::initUi()
     pMovie->jumpToNextFrame();
 
     m_movieLbl.setMovie(pMovie);
+    FrameClock::instance()->subscribe(&m_movieLbl, pMovie);
     m_movieLbl.setAlignment(Qt::AlignCenter);
     m_textLbl.setText("点击任意处，开始说话～");
     m_textLbl.setObjectName("recorder_textLbl");
@@ -111,28 +111,26 @@ void RemoteCtrlWidget::initCtrl()
     m_map.insert(Qt::Key_F8, &m_num7Btn);
     m_map.insert(Qt::Key_Insert, &m_num8Btn);
     m_map.insert(Qt::Key_Minus, &m_num9Btn);
-
-    m_timer.setSingleShot(true);
-    connect(&m_timer, &QTimer::timeout, this, &RemoteCtrlWidget::timerTimeOut);
 }
 
+// 驱动在收到按键时上报按下，按住期间由输入子系统自动重复，停止收到重复码后上报松开
 void RemoteCtrlWidget::setValue(int value)
 {
-    timerTimeOut();
-
     auto iterator = m_map.find(value);
     if (iterator == m_map.end())
         return;
 
+    if (m_pCurBtn != nullptr && m_pCurBtn != iterator.value()) {
+        m_pCurBtn->setDown(false);
+    }
+
     m_pCurBtn = iterator.value();
     m_pCurBtn->setDown(true);
-
-    m_timer.start(200);
 }
 
-void RemoteCtrlWidget::timerTimeOut()
+void RemoteCtrlWidget::releaseValue(int value)
 {
-    if (m_pCurBtn != nullptr) {
+    if (m_pCurBtn != nullptr && m_map.value(value) == m_pCurBtn) {
         m_pCurBtn->setDown(false);
         m_pCurBtn = nullptr;
     }
@@ -140,5 +138,15 @@ void RemoteCtrlWidget::timerTimeOut()
 
 void RemoteCtrlWidget::keyPressEvent(QKeyEvent *event)
 {
-    setValue(event->key());
+    if (!event->isAutoRepeat()) {
+        setValue(event->key());
+    }
+}
+
+void RemoteCtrlWidget::keyReleaseEvent(QKeyEvent *event)
+{
+    // 自动重复产生的松开事件之后紧跟按下事件，按键仍处于按住状态
+    if (!event->isAutoRepeat()) {
+        releaseValue(event->key());
+    }
 }
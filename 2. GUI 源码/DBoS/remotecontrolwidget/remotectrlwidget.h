@@ -3,7 +3,6 @@
 
 #include <QDialog>
 #include <QPushButton>
-#include <QTimer>
 #include <QMap>
 
 class RemoteCtrlWidget : public QDialog
@@ -15,6 +14,7 @@ public:
 
 protected:
     void keyPressEvent(QKeyEvent *event) override;
+    void keyReleaseEvent(QKeyEvent *event) override;
 
 private:
     void initUi();
@@ -22,7 +22,7 @@ private:
 
 private slots:
     void setValue(int value);
-    void timerTimeOut();
+    void releaseValue(int value);
 
 private:
     QPushButton m_powerBtn;
@@ -46,7 +46,6 @@ private:
     QPushButton m_num8Btn;
     QPushButton m_num9Btn;
 
-    QTimer m_timer;
     QMap<int, QPushButton*> m_map;
     QPushButton *m_pCurBtn = nullptr;
 };
@@ -0,0 +1,245 @@
+#include "iiodevice.h"
+
+#include <QDir>
+#include <QFile>
+#include <QRegExp>
+#include <QVector>
+
+#include <algorithm>
+#include <string.h>
+
+namespace {
+
+const char *IioRoot = "/sys/bus/iio/devices";
+
+// 扫描通道在一条记录中的位置与换算方式
+struct ScanChannel
+{
+    QString name;
+    int index = 0;
+    int offset = 0;             // 在记录中的字节偏移
+    int bytes = 4;              // 存储字节数
+    int bits = 32;              // 有效位数
+    int shift = 0;
+    bool isSigned = false;
+    bool isBigEndian = false;
+    bool isTimestamp = false;
+    double scale = 1.0;
+    double valueOffset = 0.0;
+};
+
+QByteArray readAttribute(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+
+    return file.readAll().trimmed();
+}
+
+bool writeAttribute(const QString &path, const QByteArray &value)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    return file.write(value) == value.size();
+}
+
+// 通道自身的属性不存在时使用同类通道共享的属性：in_distance0_scale -> in_distance_scale
+double channelInfo(const QString &dir, const QString &channel, const QString &info, double defaultValue)
+{
+    QString shared = channel;
+    shared.remove(QRegExp("\\d+$"));
+
+    for (const QString &name : {channel, shared}) {
+        bool ok = false;
+        double value = readAttribute(dir + "/" + name + "_" + info).toDouble(&ok);
+        if (ok) {
+            return value;
+        }
+    }
+
+    return defaultValue;
+}
+
+// 类型描述形如 le:s32/32>>0，重复通道形如 le:s12/16X2>>4，只取第一个
+bool parseType(const QByteArray &type, ScanChannel &channel)
+{
+    QRegExp regExp("(le|be):([su])(\\d+)/(\\d+)(?:X\\d+)?>>(\\d+)");
+    if (!regExp.exactMatch(QString::fromLatin1(type))) {
+        return false;
+    }
+
+    channel.isBigEndian = (regExp.cap(1) == "be");
+    channel.isSigned = (regExp.cap(2) == "s");
+    channel.bits = regExp.cap(3).toInt();
+    channel.bytes = regExp.cap(4).toInt() / 8;
+    channel.shift = regExp.cap(5).toInt();
+
+    return (channel.bytes == 1 || channel.bytes == 2 || channel.bytes == 4 || channel.bytes == 8) && channel.bits <= 64;
+}
+
+qint64 extract(const char *data, const ScanChannel &channel)
+{
+    quint64 value = 0;
+    auto bytes = reinterpret_cast<const unsigned char *>(data + channel.offset);
+
+    for (int i=0; i<channel.bytes; i++) {
+        int pos = channel.isBigEndian ? i : (channel.bytes - 1 - i);
+        value = (value << 8) | bytes[pos];
+    }
+
+    value >>= channel.shift;
+
+    if (channel.bits < 64) {
+        value &= (1ULL << channel.bits) - 1;
+        if (channel.isSigned && (value & (1ULL << (channel.bits - 1)))) {
+            value |= ~((1ULL << channel.bits) - 1);
+        }
+    }
+
+    return qint64(value);
+}
+
+}
+
+IioDevice::~IioDevice()
+{
+    close();
+}
+
+QString IioDevice::findDevice(const QString &name)
+{
+    QDir root(IioRoot);
+    const auto entries = root.entryList(QStringList() << "iio:device*", QDir::Dirs | QDir::System);
+
+    for (const auto &entry : entries) {
+        if (readAttribute(root.filePath(entry) + "/name") == name.toLatin1()) {
+            return root.filePath(entry);
+        }
+    }
+
+    return QString();
+}
+
+QString IioDevice::findAttribute(const QString &attribute)
+{
+    QDir root(IioRoot);
+    const auto entries = root.entryList(QStringList() << "iio:device*", QDir::Dirs | QDir::System);
+
+    for (const auto &entry : entries) {
+        QString path = root.filePath(entry) + "/" + attribute;
+        if (QFile::exists(path)) {
+            return path;
+        }
+    }
+
+    return QString();
+}
+
+bool IioDevice::open(const QString &name, SensorConfig &config, int length)
+{
+    close();
+
+    QString path = findDevice(name);
+    if (path.isEmpty()) {
+        return false;
+    }
+
+    // 上次异常退出时缓冲区可能仍处于打开状态，修改通道前必须先关闭
+    writeAttribute(path + "/buffer/enable", "0");
+
+    QDir scanDir(path + "/scan_elements");
+    QVector<ScanChannel> scan;
+
+    const auto enables = scanDir.entryList(QStringList() << "*_en", QDir::Files);
+    for (const auto &enable : enables) {
+        ScanChannel channel;
+        channel.name = enable.left(enable.size() - 3);
+        channel.isTimestamp = (channel.name == "in_timestamp");
+        channel.index = readAttribute(scanDir.filePath(channel.name + "_index")).toInt();
+
+        if (!parseType(readAttribute(scanDir.filePath(channel.name + "_type")), channel) ||
+            !writeAttribute(scanDir.filePath(enable), "1")) {
+            return false;
+        }
+
+        if (!channel.isTimestamp) {
+            channel.scale = channelInfo(path, channel.name, "scale", 1.0);
+            channel.valueOffset = channelInfo(path, channel.name, "offset", 0.0);
+        }
+
+        scan.append(channel);
+    }
+
+    std::sort(scan.begin(), scan.end(), [](const ScanChannel &a, const ScanChannel &b) {
+        return a.index < b.index;
+    });
+
+    // 每个通道按自身的存储字节数对齐，记录总长按最大的存储字节数对齐
+    int size = 0;
+    int align = 1;
+    int count = 0;
+    for (auto &channel : scan) {
+        size = (size + channel.bytes - 1) / channel.bytes * channel.bytes;
+        channel.offset = size;
+        size += channel.bytes;
+        align = qMax(align, channel.bytes);
+        count += channel.isTimestamp ? 0 : 1;
+    }
+    size = (size + align - 1) / align * align;
+
+    if (scan.isEmpty() || count > SensorSample::MaxChannels ||
+        !writeAttribute(path + "/buffer/length", QByteArray::number(length)) ||
+        !writeAttribute(path + "/buffer/enable", "1")) {
+        return false;
+    }
+
+    m_path = path;
+    m_channels.clear();
+    for (const auto &channel : scan) {
+        if (!channel.isTimestamp) {
+            m_channels.append(channel.name);
+        }
+    }
+
+    config.path = "/dev/" + QDir(path).dirName();
+    config.readSize = size;
+    config.intervalMs = 0;
+    config.nonBlock = true;
+    config.decoder = [scan, size](const char *data, int len, SensorSample &sample) {
+        if (len != size) {
+            return false;
+        }
+
+        sample.count = 0;
+        for (const auto &channel : scan) {
+            qint64 raw = extract(data, channel);
+            if (channel.isTimestamp) {
+                sample.timestamp = raw;
+            }
+            else {
+                sample.values[sample.count++] = (raw + channel.valueOffset) * channel.scale;
+            }
+        }
+        return true;
+    };
+
+    return true;
+}
+
+void IioDevice::close()
+{
+    if (!m_path.isEmpty()) {
+        writeAttribute(m_path + "/buffer/enable", "0");
+        m_path.clear();
+    }
+}
+
+QStringList IioDevice::channels() const
+{
+    return m_channels;
+}
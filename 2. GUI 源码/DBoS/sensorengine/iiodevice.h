@@ -0,0 +1,39 @@
+#ifndef IIODEVICE_H
+#define IIODEVICE_H
+
+#include "sensorengine.h"
+
+#include <QString>
+#include <QStringList>
+
+/* IIO 设备的缓冲读取
+ * 1. 按 name 属性在 /sys/bus/iio/devices 下查找设备，与设备编号无关
+ * 2. 打开全部扫描通道与时间戳，按 scan_elements 中的类型描述生成 SensorConfig，所有驱动共用同一个解码器
+ * 3. 样本的 values 按扫描顺序排列，已乘以 scale、加上 offset，单位为 IIO 规定的标准单位
+ * 4. 样本的 timestamp 取自记录中的时间戳通道，驱动使用 CLOCK_MONOTONIC
+ * 5. 析构时关闭缓冲区，驱动在没有其他使用者时停止采样
+ */
+class IioDevice
+{
+public:
+    IioDevice() = default;
+    ~IioDevice();
+
+    IioDevice(const IioDevice &) = delete;
+    IioDevice &operator=(const IioDevice &) = delete;
+
+    static QString findDevice(const QString &name);             // 返回 sysfs 目录，未找到返回空
+    static QString findAttribute(const QString &attribute);     // 返回第一个含有该属性的设备中的属性文件路径
+
+    // 打开缓冲区并设置 config 的 path、readSize、nonBlock 与 decoder，intervalMs 为 0；length 为内核缓冲区的记录数
+    bool open(const QString &name, SensorConfig &config, int length = 64);
+    void close();
+
+    QStringList channels() const;       // 扫描通道名（如 in_temp），与样本 values 的顺序一致
+
+private:
+    QString m_path;
+    QStringList m_channels;
+};
+
+#endif // IIODEVICE_H
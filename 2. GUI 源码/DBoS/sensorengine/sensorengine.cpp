@@ -0,0 +1,339 @@
+#include "sensorengine.h"
+
+#include "tsstore/timeseriesstore.h"
+
+#include <QDateTime>
+#include <QMutexLocker>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr quint64 WakeKey   = ~0ULL;    // epoll 事件标识：唤醒 eventfd
+constexpr quint64 TimerFlag = 1;        // epoll 事件标识最低位：1 为 timerfd，0 为设备文件
+constexpr int MaxEvents   = 8;
+constexpr int MaxReadSize = 64;
+constexpr int FrameIntervalMs = 16;     // 向 GUI 线程分发样本的最小间隔
+
+qint64 monotonicNsecs()
+{
+    struct timespec ts;
+    ::clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return qint64(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+}
+
+qint64 SensorSample::toMSecsSinceEpoch() const
+{
+    return QDateTime::currentMSecsSinceEpoch() - (monotonicNsecs() - timestamp) / 1000000;
+}
+
+struct SensorEngine::Sensor
+{
+    int id = -1;
+    int fd = -1;
+    int timerfd = -1;
+    SensorConfig config;
+    QSharedPointer<SensorBuffer> buffer;
+    QMutex ioMutex;         // 保护 fd：读取与关闭互斥
+};
+
+SensorEngine *SensorEngine::instance()
+{
+    static SensorEngine engine;
+
+    return &engine;
+}
+
+SensorEngine::SensorEngine() : QObject(NULL)
+{
+    // 先于引擎构造存储，静态对象逆序析构，保证采集线程退出前存储仍然有效
+    TimeSeriesStore::instance();
+
+    m_epfd = ::epoll_create1(EPOLL_CLOEXEC);
+    m_wakefd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    struct epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.u64 = WakeKey;
+    ::epoll_ctl(m_epfd, EPOLL_CTL_ADD, m_wakefd, &ev);
+
+    moveToThread(&m_thread);
+
+    connect(&m_thread, &QThread::started, this, &SensorEngine::tmain);
+
+    // 引擎对象属于采集线程，分发定时器不是它的子对象，仍属于 GUI 线程，回调以定时器为上下文在 GUI 线程执行
+    m_dispatchTimer.setSingleShot(true);
+    connect(&m_dispatchTimer, &QTimer::timeout, &m_dispatchTimer, [this]() {
+        dispatch();
+    });
+}
+
+SensorEngine::~SensorEngine()
+{
+    quint64 one = 1;
+
+    m_thread.requestInterruption();
+    ::write(m_wakefd, &one, sizeof(one));
+    m_thread.quit();
+    m_thread.wait();
+
+    for (auto id : m_sensors.keys()) {
+        close(id);
+    }
+
+    ::close(m_wakefd);
+    ::close(m_epfd);
+}
+
+SensorChannel *SensorEngine::open(const SensorConfig &config, QObject *parent)
+{
+    int fd = ::open(config.path.toLatin1().data(), O_RDONLY | O_CLOEXEC | (config.nonBlock ? O_NONBLOCK : 0));
+
+    if (fd == -1) {
+        return nullptr;
+    }
+
+    auto sensor = QSharedPointer<Sensor>::create();
+    sensor->fd = fd;
+    sensor->config = config;
+    sensor->buffer = QSharedPointer<SensorBuffer>::create(config.bufferDepth);
+
+    m_mutex.lock();
+    sensor->id = m_nextId++;
+    m_sensors.insert(sensor->id, sensor);
+    m_mutex.unlock();
+
+    // 先登记通道再登记到 epoll，保证第一个样本不会丢失
+    auto channel = new SensorChannel(sensor->id, sensor->buffer, parent);
+    m_channels.append(channel);
+
+    struct epoll_event ev = {};
+    int ret = -1;
+
+    if (config.intervalMs > 0) {
+        sensor->timerfd = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+        struct itimerspec spec = {};
+        spec.it_interval.tv_sec  = config.intervalMs / 1000;
+        spec.it_interval.tv_nsec = (config.intervalMs % 1000) * 1000000L;
+        spec.it_value.tv_nsec    = 1;   // 打开后立即采样一次
+
+        ev.events = EPOLLIN;
+        ev.data.u64 = (quint64(sensor->id) << 1) | TimerFlag;
+
+        if ((sensor->timerfd != -1) && (::timerfd_settime(sensor->timerfd, 0, &spec, NULL) == 0)) {
+            ret = ::epoll_ctl(m_epfd, EPOLL_CTL_ADD, sensor->timerfd, &ev);
+        }
+    }
+    else {
+        // sysfs 属性通过 sysfs_notify 产生 EPOLLPRI，普通设备文件由驱动的 poll 产生 EPOLLIN
+        ev.events = config.rewind ? (EPOLLPRI | EPOLLERR) : EPOLLIN;
+        ev.data.u64 = quint64(sensor->id) << 1;
+
+        ret = ::epoll_ctl(m_epfd, EPOLL_CTL_ADD, fd, &ev);
+    }
+
+    if (ret == -1) {
+        delete channel;     // 析构时调用 close() 释放 fd
+        return nullptr;
+    }
+
+    startThread();
+
+    return channel;
+}
+
+void SensorEngine::close(int id)
+{
+    m_mutex.lock();
+    auto sensor = m_sensors.take(id);
+    m_mutex.unlock();
+
+    if (sensor.isNull()) {
+        return;
+    }
+
+    for (int i=m_channels.count()-1; i>=0; --i) {
+        if (m_channels.at(i).isNull() || m_channels.at(i)->m_id == id) {
+            m_channels.removeAt(i);
+        }
+    }
+
+    // 等待正在进行的读取结束，返回后设备可以安全卸载
+    QMutexLocker locker(&sensor->ioMutex);
+
+    if (sensor->timerfd != -1) {
+        ::epoll_ctl(m_epfd, EPOLL_CTL_DEL, sensor->timerfd, NULL);
+        ::close(sensor->timerfd);
+        sensor->timerfd = -1;
+    }
+    else {
+        ::epoll_ctl(m_epfd, EPOLL_CTL_DEL, sensor->fd, NULL);
+    }
+
+    ::close(sensor->fd);
+    sensor->fd = -1;
+}
+
+void SensorEngine::startThread()
+{
+    if (!m_thread.isRunning()) {
+        m_thread.start();
+    }
+}
+
+void SensorEngine::sample(Sensor &sensor)
+{
+    char buf[MaxReadSize + 1] = {0};
+    int size = qMin(sensor.config.readSize, MaxReadSize);
+
+    ssize_t len = sensor.config.rewind ? ::pread(sensor.fd, buf, size, 0) : ::read(sensor.fd, buf, size);
+    if (len <= 0) {
+        return;
+    }
+
+    SensorSample sample;
+    sample.timestamp = monotonicNsecs();
+
+    if (!sensor.config.decoder || !sensor.config.decoder(buf, int(len), sample)) {
+        return;
+    }
+
+    // 历史数据在采集线程写入映射内存，与界面是否打开无关
+    if (!sensor.config.history.isEmpty()) {
+        qint64 msecs = sample.toMSecsSinceEpoch();
+        for (int i=0; i<qMin(sample.count, sensor.config.history.count()); ++i) {
+            if (!sensor.config.history.at(i).isEmpty()) {
+                TimeSeriesStore::instance()->append(sensor.config.history.at(i), msecs, sample.values[i]);
+            }
+        }
+    }
+
+    auto &buffer = *sensor.buffer;
+
+    buffer.latest.store(sample);
+
+    if ((sensor.config.bufferDepth > 0) && !buffer.ring.push(sample)) {
+        buffer.overruns.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // 所有传感器共用一个唤醒，分发之前到达的样本不再投递事件
+    buffer.pending.store(true);
+    if (!m_isDispatchPending.exchange(true)) {
+        QMetaObject::invokeMethod(&m_dispatchTimer, [this]() {
+            dispatch();
+        }, Qt::QueuedConnection);
+    }
+}
+
+void SensorEngine::dispatch()
+{
+    qint64 wait = m_dispatchClock.isValid() ? FrameIntervalMs - m_dispatchClock.elapsed() : 0;
+
+    if (wait > 0) {
+        if (!m_dispatchTimer.isActive()) {
+            m_dispatchTimer.start(int(wait));
+        }
+        return;
+    }
+
+    m_dispatchClock.start();
+
+    // 先清除标志再通知，通知期间到达的样本会再次唤醒
+    m_isDispatchPending.store(false);
+
+    // 订阅者可能在 readyRead 中关闭其他通道，遍历副本
+    for (const auto &channel : QList<QPointer<SensorChannel>>(m_channels)) {
+        if (!channel.isNull() && channel->m_buffer->pending.exchange(false)) {
+            emit channel->readyRead();
+        }
+    }
+}
+
+void SensorEngine::tmain()
+{
+    struct epoll_event events[MaxEvents];
+
+    while (!m_thread.isInterruptionRequested()) {
+
+        int n = ::epoll_wait(m_epfd, events, MaxEvents, -1);
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        for (int i=0; i<n; ++i) {
+            quint64 key = events[i].data.u64;
+
+            if (key == WakeKey) {
+                quint64 value;
+                ::read(m_wakefd, &value, sizeof(value));
+                continue;
+            }
+
+            m_mutex.lock();
+            auto sensor = m_sensors.value(int(key >> 1));
+            m_mutex.unlock();
+
+            if (sensor.isNull()) {
+                continue;
+            }
+
+            QMutexLocker locker(&sensor->ioMutex);
+
+            if (sensor->fd == -1) {
+                continue;
+            }
+
+            if (key & TimerFlag) {
+                quint64 expirations;
+                ::read(sensor->timerfd, &expirations, sizeof(expirations));
+            }
+
+            sample(*sensor);
+        }
+    }
+}
+
+SensorChannel::SensorChannel(int id, const QSharedPointer<SensorBuffer> &buffer, QObject *parent)
+    : QObject(parent), m_id(id), m_buffer(buffer)
+{
+}
+
+SensorChannel::~SensorChannel()
+{
+    SensorEngine::instance()->close(m_id);
+}
+
+int SensorChannel::id() const
+{
+    return m_id;
+}
+
+bool SensorChannel::read(SensorSample &sample)
+{
+    return m_buffer->ring.pop(sample);
+}
+
+bool SensorChannel::latest(SensorSample &sample) const
+{
+    return m_buffer->latest.load(sample);
+}
+
+quint32 SensorChannel::overruns() const
+{
+    return m_buffer->overruns.load(std::memory_order_relaxed);
+}
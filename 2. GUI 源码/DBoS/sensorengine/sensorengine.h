@@ -0,0 +1,137 @@
+#ifndef SENSORENGINE_H
+#define SENSORENGINE_H
+
+#include "seqlockcell.h"
+#include "spscring.h"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QPointer>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QThread>
+#include <QTimer>
+
+#include <atomic>
+#include <functional>
+
+/* 传感器样本
+ * timestamp 为 CLOCK_MONOTONIC 纳秒，values 中前 count 个通道有效
+ */
+struct SensorSample
+{
+    static constexpr int MaxChannels = 4;
+
+    qint64 timestamp = 0;
+    int count = 0;
+    double values[MaxChannels] = {0};
+
+    qint64 toMSecsSinceEpoch() const;   // 将采样时刻换算为墙上时间，用于图表横轴
+};
+
+/* 解码器：将一次读取得到的原始数据转换为样本，返回 false 表示数据无效、丢弃 */
+using SensorDecoder = std::function<bool(const char *data, int len, SensorSample &sample)>;
+
+struct SensorConfig
+{
+    QString path;                   // /dev 设备节点或 sysfs 属性文件
+    int readSize = 4;               // 每次读取的字节数
+    int intervalMs = 0;             // 采样周期；0 表示设备可读时采样（驱动需支持 poll）
+    bool rewind = false;            // sysfs 属性：每次从偏移 0 处重新读取
+    bool nonBlock = false;          // 以 O_NONBLOCK 方式打开
+    int bufferDepth = 0;            // 样本队列深度；0 表示只保留最新值
+    QStringList history;            // 各通道写入 TimeSeriesStore 的序列名，为空的通道不保存
+    SensorDecoder decoder;
+};
+
+/* 引擎线程与 GUI 线程共享的样本缓冲 */
+struct SensorBuffer
+{
+    explicit SensorBuffer(int depth) : ring(depth) {}
+
+    SpscRing<SensorSample> ring;        // 按时间顺序排列的样本，bufferDepth 为 0 时不使用
+    SeqLockCell<SensorSample> latest;   // 最新样本
+    std::atomic<bool> pending{false};   // 有新样本，等待下一帧通知订阅者
+    std::atomic<quint32> overruns{0};   // 队列已满而丢弃的样本数
+};
+
+class SensorChannel;
+
+/* 传感器采集引擎
+ * 1. 单线程通过 epoll 复用所有设备节点与 sysfs 属性
+ * 2. 周期采样的传感器各自使用一个 timerfd 调度
+ * 3. 解码器由使用者提供，样本通过 SensorChannel 发布给任意订阅者
+ * 4. 样本写入无锁队列与最新值单元，GUI 线程每帧最多唤醒一次，统一通知本帧内有新样本的通道
+ * 5. 实例须首先在 GUI 线程中取得，分发定时器属于该线程
+ */
+class SensorEngine : public QObject
+{
+    Q_OBJECT
+
+    struct Sensor;
+
+public:
+    static SensorEngine *instance();
+
+    SensorChannel *open(const SensorConfig &config, QObject *parent = nullptr);   // 打开传感器，失败返回 nullptr
+    void close(int id);                                                          // 关闭传感器，返回后设备文件已关闭
+
+private:
+    SensorEngine();
+    ~SensorEngine();
+
+    void startThread();
+    void sample(Sensor &sensor);
+    void dispatch();                    // GUI 线程：通知有新样本的通道
+
+private slots:
+    void tmain();
+
+private:
+    QThread m_thread;
+    QMutex m_mutex;
+    QHash<int, QSharedPointer<Sensor>> m_sensors;
+
+    int m_epfd = -1;
+    int m_wakefd = -1;
+    int m_nextId = 0;
+
+    // 以下除 m_isDispatchPending 外只在 GUI 线程访问
+    std::atomic<bool> m_isDispatchPending{false};   // 已向 GUI 线程投递唤醒，尚未分发
+    QList<QPointer<SensorChannel>> m_channels;
+    QTimer m_dispatchTimer;                         // 距上次分发不足一帧时推迟到下一帧
+    QElapsedTimer m_dispatchClock;
+};
+
+/* 传感器通道：SensorEngine::open 的返回值，析构时自动关闭传感器
+ * 每帧最多发出一次 readyRead()，之后通过 read() 取出全部排队样本或通过 latest() 读取最新样本
+ */
+class SensorChannel : public QObject
+{
+    Q_OBJECT
+
+    friend class SensorEngine;
+
+public:
+    ~SensorChannel();
+
+    int id() const;
+    bool read(SensorSample &sample);            // 取出最早的排队样本，只能在所属线程调用
+    bool latest(SensorSample &sample) const;    // 读取最新样本，任意线程可调用
+    quint32 overruns() const;                   // 因队列已满丢弃的样本数
+
+signals:
+    void readyRead();
+
+private:
+    SensorChannel(int id, const QSharedPointer<SensorBuffer> &buffer, QObject *parent);
+
+private:
+    int m_id;
+    QSharedPointer<SensorBuffer> m_buffer;
+};
+
+#endif // SENSORENGINE_H
@@ -0,0 +1,88 @@
+#ifndef SEQLOCKCELL_H
+#define SEQLOCKCELL_H
+
+#include <QtGlobal>
+
+#include <atomic>
+#include <string.h>
+#include <type_traits>
+
+/* 顺序锁最新值单元
+ * 1. 单写者多读者，写者从不阻塞，读者在写入过程中重试
+ * 2. 数据按 64 位字以 relaxed 原子操作存取，读写并发时不存在数据竞争
+ * 3. T 必须可平凡复制
+ */
+template <typename T>
+class SeqLockCell
+{
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLockCell requires a trivially copyable type");
+
+    static constexpr int WordCount = int((sizeof(T) + sizeof(quint64) - 1) / sizeof(quint64));
+
+public:
+    SeqLockCell()
+    {
+        for (auto &word : m_words) {
+            word.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    SeqLockCell(const SeqLockCell&) = delete;
+    SeqLockCell &operator=(const SeqLockCell&) = delete;
+
+    void store(const T &value)
+    {
+        quint64 words[WordCount] = {0};
+        memcpy(words, &value, sizeof(T));
+
+        quint32 seq = m_seq.load(std::memory_order_relaxed);
+        m_seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (int i=0; i<WordCount; ++i) {
+            m_words[i].store(words[i], std::memory_order_relaxed);
+        }
+
+        m_seq.store(seq + 2, std::memory_order_release);
+    }
+
+    // 尚未写入过任何值时返回 false
+    bool load(T &value) const
+    {
+        quint64 words[WordCount];
+        quint32 seq0, seq1;
+
+        do {
+            seq0 = m_seq.load(std::memory_order_acquire);
+            if (seq0 & 1) {
+                continue;
+            }
+
+            for (int i=0; i<WordCount; ++i) {
+                words[i] = m_words[i].load(std::memory_order_relaxed);
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            seq1 = m_seq.load(std::memory_order_relaxed);
+        } while ((seq0 & 1) || (seq0 != seq1));
+
+        if (seq0 == 0) {
+            return false;
+        }
+
+        memcpy(&value, words, sizeof(T));
+
+        return true;
+    }
+
+    quint32 sequence() const
+    {
+        return m_seq.load(std::memory_order_acquire) >> 1;
+    }
+
+private:
+    std::atomic<quint32> m_seq{0};
+    std::atomic<quint64> m_words[WordCount];
+};
+
+#endif // SEQLOCKCELL_H
@@ -0,0 +1,78 @@
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <QtGlobal>
+
+#include <atomic>
+#include <vector>
+
+/* 单生产者单消费者无锁环形队列
+ * 1. 容量在构造时确定并向上取整为 2 的幂，运行期间不再分配内存
+ * 2. push() 只能由生产者线程调用，pop() 只能由消费者线程调用
+ * 3. 队列满时 push() 返回 false，由生产者决定如何统计丢弃
+ */
+template <typename T>
+class SpscRing
+{
+public:
+    explicit SpscRing(int capacity)
+    {
+        quint32 size = 1;
+        while (size < quint32(qMax(capacity, 1))) {
+            size <<= 1;
+        }
+
+        m_buffer.resize(size);
+        m_mask = size - 1;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing &operator=(const SpscRing&) = delete;
+
+    bool push(const T &value)
+    {
+        quint32 head = m_head.load(std::memory_order_relaxed);
+
+        if (head - m_tail.load(std::memory_order_acquire) > m_mask) {
+            return false;
+        }
+
+        m_buffer[head & m_mask] = value;
+        m_head.store(head + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    bool pop(T &value)
+    {
+        quint32 tail = m_tail.load(std::memory_order_relaxed);
+
+        if (tail == m_head.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        value = m_buffer[tail & m_mask];
+        m_tail.store(tail + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    int size() const
+    {
+        return int(m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire));
+    }
+
+    int capacity() const
+    {
+        return int(m_mask + 1);
+    }
+
+private:
+    std::vector<T> m_buffer;
+    quint32 m_mask = 0;
+
+    std::atomic<quint32> m_head{0};     // 生产者写入位置
+    std::atomic<quint32> m_tail{0};     // 消费者读取位置
+};
+
+#endif // SPSCRING_H
@@ -1,5 +1,7 @@
 #include "sliderwidget.h"
 
+#include "frameclock/frameclock.h"
+
 #include <QScroller>
 #include <QScrollerProperties>
 #include <QScrollBar>
@@ -63,6 +65,9 @@ void SliderWidget::initCtrl()
 
     connect(QScroller::scroller(m_pScrollArea), &QScroller::stateChanged, this, &SliderWidget::onScrollerStateChanged);
     connect(m_pSlidingTimer, &QTimer::timeout, this, &SliderWidget::onSliderTimerTimeout);
+
+    // 拖动或翻页动画改变了各页面的可见区域，动画控件据此暂停或恢复
+    connect(m_pScrollArea->horizontalScrollBar(), &QScrollBar::valueChanged, FrameClock::instance(), &FrameClock::refresh);
 }
 
 void SliderWidget::updateIndicator(int index)
@@ -0,0 +1,189 @@
+#include "stylesheetcache.h"
+
+#include <QApplication>
+#include <QDirIterator>
+#include <QFile>
+#include <QRegularExpression>
+#include <QStyle>
+
+namespace {
+
+const char *ScopeProperty = "styleScope";
+
+QString readFile(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+
+    return QString::fromUtf8(file.readAll());
+}
+
+// 选择器是否只有一个复合选择器（不含后代或子选择符）
+bool isSingleCompound(const QString &selector)
+{
+    int depth = 0;
+    bool isQuoted = false;
+
+    for (auto ch : selector) {
+        if (ch == '"') {
+            isQuoted = !isQuoted;
+        }
+        else if (!isQuoted && ch == '[') {
+            ++depth;
+        }
+        else if (!isQuoted && ch == ']') {
+            --depth;
+        }
+        else if (!isQuoted && depth == 0 && (ch == ' ' || ch == '>')) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// 伪状态与子控件（第一个方括号外的冒号）的位置，属性选择器须插在其前
+int pseudoIndex(const QString &compound)
+{
+    int depth = 0;
+    bool isQuoted = false;
+
+    for (int i=0; i<compound.size(); ++i) {
+        auto ch = compound.at(i);
+        if (ch == '"') {
+            isQuoted = !isQuoted;
+        }
+        else if (!isQuoted && ch == '[') {
+            ++depth;
+        }
+        else if (!isQuoted && ch == ']') {
+            --depth;
+        }
+        else if (!isQuoted && depth == 0 && ch == ':') {
+            return i;
+        }
+    }
+
+    return compound.size();
+}
+
+}
+
+StyleSheetCache *StyleSheetCache::instance()
+{
+    static StyleSheetCache cache;
+
+    return &cache;
+}
+
+void StyleSheetCache::load(const QString &global, const QString &root)
+{
+    QString styleSheet = readFile(global);
+    QStringList paths;
+
+    QDirIterator it(root, QStringList{"default.qss"}, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        QString path = it.next();
+        if (path != global) {
+            paths.append(path);
+        }
+    }
+    paths.sort();
+
+    for (const auto &path : paths) {
+        QString text = readFile(path);
+        if (!text.isEmpty()) {
+            styleSheet += "\n" + scoped(text, scopeOf(path));
+            m_paths.insert(path);
+        }
+    }
+
+    qApp->setStyleSheet(styleSheet);
+}
+
+bool StyleSheetCache::apply(const QString &path, QWidget *widget) const
+{
+    if (!m_paths.contains(path)) {
+        return false;
+    }
+
+    widget->setProperty(ScopeProperty, scopeOf(path));
+
+    // 已显示过的控件需要重新匹配规则；构造期间尚未 polish，无需处理
+    if (widget->testAttribute(Qt::WA_WState_Polished)) {
+        widget->style()->unpolish(widget);
+        widget->style()->polish(widget);
+    }
+
+    return true;
+}
+
+void StyleSheetCache::setState(QWidget *widget, const char *name, const QVariant &value)
+{
+    if (widget->property(name) == value) {
+        return;
+    }
+
+    widget->setProperty(name, value);
+
+    // 属性选择器只在 polish 时求值；尚未 polish 的控件显示前自然会匹配
+    if (!widget->testAttribute(Qt::WA_WState_Polished)) {
+        return;
+    }
+
+    widget->style()->unpolish(widget);
+    widget->style()->polish(widget);
+    widget->update();
+}
+
+QString StyleSheetCache::scopeOf(const QString &path)
+{
+    // :/misc/<widget>/style/default.qss
+    return path.section('/', -3, -3);
+}
+
+QString StyleSheetCache::scoped(const QString &styleSheet, const QString &scope)
+{
+    static const QRegularExpression comment("/\\*.*?\\*/", QRegularExpression::DotMatchesEverythingOption);
+
+    QString text = styleSheet;
+    text.remove(comment);
+
+    QString attribute = QString("[%1=\"%2\"]").arg(ScopeProperty, scope);
+    QString ret;
+    int pos = 0;
+
+    // 样式表不含嵌套的花括号：逐条规则改写选择器，声明原样保留
+    forever {
+        int open = text.indexOf('{', pos);
+        int close = (open == -1) ? -1 : text.indexOf('}', open);
+        if (close == -1) {
+            break;
+        }
+
+        QStringList selectors;
+        for (const auto &part : text.mid(pos, open - pos).split(',', QString::SkipEmptyParts)) {
+            QString selector = part.simplified();
+            if (selector.isEmpty()) {
+                continue;
+            }
+
+            // 原先 setStyleSheet 的规则作用于控件自身及其所有子控件
+            selectors.append("*" + attribute + " " + selector);
+            if (isSingleCompound(selector)) {
+                int index = pseudoIndex(selector);
+                selectors.append(selector.left(index) + attribute + selector.mid(index));
+            }
+        }
+
+        if (!selectors.isEmpty()) {
+            ret += selectors.join(",\n") + " " + text.mid(open, close - open + 1) + "\n";
+        }
+
+        pos = close + 1;
+    }
+
+    return ret;
+}
@@ -0,0 +1,35 @@
+#ifndef STYLESHEETCACHE_H
+#define STYLESHEETCACHE_H
+
+#include <QSet>
+#include <QString>
+#include <QVariant>
+#include <QWidget>
+
+/* 样式表缓存
+ * 1. 启动时读取资源中所有页面的 default.qss，把每条选择器限定在页面的作用域属性内，与全局样式合并为一份应用样式表，只解析一次
+ * 2. 页面构造时 apply() 只设置作用域属性，不再调用 QWidget::setStyleSheet，打开页面时无需读取文件与解析
+ * 3. 播放/暂停、静音等运行时状态用动态属性表示，setState() 只重新匹配已解析的规则
+ */
+class StyleSheetCache
+{
+public:
+    static StyleSheetCache *instance();
+
+    // global 为全局样式；root 下其余的 default.qss 按所在目录名限定作用域
+    void load(const QString &global, const QString &root);
+    bool apply(const QString &path, QWidget *widget) const;
+
+    static void setState(QWidget *widget, const char *name, const QVariant &value);
+
+private:
+    StyleSheetCache() = default;
+
+    static QString scopeOf(const QString &path);
+    static QString scoped(const QString &styleSheet, const QString &scope);
+
+private:
+    QSet<QString> m_paths;
+};
+
+#endif // STYLESHEETCACHE_H
@@ -1,13 +1,22 @@
 #include "temperaturewidget.h"
 
+#include "modulemanager/modulemanager.h"
 #include "simplemessagebox/simplemessagebox.h"
+#include "tsstore/timeseriesstore.h"
 #include "commonhelper.h"
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
-#include <QProcess>
+#include <QDateTime>
 
-TemperatureWidget::TemperatureWidget(QWidget *parent) : QDialog(parent), m_thread("/dev/mydht11")
+namespace {
+
+// 回填的点数上限：最近 1024 个原始样本与曲线原始层的容量相当，更早的一周数据降采样为 512 个最小/最大值桶
+constexpr int HistoryMaxPoints = 2048;
+
+}
+
+TemperatureWidget::TemperatureWidget(QWidget *parent) : QDialog(parent)
 {
     initUi();
     initCtrl();
@@ -16,10 +25,10 @@ TemperatureWidget::TemperatureWidget(QWidget *parent) : QDialog(parent), m_threa
 
 TemperatureWidget::~TemperatureWidget()
 {
-    m_thread.quit();
-    m_thread.wait();
+    delete m_pChannel;
+    m_device.close();
 
-    QProcess::execute("rmmod /driver/dht11_drv.ko");
+    ModuleManager::instance()->release("/driver/dht11_drv.ko");
 }
 
 void TemperatureWidget::initUi()
@@ -40,6 +49,8 @@ void TemperatureWidget::initUi()
     m_tempLine.setAxisYRange(-20, 60);
     m_tempLine.setpAxisYTickCount(9);
     m_tempLine.setAxisYLabelFormat(QString::fromLatin1("%.0f℃"));
+    m_tempLine.setUpdateMode(DynamicLine::SampleDriven);
+    m_tempLine.setBackend(DynamicLine::RasterBackend);
 
     QPen pen;
     pen.setWidth(2);
@@ -52,6 +63,8 @@ void TemperatureWidget::initUi()
     m_humiLine.setAxisYRange(0, 95);
     m_humiLine.setpAxisYTickCount(9);
     m_humiLine.setAxisYLabelFormat(QString::fromLatin1("%.0f%RH"));
+    m_humiLine.setUpdateMode(DynamicLine::SampleDriven);
+    m_humiLine.setBackend(DynamicLine::RasterBackend);
     pen.setColor(QColor(214, 23, 13));
     m_humiLine.addSplineSeries("湿度", pen, true);
 
@@ -73,27 +86,85 @@ void TemperatureWidget::initUi()
 
 void TemperatureWidget::initCtrl()
 {
-    QProcess::execute("insmod /driver/dht11_drv.ko");
-
     setValue(0, 0);
 
-    connect(&m_thread, &TemperatureThread::readReady, this, &TemperatureWidget::setValue);
+    // 驱动在后台加载，加载完成（或已加载）后再打开设备
+    ModuleManager::instance()->acquire("/driver/dht11_drv.ko", this, [this](bool) {
+        openDevice();
+    });
+}
 
-    if (m_thread.start()) {
+void TemperatureWidget::openDevice()
+{
+    // 驱动在后台定时采样，每个新结果推入 IIO 缓冲区
+    SensorConfig config;
+    if (m_device.open("dht11", config)) {
+        config.bufferDepth = 16;
+        config.history = QStringList{"dht11_temperature", "dht11_humidity"};
+
+        // 扫描顺序为湿度、温度，单位千分之一 %RH 与千分之一摄氏度
+        auto decode = config.decoder;
+        config.decoder = [decode](const char *data, int len, SensorSample &sample) {
+            if (!decode(data, len, sample) || sample.count != 2) {
+                return false;
+            }
+            double humi = sample.values[0] / 1000;
+            sample.values[0] = sample.values[1] / 1000;
+            sample.values[1] = humi;
+            return true;
+        };
+
+        m_pChannel = SensorEngine::instance()->open(config, this);
+    }
+    if (m_pChannel != nullptr) {
+        connect(m_pChannel, &SensorChannel::readyRead, this, &TemperatureWidget::readSample);
         m_tempLine.start();
         m_humiLine.start();
+        loadHistory();
     }
     else {
         SimpleMessageBox::infomationMessageBox("未检测到设备，请重试");
     }
 }
 
+void TemperatureWidget::loadHistory()
+{
+    // 在后台读取并降采样最近一周的历史数据，读取完成后回填到曲线，滚轮缩小即可查看
+    qint64 end   = QDateTime::currentMSecsSinceEpoch();
+    qint64 begin = end - 7 * 24 * 3600 * 1000LL;
+
+    connect(&m_tempWatcher, &QFutureWatcher<QVector<QPointF>>::finished, this, [this]() {
+        m_tempLine.backfill(0, m_tempWatcher.result());
+    });
+    connect(&m_humiWatcher, &QFutureWatcher<QVector<QPointF>>::finished, this, [this]() {
+        m_humiLine.backfill(0, m_humiWatcher.result());
+    });
+
+    m_tempWatcher.setFuture(TimeSeriesStore::instance()->query("dht11_temperature", begin, end, HistoryMaxPoints));
+    m_humiWatcher.setFuture(TimeSeriesStore::instance()->query("dht11_humidity", begin, end, HistoryMaxPoints));
+}
+
 void TemperatureWidget::setValue(double temp, double humi)
 {
     m_tempLbl.setText(QString("当前温度：%1 ℃").arg(temp));
     m_humiLbl.setText(QString("当湿度度：%1 %RH").arg(humi));
+}
 
-    m_tempLine.setSeriesValues(0, temp);
-    m_humiLine.setSeriesValues(0, humi);
+void TemperatureWidget::readSample()
+{
+    SensorSample sample;
+    bool isRead = false;
+
+    // 一次取出全部排队样本，曲线按采样时刻逐点追加，标签按最后一个样本刷新
+    while (m_pChannel->read(sample)) {
+        qint64 msecs = sample.toMSecsSinceEpoch();
+        m_tempLine.appendSample(0, msecs, sample.values[0]);
+        m_humiLine.appendSample(0, msecs, sample.values[1]);
+        isRead = true;
+    }
+
+    if (isRead) {
+        setValue(sample.values[0], sample.values[1]);
+    }
 }
 
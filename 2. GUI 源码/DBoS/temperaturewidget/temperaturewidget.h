@@ -2,9 +2,11 @@
 #define TEMPERATUREWIDGET_H
 
 #include "dynamicline/dynamicline.h"
-#include "temperaturethread.h"
+#include "sensorengine/iiodevice.h"
+#include "sensorengine/sensorengine.h"
 
 #include <QDialog>
+#include <QFutureWatcher>
 #include <QLabel>
 
 class TemperatureWidget : public QDialog
@@ -19,9 +21,12 @@ signals:
 private:
     void initUi();
     void initCtrl();
+    void openDevice();
+    void loadHistory();
 
 private slots:
     void setValue(double temp, double humi);
+    void readSample();
 
 private:
     DynamicLine m_tempLine;
@@ -30,7 +35,11 @@ private:
     QLabel m_tempLbl;
     QLabel m_humiLbl;
 
-    TemperatureThread m_thread;
+    IioDevice m_device;
+    SensorChannel *m_pChannel = nullptr;
+
+    QFutureWatcher<QVector<QPointF>> m_tempWatcher;
+    QFutureWatcher<QVector<QPointF>> m_humiWatcher;
 };
 
 #endif // TEMPERATUREWIDGET_H
@@ -0,0 +1,360 @@
+#include "blockarchive.h"
+
+#include "checksum.h"
+
+#include <QFile>
+#include <QMutexLocker>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <math.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr quint32 BlockMagic = 0x4b4c4244;  // "DBLK"
+constexpr int MaxBlockBytes  = 1 << 20;
+
+bool preadAll(int fd, char *data, qint64 size, qint64 offset)
+{
+    while (size > 0) {
+        ssize_t len = ::pread(fd, data, size_t(size), off_t(offset));
+        if (len <= 0) {
+            return false;
+        }
+        data += len;
+        size -= len;
+        offset += len;
+    }
+
+    return true;
+}
+
+bool pwriteAll(int fd, const char *data, qint64 size, qint64 offset)
+{
+    while (size > 0) {
+        ssize_t len = ::pwrite(fd, data, size_t(size), off_t(offset));
+        if (len <= 0) {
+            return false;
+        }
+        data += len;
+        size -= len;
+        offset += len;
+    }
+
+    return true;
+}
+
+}
+
+struct BlockArchive::BlockHeader
+{
+    quint32 magic;
+    quint8 coding;
+    quint8 reserved[3];
+    quint32 count;
+    quint32 size;           // 块数据的字节数，不含块头
+    qint64 firstMsecs;
+    qint64 lastMsecs;
+    quint32 checksum;       // 块数据的校验和
+    quint32 reserved2;
+};
+
+BlockArchive::BlockArchive()
+{
+}
+
+BlockArchive::~BlockArchive()
+{
+    close();
+}
+
+bool BlockArchive::open(const QString &path)
+{
+    close();
+
+    QMutexLocker flushLocker(&m_flushMutex);
+    QMutexLocker locker(&m_mutex);
+
+    m_fd = ::open(QFile::encodeName(path).constData(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (m_fd == -1) {
+        return false;
+    }
+
+    if (!scan()) {
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    m_encoder = Gorilla::Encoder(m_isFloat ? Gorilla::XorFloat : Gorilla::DeltaVarint);
+
+    return true;
+}
+
+void BlockArchive::close()
+{
+    flush();
+
+    QMutexLocker flushLocker(&m_flushMutex);
+    QMutexLocker locker(&m_mutex);
+
+    if (m_fd != -1) {
+        ::close(m_fd);
+    }
+
+    m_fd = -1;
+    m_fileSize = 0;
+    m_index.clear();
+    m_sealed.clear();
+    m_encoder.clear();
+    m_isFloat = false;
+    m_lastMsecs = 0;
+}
+
+bool BlockArchive::scan()
+{
+    struct stat st = {};
+    if (::fstat(m_fd, &st) != 0) {
+        return false;
+    }
+
+    qint64 offset = 0;
+    qint64 lastOffset = 0;
+    quint32 lastChecksum = 0;
+
+    m_index.clear();
+
+    // 逐个读取块头，遇到无效的块头即认为文件在此处结束
+    while (offset + qint64(sizeof(BlockHeader)) <= st.st_size) {
+        BlockHeader header;
+        if (!preadAll(m_fd, reinterpret_cast<char *>(&header), sizeof(header), offset)) {
+            break;
+        }
+
+        qint64 dataOffset = offset + qint64(sizeof(header));
+        bool isValid = (header.magic == BlockMagic)
+                    && (header.coding <= Gorilla::DeltaVarint)
+                    && (header.count > 0)
+                    && (header.size > 0 && header.size <= quint32(MaxBlockBytes))
+                    && (header.firstMsecs <= header.lastMsecs)
+                    && (m_index.isEmpty() || header.firstMsecs > m_index.last().lastMsecs)
+                    && (dataOffset + header.size <= st.st_size);
+        if (!isValid) {
+            break;
+        }
+
+        BlockIndex block;
+        block.firstMsecs = header.firstMsecs;
+        block.lastMsecs  = header.lastMsecs;
+        block.offset     = dataOffset;
+        block.size       = int(header.size);
+        block.count      = int(header.count);
+        block.coding     = Gorilla::Coding(header.coding);
+        m_index.append(block);
+
+        lastOffset   = offset;
+        lastChecksum = header.checksum;
+        offset       = dataOffset + header.size;
+    }
+
+    // 只有最后一个块可能在写入时掉电，校验其数据
+    if (!m_index.isEmpty()) {
+        const auto &block = m_index.last();
+        QByteArray data(block.size, Qt::Uninitialized);
+
+        if (!preadAll(m_fd, data.data(), block.size, block.offset) || fnv1a(data.constData(), size_t(block.size)) != lastChecksum) {
+            m_index.removeLast();
+            offset = lastOffset;
+        }
+    }
+
+    if (offset != st.st_size && ::ftruncate(m_fd, off_t(offset)) != 0) {
+        return false;
+    }
+
+    m_fileSize  = offset;
+    m_lastMsecs = m_index.isEmpty() ? 0 : m_index.last().lastMsecs;
+    m_isFloat   = !m_index.isEmpty() && (m_index.last().coding == Gorilla::XorFloat);
+
+    return true;
+}
+
+void BlockArchive::seal()
+{
+    QByteArray data = m_encoder.data();
+
+    BlockHeader header = {};
+    header.magic      = BlockMagic;
+    header.coding     = m_encoder.coding();
+    header.count      = quint32(m_encoder.count());
+    header.size       = quint32(data.size());
+    header.firstMsecs = m_encoder.firstMsecs();
+    header.lastMsecs  = m_encoder.lastMsecs();
+    header.checksum   = fnv1a(data.constData(), size_t(data.size()));
+
+    QByteArray block(reinterpret_cast<const char *>(&header), sizeof(header));
+    block.append(data);
+    m_sealed.append(block);
+
+    m_encoder = Gorilla::Encoder(m_isFloat ? Gorilla::XorFloat : Gorilla::DeltaVarint);
+}
+
+void BlockArchive::append(qint64 msecs, double value)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_fd == -1 || msecs <= m_lastMsecs) {
+        return;
+    }
+
+    // 整数块中出现非整数：封闭当前块，此后一直使用浮点编码
+    bool isInteger = (value == floor(value)) && (fabs(value) < 1e15);
+    if (!isInteger && !m_isFloat) {
+        m_isFloat = true;
+        if (m_encoder.count() > 0) {
+            seal();
+        }
+        m_encoder = Gorilla::Encoder(Gorilla::XorFloat);
+    }
+
+    m_encoder.append(msecs, value);
+    m_lastMsecs = msecs;
+
+    if (m_encoder.count() >= BlockSamples || m_encoder.size() >= MaxBlockBytes - 32) {
+        seal();
+    }
+}
+
+void BlockArchive::flush()
+{
+    QMutexLocker flushLocker(&m_flushMutex);
+
+    m_mutex.lock();
+    QList<QByteArray> blocks = m_sealed;
+    qint64 offset = m_fileSize;
+    int fd = m_fd;
+    m_mutex.unlock();
+
+    if (fd == -1 || blocks.isEmpty()) {
+        return;
+    }
+
+    // 所有已封闭的块合并为一次写入，写入失败时保留到下次重试
+    QByteArray data;
+    for (const auto &block : blocks) {
+        data.append(block);
+    }
+
+    if (!pwriteAll(fd, data.constData(), data.size(), offset)) {
+        return;
+    }
+    ::fdatasync(fd);
+
+    QMutexLocker locker(&m_mutex);
+
+    for (const auto &block : blocks) {
+        const auto *header = reinterpret_cast<const BlockHeader *>(block.constData());
+
+        BlockIndex index;
+        index.firstMsecs = header->firstMsecs;
+        index.lastMsecs  = header->lastMsecs;
+        index.offset     = m_fileSize + qint64(sizeof(BlockHeader));
+        index.size       = int(header->size);
+        index.count      = int(header->count);
+        index.coding     = Gorilla::Coding(header->coding);
+        m_index.append(index);
+
+        m_fileSize += block.size();
+        m_sealed.removeFirst();
+    }
+}
+
+qint64 BlockArchive::lastMsecs() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_lastMsecs;
+}
+
+qint64 BlockArchive::archivedBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_fileSize;
+}
+
+void BlockArchive::decode(const char *data, const BlockIndex &block, qint64 begin, qint64 end, QVector<QPointF> &points)
+{
+    Gorilla::Decoder decoder(data, block.size, block.count, block.coding);
+    qint64 msecs;
+    double value;
+
+    while (decoder.next(msecs, value)) {
+        if (msecs > end) {
+            break;
+        }
+        if (msecs >= begin) {
+            points.append(QPointF(msecs, value));
+        }
+    }
+}
+
+QVector<QPointF> BlockArchive::query(qint64 begin, qint64 end) const
+{
+    QVector<QPointF> ret;
+
+    m_mutex.lock();
+
+    int fd = m_fd;
+
+    // 二分查找第一个可能包含 begin 的块
+    int lo = 0, hi = m_index.count();
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (m_index.at(mid).lastMsecs < begin) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+
+    QVector<BlockIndex> blocks;
+    for (int i=lo; i<m_index.count() && m_index.at(i).firstMsecs <= end; ++i) {
+        blocks.append(m_index.at(i));
+    }
+
+    // 尚未写入文件的块与当前块复制一份，在锁外解码
+    QList<QByteArray> sealed = m_sealed;
+    BlockIndex current = {m_encoder.firstMsecs(), m_encoder.lastMsecs(), 0, m_encoder.size(), m_encoder.count(), m_encoder.coding()};
+    QByteArray currentData = (m_encoder.count() > 0) ? m_encoder.data() : QByteArray();
+
+    m_mutex.unlock();
+
+    QByteArray data;
+    for (const auto &block : blocks) {
+        data.resize(block.size);
+        if (preadAll(fd, data.data(), block.size, block.offset)) {
+            decode(data.constData(), block, begin, end, ret);
+        }
+    }
+
+    for (const auto &block : sealed) {
+        const auto *header = reinterpret_cast<const BlockHeader *>(block.constData());
+        if (header->lastMsecs < begin || header->firstMsecs > end) {
+            continue;
+        }
+
+        BlockIndex index = {header->firstMsecs, header->lastMsecs, 0, int(header->size), int(header->count), Gorilla::Coding(header->coding)};
+        decode(block.constData() + sizeof(BlockHeader), index, begin, end, ret);
+    }
+
+    if (current.count > 0 && current.lastMsecs >= begin && current.firstMsecs <= end) {
+        decode(currentData.constData(), current, begin, end, ret);
+    }
+
+    return ret;
+}
@@ -0,0 +1,71 @@
+#ifndef BLOCKARCHIVE_H
+#define BLOCKARCHIVE_H
+
+#include "gorillacodec.h"
+
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QPointF>
+#include <QString>
+#include <QVector>
+
+/* 压缩块归档文件，用于长期保存传感器历史
+ * 1. 样本流式写入当前块的 Gorilla 编码器，满 BlockSamples 个样本后封闭
+ * 2. 整数序列使用 DeltaVarint 编码，出现非整数后当前块提前封闭，此后改用 XorFloat
+ * 3. flush() 将已封闭的块追加到文件末尾并 fdatasync，每块只产生一次写入
+ * 4. 打开时扫描块头建立时间索引，末尾写了一半的块被截断丢弃
+ * 5. 所有接口线程安全
+ */
+class BlockArchive
+{
+    struct BlockHeader;
+
+    struct BlockIndex {
+        qint64 firstMsecs;
+        qint64 lastMsecs;
+        qint64 offset;          // 块数据（不含块头）在文件中的偏移
+        int size;
+        int count;
+        Gorilla::Coding coding;
+    };
+
+public:
+    static constexpr int BlockSamples = 4096;
+
+    BlockArchive();
+    ~BlockArchive();
+
+    BlockArchive(const BlockArchive&) = delete;
+    BlockArchive &operator=(const BlockArchive&) = delete;
+
+    bool open(const QString &path);
+    void close();                                               // 写出已封闭的块，未封闭的部分丢弃
+
+    void append(qint64 msecs, double value);                    // 时间早于最后一个样本的样本被丢弃
+    void flush();
+
+    qint64 lastMsecs() const;                                   // 最后一个已追加的样本时刻，没有样本时返回 0
+    qint64 archivedBytes() const;                               // 文件中已保存的字节数
+    QVector<QPointF> query(qint64 begin, qint64 end) const;     // 解码 [begin, end] 内的样本，含尚未写出的块
+
+private:
+    bool scan();
+    void seal();
+    static void decode(const char *data, const BlockIndex &block, qint64 begin, qint64 end, QVector<QPointF> &points);
+
+private:
+    mutable QMutex m_mutex;
+    QMutex m_flushMutex;                // 串行化写文件，fdatasync 期间不阻塞 append()
+
+    int m_fd = -1;
+    qint64 m_fileSize = 0;
+    QVector<BlockIndex> m_index;        // 已写入文件的块，按时间排序
+
+    Gorilla::Encoder m_encoder;
+    bool m_isFloat = false;             // 一旦出现非整数即固定使用浮点编码
+    QList<QByteArray> m_sealed;         // 已封闭、尚未写入文件的块（含块头）
+    qint64 m_lastMsecs = 0;
+};
+
+#endif // BLOCKARCHIVE_H
@@ -0,0 +1,21 @@
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <QtGlobal>
+
+#include <stddef.h>
+
+/* FNV-1a 32 位校验和，用于识别掉电时写了一半的文件头与数据块 */
+inline quint32 fnv1a(const void *data, size_t len)
+{
+    auto p = static_cast<const uchar *>(data);
+    quint32 hash = 2166136261u;
+
+    for (size_t i=0; i<len; ++i) {
+        hash = (hash ^ p[i]) * 16777619u;
+    }
+
+    return hash;
+}
+
+#endif // CHECKSUM_H
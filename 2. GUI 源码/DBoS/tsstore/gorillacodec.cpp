@@ -0,0 +1,320 @@
+#include "gorillacodec.h"
+
+#include <QtAlgorithms>
+
+#include <string.h>
+
+namespace {
+
+quint64 doubleToBits(double value)
+{
+    quint64 ret;
+    memcpy(&ret, &value, sizeof(ret));
+    return ret;
+}
+
+double bitsToDouble(quint64 bits)
+{
+    double ret;
+    memcpy(&ret, &bits, sizeof(ret));
+    return ret;
+}
+
+}
+
+namespace Gorilla {
+
+Encoder::Encoder(Coding coding) : m_coding(coding)
+{
+}
+
+void Encoder::clear()
+{
+    m_data.clear();
+    m_acc = 0;
+    m_accBits = 0;
+    m_count = 0;
+    m_firstMsecs = m_lastMsecs = m_lastDelta = 0;
+    m_lastBits = 0;
+    m_leading = -1;
+    m_trailing = 0;
+}
+
+Coding Encoder::coding() const
+{
+    return m_coding;
+}
+
+int Encoder::count() const
+{
+    return m_count;
+}
+
+int Encoder::size() const
+{
+    return m_data.size() + (m_accBits + 7) / 8;
+}
+
+qint64 Encoder::firstMsecs() const
+{
+    return m_firstMsecs;
+}
+
+qint64 Encoder::lastMsecs() const
+{
+    return m_lastMsecs;
+}
+
+QByteArray Encoder::data() const
+{
+    QByteArray ret = m_data;
+
+    if (m_accBits > 0) {
+        ret.append(char((m_acc << (8 - m_accBits)) & 0xff));
+    }
+
+    return ret;
+}
+
+void Encoder::writeBits(quint64 value, int bits)
+{
+    // 每次最多累加 32 位，累加器中的位数始终不超过 40
+    if (bits > 32) {
+        writeBits(value >> 32, bits - 32);
+        bits = 32;
+    }
+
+    m_acc = (m_acc << bits) | (value & ((quint64(1) << bits) - 1));
+    m_accBits += bits;
+
+    while (m_accBits >= 8) {
+        m_accBits -= 8;
+        m_data.append(char((m_acc >> m_accBits) & 0xff));
+    }
+}
+
+void Encoder::append(qint64 msecs, double value)
+{
+    writeTimestamp(msecs);
+
+    if (m_coding == XorFloat) {
+        writeXor(value);
+    }
+    else {
+        writeVarint(value);
+    }
+
+    if (m_count++ == 0) {
+        m_firstMsecs = msecs;
+    }
+    m_lastMsecs = msecs;
+}
+
+void Encoder::writeTimestamp(qint64 msecs)
+{
+    if (m_count == 0) {
+        writeBits(quint64(msecs), 64);
+        return;
+    }
+
+    qint64 delta = msecs - m_lastMsecs;
+    qint64 dod   = delta - m_lastDelta;
+    m_lastDelta  = delta;
+
+    // 二阶差分按范围分桶，前缀依次为 0、10、110、1110、1111
+    if (dod == 0) {
+        writeBits(0, 1);
+    }
+    else if (dod >= -63 && dod <= 64) {
+        writeBits(0x2, 2);
+        writeBits(quint64(dod + 63), 7);
+    }
+    else if (dod >= -255 && dod <= 256) {
+        writeBits(0x6, 3);
+        writeBits(quint64(dod + 255), 9);
+    }
+    else if (dod >= -2047 && dod <= 2048) {
+        writeBits(0xe, 4);
+        writeBits(quint64(dod + 2047), 12);
+    }
+    else {
+        writeBits(0xf, 4);
+        writeBits(quint64(dod), 64);
+    }
+}
+
+void Encoder::writeXor(double value)
+{
+    quint64 bits = doubleToBits(value);
+
+    if (m_count == 0) {
+        writeBits(bits, 64);
+        m_lastBits = bits;
+        return;
+    }
+
+    quint64 x = bits ^ m_lastBits;
+    m_lastBits = bits;
+
+    if (x == 0) {
+        writeBits(0, 1);
+        return;
+    }
+
+    int leading  = qMin(int(qCountLeadingZeroBits(x)), 31);
+    int trailing = int(qCountTrailingZeroBits(x));
+
+    // 有效位落在上一个窗口内时沿用窗口，省去窗口描述
+    if (m_leading >= 0 && leading >= m_leading && trailing >= m_trailing) {
+        writeBits(0x2, 2);
+        writeBits(x >> m_trailing, 64 - m_leading - m_trailing);
+        return;
+    }
+
+    int meaningful = 64 - leading - trailing;
+
+    writeBits(0x3, 2);
+    writeBits(quint64(leading), 5);
+    writeBits(quint64(meaningful & 0x3f), 6);     // 64 位全部有效时记为 0
+    writeBits(x >> trailing, meaningful);
+
+    m_leading  = leading;
+    m_trailing = trailing;
+}
+
+void Encoder::writeVarint(double value)
+{
+    qint64 current = qint64(value);
+    qint64 delta   = current - qint64(m_lastBits);
+    quint64 zigzag = (quint64(delta) << 1) ^ quint64(delta >> 63);
+
+    m_lastBits = quint64(current);
+
+    while (zigzag >= 0x80) {
+        writeBits((zigzag & 0x7f) | 0x80, 8);
+        zigzag >>= 7;
+    }
+    writeBits(zigzag, 8);
+}
+
+Decoder::Decoder(const char *data, int size, int count, Coding coding)
+    : m_data(reinterpret_cast<const uchar *>(data)), m_size(size), m_remain(count), m_coding(coding)
+{
+}
+
+quint64 Decoder::readBits(int bits)
+{
+    quint64 ret = 0;
+
+    // 按字节整段读取，越界部分视为 0，损坏的数据不会读出缓冲区
+    while (bits > 0) {
+        int index  = m_pos >> 3;
+        int avail  = 8 - (m_pos & 7);
+        int take   = qMin(avail, bits);
+        uint byte  = (index < m_size) ? m_data[index] : 0;
+
+        ret = (ret << take) | ((byte >> (avail - take)) & ((1u << take) - 1));
+
+        bits  -= take;
+        m_pos += take;
+    }
+
+    return ret;
+}
+
+bool Decoder::readBit()
+{
+    return readBits(1) != 0;
+}
+
+bool Decoder::next(qint64 &msecs, double &value)
+{
+    if (m_remain <= 0) {
+        return false;
+    }
+
+    --m_remain;
+
+    msecs = readTimestamp();
+    value = (m_coding == XorFloat) ? readXor() : readVarint();
+
+    m_isFirst = false;
+
+    return true;
+}
+
+qint64 Decoder::readTimestamp()
+{
+    if (m_isFirst) {
+        m_lastMsecs = qint64(readBits(64));
+        return m_lastMsecs;
+    }
+
+    qint64 dod = 0;
+
+    if (!readBit()) {
+        dod = 0;
+    }
+    else if (!readBit()) {
+        dod = qint64(readBits(7)) - 63;
+    }
+    else if (!readBit()) {
+        dod = qint64(readBits(9)) - 255;
+    }
+    else if (!readBit()) {
+        dod = qint64(readBits(12)) - 2047;
+    }
+    else {
+        dod = qint64(readBits(64));
+    }
+
+    m_lastDelta += dod;
+    m_lastMsecs += m_lastDelta;
+
+    return m_lastMsecs;
+}
+
+double Decoder::readXor()
+{
+    if (m_isFirst) {
+        m_lastBits = readBits(64);
+        return bitsToDouble(m_lastBits);
+    }
+
+    if (!readBit()) {
+        return bitsToDouble(m_lastBits);
+    }
+
+    if (readBit()) {
+        m_leading    = int(readBits(5));
+        m_meaningful = int(readBits(6));
+        if (m_meaningful == 0) {
+            m_meaningful = 64;
+        }
+    }
+
+    int trailing = 64 - m_leading - m_meaningful;
+    m_lastBits ^= readBits(m_meaningful) << trailing;
+
+    return bitsToDouble(m_lastBits);
+}
+
+double Decoder::readVarint()
+{
+    quint64 zigzag = 0;
+
+    for (int shift=0; shift<64; shift+=7) {
+        quint64 byte = readBits(8);
+        zigzag |= (byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            break;
+        }
+    }
+
+    qint64 delta = qint64(zigzag >> 1) ^ -qint64(zigzag & 1);
+    m_lastBits = quint64(qint64(m_lastBits) + delta);
+
+    return double(qint64(m_lastBits));
+}
+
+}
@@ -0,0 +1,87 @@
+#ifndef GORILLACODEC_H
+#define GORILLACODEC_H
+
+#include <QByteArray>
+#include <QtGlobal>
+
+/* Gorilla 风格的时序压缩编码
+ * 1. 时间戳：首个时间戳原样保存，其后按二阶差分（delta-of-delta）变长编码，周期采样时多数样本只占 1 位
+ * 2. 浮点值：与上一个值按位异或，只保存有效位窗口，缓慢变化的数值通常只占十几位
+ * 3. 整数值：与上一个值的差经 zigzag 后按 varint 编码，适合 AP3216C 等 16 位计数值
+ * 4. 编码与解码均为流式，逐个样本处理，不需要额外的中间缓冲
+ */
+namespace Gorilla {
+
+enum Coding : quint8 {
+    XorFloat    = 0,
+    DeltaVarint = 1
+};
+
+class Encoder
+{
+public:
+    explicit Encoder(Coding coding = XorFloat);
+
+    void append(qint64 msecs, double value);    // DeltaVarint 编码时 value 必须为整数
+    void clear();
+
+    Coding coding() const;
+    int count() const;
+    int size() const;                           // 已编码的字节数
+    qint64 firstMsecs() const;
+    qint64 lastMsecs() const;
+    QByteArray data() const;                    // 已编码的数据，末尾不足一个字节的部分以 0 补齐
+
+private:
+    void writeBits(quint64 value, int bits);
+    void writeTimestamp(qint64 msecs);
+    void writeXor(double value);
+    void writeVarint(double value);
+
+private:
+    Coding m_coding;
+    QByteArray m_data;
+    quint64 m_acc = 0;          // 尚未写入 m_data 的位，低位对齐
+    int m_accBits = 0;
+
+    int m_count = 0;
+    qint64 m_firstMsecs = 0;
+    qint64 m_lastMsecs = 0;
+    qint64 m_lastDelta = 0;
+    quint64 m_lastBits = 0;     // 上一个浮点值的位模式或上一个整数值
+    int m_leading = -1;         // 上一个异或窗口，-1 表示尚无窗口
+    int m_trailing = 0;
+};
+
+class Decoder
+{
+public:
+    Decoder(const char *data, int size, int count, Coding coding);
+
+    bool next(qint64 &msecs, double &value);    // 按顺序取出下一个样本，全部取完返回 false
+
+private:
+    quint64 readBits(int bits);
+    bool readBit();
+    qint64 readTimestamp();
+    double readXor();
+    double readVarint();
+
+private:
+    const uchar *m_data;
+    int m_size;
+    int m_remain;
+    Coding m_coding;
+    int m_pos = 0;              // 已读取的位数
+
+    bool m_isFirst = true;
+    qint64 m_lastMsecs = 0;
+    qint64 m_lastDelta = 0;
+    quint64 m_lastBits = 0;
+    int m_leading = 0;
+    int m_meaningful = 0;
+};
+
+}
+
+#endif // GORILLACODEC_H
@@ -0,0 +1,315 @@
+#include "ringfile.h"
+
+#include "checksum.h"
+
+#include <QFile>
+#include <QMutexLocker>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr char Magic[8]   = {'D', 'B', 'o', 'S', 'R', 'I', 'N', 'G'};
+constexpr quint32 Version = 1;
+constexpr size_t HeaderSize = 4096;     // 文件头独占一页，记录区从页边界开始
+
+}
+
+struct RingFile::Commit
+{
+    quint64 sequence;
+    quint64 head;
+    quint64 count;
+    quint32 checksum;       // 前三个字段的校验和，提交写到一半时校验失败
+    quint32 reserved;
+};
+
+struct RingFile::Header
+{
+    char magic[8];
+    quint32 version;
+    quint32 recordSize;
+    quint64 capacity;
+    Commit commits[2];
+};
+
+RingFile::RingFile()
+{
+}
+
+RingFile::~RingFile()
+{
+    close();
+}
+
+bool RingFile::open(const QString &path, int capacity, int slack)
+{
+    close();
+
+    QMutexLocker commitLocker(&m_commitMutex);
+    QMutexLocker locker(&m_mutex);
+
+    m_fd = ::open(QFile::encodeName(path).constData(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (m_fd == -1) {
+        return false;
+    }
+
+    // 文件已存在且格式有效时沿用其容量，否则按给定容量重新格式化
+    Header header = {};
+    struct stat st = {};
+    bool isValid = (::fstat(m_fd, &st) == 0)
+                && (::pread(m_fd, &header, sizeof(header), 0) == ssize_t(sizeof(header)))
+                && (memcmp(header.magic, Magic, sizeof(Magic)) == 0)
+                && (header.version == Version)
+                && (header.recordSize == sizeof(Record))
+                && (header.capacity > 1)
+                && (size_t(st.st_size) == HeaderSize + header.capacity * sizeof(Record));
+
+    m_capacity = isValid ? header.capacity : quint64(qMax(capacity, 2));
+    m_slack    = quint64(qBound(1, slack, int(m_capacity / 2)));
+    m_mapSize  = HeaderSize + m_capacity * sizeof(Record);
+
+    if (!isValid && (::ftruncate(m_fd, 0) != 0 || ::ftruncate(m_fd, off_t(m_mapSize)) != 0)) {
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    void *map = ::mmap(NULL, m_mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (map == MAP_FAILED) {
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    m_map     = static_cast<uchar *>(map);
+    m_header  = reinterpret_cast<Header *>(m_map);
+    m_records = reinterpret_cast<Record *>(m_map + HeaderSize);
+
+    if (!isValid || !load()) {
+        format();
+    }
+
+    return true;
+}
+
+void RingFile::close()
+{
+    commit();
+
+    QMutexLocker commitLocker(&m_commitMutex);
+    QMutexLocker locker(&m_mutex);
+
+    if (m_map != nullptr) {
+        ::munmap(m_map, m_mapSize);
+    }
+
+    if (m_fd != -1) {
+        ::close(m_fd);
+    }
+
+    m_fd = -1;
+    m_map = nullptr;
+    m_header = nullptr;
+    m_records = nullptr;
+    m_sequence = m_committedHead = m_committedCount = m_head = 0;
+    m_lastMsecs = 0;
+}
+
+bool RingFile::isOpen() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_map != nullptr;
+}
+
+bool RingFile::load()
+{
+    const Commit *latest = nullptr;
+
+    // 取校验通过且序号最大的提交槽
+    for (const auto &slot : m_header->commits) {
+        if (slot.checksum != fnv1a(&slot, offsetof(Commit, checksum)) || slot.count > slot.head) {
+            continue;
+        }
+        if (latest == nullptr || slot.sequence > latest->sequence) {
+            latest = &slot;
+        }
+    }
+
+    if (latest == nullptr) {
+        return false;
+    }
+
+    m_sequence       = latest->sequence;
+    m_committedHead  = latest->head;
+    m_committedCount = qMin(latest->count, m_capacity - m_slack);
+    m_head           = m_committedHead;
+    m_lastMsecs      = (m_committedCount > 0) ? recordAt(m_committedHead - 1).msecs : 0;
+
+    return true;
+}
+
+void RingFile::format()
+{
+    memset(m_header, 0, sizeof(Header));
+    memcpy(m_header->magic, Magic, sizeof(Magic));
+    m_header->version    = Version;
+    m_header->recordSize = sizeof(Record);
+    m_header->capacity   = m_capacity;
+
+    m_sequence = m_committedHead = m_committedCount = m_head = 0;
+    m_lastMsecs = 0;
+
+    writeCommit(0, 0);
+    syncRange(0, HeaderSize);
+}
+
+void RingFile::writeCommit(quint64 head, quint64 count)
+{
+    // 交替写入两个提交槽，写到一半掉电时另一个槽仍是完整的上一次提交
+    auto &slot = m_header->commits[(m_sequence + 1) & 1];
+
+    slot.sequence = ++m_sequence;
+    slot.head     = head;
+    slot.count    = count;
+    slot.checksum = fnv1a(&slot, offsetof(Commit, checksum));
+}
+
+const RingFile::Record &RingFile::recordAt(quint64 index) const
+{
+    return m_records[index % m_capacity];
+}
+
+void RingFile::append(qint64 msecs, double value)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_map == nullptr || msecs <= m_lastMsecs) {
+        return;
+    }
+
+    // 空闲区已写满：先提交再继续写入，不能覆盖已提交的记录
+    if (m_head - m_committedHead >= m_slack) {
+        locker.unlock();
+        commit();
+        locker.relock();
+
+        if (m_map == nullptr || m_head - m_committedHead >= m_slack) {
+            return;
+        }
+    }
+
+    Record &record = m_records[m_head % m_capacity];
+    record.msecs = msecs;
+    record.value = value;
+
+    ++m_head;
+    m_lastMsecs = msecs;
+}
+
+void RingFile::commit()
+{
+    QMutexLocker commitLocker(&m_commitMutex);
+
+    m_mutex.lock();
+    quint64 begin = m_committedHead;
+    quint64 end   = m_head;
+    bool isDirty  = (m_map != nullptr) && (begin != end);
+    m_mutex.unlock();
+
+    if (!isDirty) {
+        return;
+    }
+
+    // 数据落盘后再发布文件头，掉电时最多丢失本批次
+    syncRecords(begin, end);
+
+    m_mutex.lock();
+    m_committedCount = qMin(m_committedCount + (end - begin), m_capacity - m_slack);
+    m_committedHead  = end;
+    writeCommit(m_committedHead, m_committedCount);
+    m_mutex.unlock();
+
+    syncRange(0, HeaderSize);
+}
+
+void RingFile::syncRecords(quint64 begin, quint64 end)
+{
+    quint64 first = begin % m_capacity;
+    quint64 count = end - begin;
+
+    if (first + count <= m_capacity) {
+        syncRange(HeaderSize + first * sizeof(Record), count * sizeof(Record));
+    }
+    else {
+        syncRange(HeaderSize + first * sizeof(Record), (m_capacity - first) * sizeof(Record));
+        syncRange(HeaderSize, (first + count - m_capacity) * sizeof(Record));
+    }
+}
+
+void RingFile::syncRange(size_t offset, size_t length)
+{
+    static const size_t pageSize = size_t(::sysconf(_SC_PAGESIZE));
+
+    size_t start = offset & ~(pageSize - 1);
+    ::msync(m_map + start, offset + length - start, MS_SYNC);
+}
+
+int RingFile::count() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return int(m_committedCount);
+}
+
+qint64 RingFile::firstMsecs() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return (m_map != nullptr && m_committedCount > 0) ? recordAt(m_committedHead - m_committedCount).msecs : 0;
+}
+
+quint64 RingFile::lowerBound(qint64 msecs) const
+{
+    quint64 lo = m_committedHead - m_committedCount;
+    quint64 hi = m_committedHead;
+
+    while (lo < hi) {
+        quint64 mid = lo + (hi - lo) / 2;
+        if (recordAt(mid).msecs < msecs) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+QVector<QPointF> RingFile::query(qint64 begin, qint64 end) const
+{
+    QVector<QPointF> ret;
+    QMutexLocker locker(&m_mutex);
+
+    if (m_map == nullptr || begin > end) {
+        return ret;
+    }
+
+    for (quint64 i=lowerBound(begin); i<m_committedHead; ++i) {
+        const Record &record = recordAt(i);
+        if (record.msecs > end) {
+            break;
+        }
+        ret.append(QPointF(record.msecs, record.value));
+    }
+
+    return ret;
+}
@@ -0,0 +1,72 @@
+#ifndef RINGFILE_H
+#define RINGFILE_H
+
+#include <QMutex>
+#include <QPointF>
+#include <QString>
+#include <QVector>
+
+/* 内存映射的定长环形时序文件
+ * 1. 文件由一页文件头与 capacity 条定长记录组成，记录按时间顺序循环写入
+ * 2. append() 只写映射内存，不产生系统调用；commit() 先 msync 数据再 msync 文件头
+ * 3. 文件头含两个带校验的提交槽，交替写入，掉电后取序号最大的有效槽恢复
+ * 4. 已提交区域之后保留 slack 条空闲记录，未提交的写入永远不会覆盖已提交的数据
+ * 5. 所有接口线程安全
+ */
+class RingFile
+{
+public:
+    struct Record {
+        qint64 msecs;
+        double value;
+    };
+
+    RingFile();
+    ~RingFile();
+
+    RingFile(const RingFile&) = delete;
+    RingFile &operator=(const RingFile&) = delete;
+
+    bool open(const QString &path, int capacity, int slack);     // 文件已存在时沿用其容量
+    void close();                                               // 提交未保存的记录并解除映射
+    bool isOpen() const;
+
+    void append(qint64 msecs, double value);                    // 时间早于最后一条记录的样本被丢弃
+    void commit();                                              // 持久化已追加的记录
+
+    int count() const;                                          // 已提交的记录数
+    qint64 firstMsecs() const;                                  // 最早一条已提交记录的时刻，没有记录时返回 0
+    QVector<QPointF> query(qint64 begin, qint64 end) const;     // 读取 [begin, end] 内已提交的记录
+
+private:
+    struct Commit;
+    struct Header;
+
+    bool load();
+    void format();
+    const Record &recordAt(quint64 index) const;
+    quint64 lowerBound(qint64 msecs) const;
+    void syncRecords(quint64 begin, quint64 end);
+    void syncRange(size_t offset, size_t length);
+    void writeCommit(quint64 head, quint64 count);
+
+private:
+    mutable QMutex m_mutex;             // 保护映射内容与下列状态
+    QMutex m_commitMutex;               // 串行化提交，msync 期间不阻塞 append()
+
+    int m_fd = -1;
+    uchar *m_map = nullptr;
+    size_t m_mapSize = 0;
+    Header *m_header = nullptr;
+    Record *m_records = nullptr;
+
+    quint64 m_capacity = 0;
+    quint64 m_slack = 0;
+    quint64 m_sequence = 0;             // 最近一次提交的序号
+    quint64 m_committedHead = 0;        // 已提交记录的结束位置（单调递增，取模得到槽位）
+    quint64 m_committedCount = 0;
+    quint64 m_head = 0;                 // 已追加记录的结束位置
+    qint64 m_lastMsecs = 0;
+};
+
+#endif // RINGFILE_H
@@ -0,0 +1,202 @@
+#include "timeseriesstore.h"
+
+#include <QDir>
+#include <QMutexLocker>
+#include <QtConcurrent/QtConcurrent>
+
+#include <limits>
+
+namespace {
+
+constexpr int CommitIntervalMs = 5000;  // 提交周期：掉电最多丢失这段时间内的样本
+constexpr int CommitSlack      = 512;   // 两次提交之间每个序列最多缓存的记录数
+
+// 保留最近 maxPoints / 2 个原始样本，更早的部分按等时长分桶，每桶只保留最小值与最大值，保持峰谷包络
+QVector<QPointF> decimate(const QVector<QPointF> &points, int maxPoints)
+{
+    if (maxPoints <= 0 || points.count() <= maxPoints) {
+        return points;
+    }
+
+    int keep    = maxPoints / 2;
+    int older   = points.count() - keep;
+    int buckets = qMax((maxPoints - keep) / 2, 1);
+    double begin = points.first().x();
+    double span  = points.at(older - 1).x() - begin + 1;
+
+    QVector<QPointF> ret;
+    ret.reserve(maxPoints);
+
+    int i = 0;
+    for (int bucket=0; bucket<buckets && i<older; ++bucket) {
+        double bucketEnd = begin + span * (bucket + 1) / buckets;
+        int first = i;
+        int minIndex = i;
+        int maxIndex = i;
+
+        // 最后一个桶收下剩余的全部样本，避免浮点误差漏掉末尾的点
+        for (; i<older && (points.at(i).x() < bucketEnd || bucket == buckets - 1); ++i) {
+            if (points.at(i).y() < points.at(minIndex).y()) {
+                minIndex = i;
+            }
+            if (points.at(i).y() > points.at(maxIndex).y()) {
+                maxIndex = i;
+            }
+        }
+
+        if (i == first) {
+            continue;
+        }
+
+        ret.append(points.at(qMin(minIndex, maxIndex)));
+        if (minIndex != maxIndex) {
+            ret.append(points.at(qMax(minIndex, maxIndex)));
+        }
+    }
+
+    ret += points.mid(older);
+
+    return ret;
+}
+
+}
+
+TimeSeriesStore *TimeSeriesStore::instance()
+{
+    static TimeSeriesStore store;
+
+    return &store;
+}
+
+TimeSeriesStore::TimeSeriesStore() : QObject(NULL), m_directory(QDir::homePath() + "/.dbos/history")
+{
+    // 提交定时器运行在后台线程，msync 不占用 GUI 线程
+    m_pCommitTimer = new QTimer;
+    m_pCommitTimer->setInterval(CommitIntervalMs);
+    m_pCommitTimer->moveToThread(&m_thread);
+
+    connect(&m_thread, &QThread::started, m_pCommitTimer, static_cast<void (QTimer::*)()>(&QTimer::start));
+    connect(m_pCommitTimer, &QTimer::timeout, m_pCommitTimer, [this]() { commit(); });
+    connect(&m_thread, &QThread::finished, m_pCommitTimer, &QTimer::deleteLater);
+
+    m_thread.start();
+}
+
+TimeSeriesStore::~TimeSeriesStore()
+{
+    m_thread.quit();
+    m_thread.wait();
+
+    commit();
+}
+
+void TimeSeriesStore::setDirectory(const QString &path)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_directory = path;
+}
+
+QString TimeSeriesStore::directory() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_directory;
+}
+
+void TimeSeriesStore::setCapacity(int records)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_capacity = qMax(records, CommitSlack * 2);
+}
+
+QSharedPointer<TimeSeriesStore::Series> TimeSeriesStore::series(const QString &name, bool create)
+{
+    QMutexLocker locker(&m_mutex);
+
+    // 同一序列只由一个线程打开，其他线程等待其完成
+    while (m_opening.contains(name)) {
+        m_opened.wait(&m_mutex);
+    }
+
+    auto ret = m_series.value(name);
+    if (!ret.isNull() || !create) {
+        return ret;
+    }
+
+    QString directory = m_directory;
+    int capacity = m_capacity;
+
+    // 打开、映射与加载文件在 SD 卡上可能耗时较长，在锁外进行，不阻塞其他序列的 append() 与 query()
+    m_opening.insert(name);
+    locker.unlock();
+
+    QDir().mkpath(directory);
+
+    ret = QSharedPointer<Series>::create();
+    if (ret->ring.open(directory + "/" + name + ".ring", capacity, CommitSlack) && ret->archive.open(directory + "/" + name + ".blk")) {
+        // 上次退出时未封闭的块没有写入归档，从环形文件中补齐
+        for (const auto &point : ret->ring.query(ret->archive.lastMsecs() + 1, std::numeric_limits<qint64>::max())) {
+            ret->archive.append(qint64(point.x()), point.y());
+        }
+    }
+    else {
+        ret.reset();
+    }
+
+    locker.relock();
+
+    if (!ret.isNull()) {
+        m_series.insert(name, ret);
+    }
+
+    m_opening.remove(name);
+    m_opened.wakeAll();
+
+    return ret;
+}
+
+void TimeSeriesStore::append(const QString &name, qint64 msecs, double value)
+{
+    auto target = series(name, true);
+
+    if (!target.isNull()) {
+        target->ring.append(msecs, value);
+        target->archive.append(msecs, value);
+    }
+}
+
+QFuture<QVector<QPointF>> TimeSeriesStore::query(const QString &name, qint64 begin, qint64 end, int maxPoints)
+{
+    return QtConcurrent::run([this, name, begin, end, maxPoints]() {
+        // 尚未写入过的序列也要能读取上次运行留下的文件
+        auto target = series(name, QFile::exists(directory() + "/" + name + ".ring"));
+        if (target.isNull()) {
+            return QVector<QPointF>();
+        }
+
+        // 环形文件覆盖的范围直接读取原始记录，更早的部分从压缩块解码
+        qint64 ringBegin = target->ring.firstMsecs();
+        if (ringBegin == 0) {
+            return decimate(target->archive.query(begin, end), maxPoints);
+        }
+
+        QVector<QPointF> ret = (begin < ringBegin) ? target->archive.query(begin, qMin(end, ringBegin - 1)) : QVector<QPointF>();
+        ret += target->ring.query(begin, end);
+
+        return decimate(ret, maxPoints);
+    });
+}
+
+void TimeSeriesStore::commit()
+{
+    m_mutex.lock();
+    auto all = m_series.values();
+    m_mutex.unlock();
+
+    for (auto &target : all) {
+        target->ring.commit();
+        target->archive.flush();
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef TIMESERIESSTORE_H
+#define TIMESERIESSTORE_H
+
+#include "blockarchive.h"
+#include "ringfile.h"
+
+#include <QFuture>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QSharedPointer>
+#include <QThread>
+#include <QTimer>
+#include <QWaitCondition>
+
+/* 传感器历史数据存储
+ * 1. 每个序列对应目录下的一个 RingFile 与一个 BlockArchive，首次写入时创建
+ * 2. append() 只写映射内存与编码器，任意线程可调用；后台线程按固定周期批量提交
+ * 3. RingFile 保存最近的原始样本，BlockArchive 以压缩块长期保存全部样本
+ * 4. query() 在线程池中读取，环形文件之前的部分从压缩块解码，不阻塞 GUI 线程
+ * 5. query() 可在线程池中降采样到给定点数，长时间范围的回填在 GUI 线程中只需处理少量的点
+ */
+class TimeSeriesStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    static TimeSeriesStore *instance();
+
+    void setDirectory(const QString &path);                     // 需在第一次 append() 之前调用
+    QString directory() const;
+    void setCapacity(int records);                              // 新建文件的记录数
+
+    void append(const QString &name, qint64 msecs, double value);
+    QFuture<QVector<QPointF>> query(const QString &name, qint64 begin, qint64 end, int maxPoints = 0);  // maxPoints 为 0 时返回全部原始样本
+
+public slots:
+    void commit();                                              // 立即提交所有序列
+
+private:
+    struct Series {
+        RingFile ring;
+        BlockArchive archive;
+    };
+
+    TimeSeriesStore();
+    ~TimeSeriesStore();
+
+    QSharedPointer<Series> series(const QString &name, bool create);
+
+private:
+    QThread m_thread;
+    QTimer *m_pCommitTimer = nullptr;
+
+    mutable QMutex m_mutex;
+    QHash<QString, QSharedPointer<Series>> m_series;
+    QSet<QString> m_opening;                // 正在锁外打开文件的序列，同名的请求等待 m_opened
+    QWaitCondition m_opened;
+    QString m_directory;
+    int m_capacity = 256 * 1024;
+};
+
+#endif // TIMESERIESSTORE_H
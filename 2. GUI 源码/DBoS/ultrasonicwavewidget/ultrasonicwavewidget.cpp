@@ -1,11 +1,10 @@
 #include "ultrasonicwavewidget.h"
 
 #include "commonhelper.h"
+#include "modulemanager/modulemanager.h"
 #include "simplemessagebox/simplemessagebox.h"
 
-#include <QProcess>
-
-UltrasonicwaveWidget::UltrasonicwaveWidget(QWidget *parent) : QDialog(parent), m_thread("/dev/sr04")
+UltrasonicwaveWidget::UltrasonicwaveWidget(QWidget *parent) : QDialog(parent)
 {
     initUi();
     initCtrl();
@@ -14,10 +13,10 @@ UltrasonicwaveWidget::UltrasonicwaveWidget(QWidget *parent) : QDialog(parent), m
 
 UltrasonicwaveWidget::~UltrasonicwaveWidget()
 {
-    m_thread.quit();
-    m_thread.wait();
+    delete m_pChannel;
+    m_device.close();
 
-    QProcess::execute("rmmod /driver/sr04_drv.ko");
+    ModuleManager::instance()->release("/driver/sr04_drv.ko");
 
     setDistance(0);
 }
@@ -42,15 +41,39 @@ void UltrasonicwaveWidget::initUi()
 
 void UltrasonicwaveWidget::initCtrl()
 {
-    QProcess::execute("insmod /driver/sr04_drv.ko");
-
     setDistance(0);
 
-    if (!m_thread.start()) {
+    ModuleManager::instance()->acquire("/driver/sr04_drv.ko", this, [this](bool) {
+        openDevice();
+    });
+}
+
+void UltrasonicwaveWidget::openDevice()
+{
+    // 驱动以 20 Hz 连续测距，每个有效回波推入 IIO 缓冲区
+    SensorConfig config;
+    if (m_device.open("sr04", config)) {
+        config.history = QStringList{"sr04_distance"};
+
+        // 扫描顺序为中值滤波后的距离、原始距离，单位米
+        auto decode = config.decoder;
+        config.decoder = [decode](const char *data, int len, SensorSample &sample) {
+            if (!decode(data, len, sample) || sample.count != 2) {
+                return false;
+            }
+            sample.count = 1;
+            sample.values[0] = qRound(sample.values[0] * 1000);
+            return true;
+        };
+
+        m_pChannel = SensorEngine::instance()->open(config, this);
+    }
+    if (m_pChannel != nullptr) {
+        connect(m_pChannel, &SensorChannel::readyRead, this, &UltrasonicwaveWidget::readSample);
+    }
+    else {
         SimpleMessageBox::infomationMessageBox("未检测到设备，请重试");
     }
-
-    connect(&m_thread, &UltrasonicwaveThread::readReady, this, &UltrasonicwaveWidget::setDistance);
 }
 
 void UltrasonicwaveWidget::setDistance(int meter)
@@ -58,4 +81,14 @@ void UltrasonicwaveWidget::setDistance(int meter)
     m_statusLbl.setText(QString("Distance : %1 Millimeter").arg(meter));
 }
 
+void UltrasonicwaveWidget::readSample()
+{
+    SensorSample sample;
+    if (!m_pChannel->latest(sample)) {
+        return;
+    }
+
+    setDistance(int(sample.values[0]));
+}
+
 
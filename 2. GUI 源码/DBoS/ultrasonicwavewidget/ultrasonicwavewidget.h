@@ -1,12 +1,11 @@
 #ifndef ULTRASONICWAVEWIDGET_H
 #define ULTRASONICWAVEWIDGET_H
 
-#include "ultrasonicwavethread.h"
+#include "sensorengine/iiodevice.h"
+#include "sensorengine/sensorengine.h"
 
 #include <QDialog>
 #include <QLabel>
-#include <QThread>
-#include <QSharedPointer>
 
 class UltrasonicwaveWidget : public QDialog
 {
@@ -18,15 +17,18 @@ public:
 private:
     void initUi();
     void initCtrl();
+    void openDevice();
 
 private slots:
     void setDistance(int meter);
+    void readSample();
 
 private:
     QLabel m_iconLbl;
     QLabel m_statusLbl;
 
-    UltrasonicwaveThread m_thread;
+    IioDevice m_device;
+    SensorChannel *m_pChannel = nullptr;
 };
 
 #endif // ULTRASONICWAVEWIDGET_H
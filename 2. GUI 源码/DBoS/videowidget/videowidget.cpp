@@ -1,6 +1,7 @@
 #include "videowidget.h"
 
 #include "commonhelper.h"
+#include "stylesheet/stylesheetcache.h"
 
 #include <QHBoxLayout>
 #include <QVBoxLayout>
@@ -217,10 +218,10 @@ void VideoWidget::musicStateChanged(QMediaPlayer::State state)
 {
     if (state == QMediaPlayer::PlayingState) {
         m_progressBarSlider.setEnabled(true);
-        m_pauseBtn.setStyleSheet("image: url(:/misc/videowidget/images/pause.png);");
+        StyleSheetCache::setState(&m_pauseBtn, "playing", true);
     }
     else {
-        m_pauseBtn.setStyleSheet("image: url(:/misc/videowidget/images/play.png);");
+        StyleSheetCache::setState(&m_pauseBtn, "playing", false);
     }
 
     if (state == QMediaPlayer::StoppedState) {
@@ -232,10 +233,10 @@ void VideoWidget::musicStateChanged(QMediaPlayer::State state)
 void VideoWidget::mutedChanged(bool muted)
 {
     if (muted) {
-        m_volumeBtn.setStyleSheet("image: url(:/misc/videowidget/images/mute.png);");
+        StyleSheetCache::setState(&m_volumeBtn, "muted", true);
     }
     else {
-        m_volumeBtn.setStyleSheet("image: url(:/misc/videowidget/images/sound.png);");
+        StyleSheetCache::setState(&m_volumeBtn, "muted", false);
     }
 }
 
@@ -281,13 +282,13 @@ void VideoWidget::modeBtnClicked()
     m_playlist.setPlaybackMode(static_cast<QMediaPlaylist::PlaybackMode>(index));
 
     if (m_playlist.playbackMode() == QMediaPlaylist::CurrentItemInLoop) {
-        m_modeBtn.setStyleSheet("image: url(:/misc/videowidget/images/currentitemInloop.png);");
+        StyleSheetCache::setState(&m_modeBtn, "mode", "currentItemInLoop");
     } else if (m_playlist.playbackMode() == QMediaPlaylist::Sequential) {
-        m_modeBtn.setStyleSheet("image: url(:/misc/videowidget/images/sequential.png);");
+        StyleSheetCache::setState(&m_modeBtn, "mode", "sequential");
     } else if (m_playlist.playbackMode() == QMediaPlaylist::Loop) {
-        m_modeBtn.setStyleSheet("image: url(:/misc/videowidget/images/loop.png);");
+        StyleSheetCache::setState(&m_modeBtn, "mode", "loop");
     }  else if (m_playlist.playbackMode() == QMediaPlaylist::Random) {
-        m_modeBtn.setStyleSheet("image: url(:/misc/videowidget/images/random.png);");
+        StyleSheetCache::setState(&m_modeBtn, "mode", "random");
     }
 }
 
@@ -1,5 +1,7 @@
 #include "wareprogressbar.h"
 
+#include "frameclock/frameclock.h"
+
 #include <QFontMetrics>
 #include <QPainter>
 #include <QPainterPath>
@@ -11,28 +13,31 @@ WareProgressBar::WareProgressBar(QWidget *parent) : QWidget(parent)
 {
     setAttribute(Qt::WA_TranslucentBackground, true);
 
-    connect(&m_timer, &QTimer::timeout, this, [&]()
+    // 每 80 毫秒前进 0.6，按实际流逝的时间折算，暂停恢复后不会跳变
+    FrameClock::instance()->subscribe(this, 80, [this](qint64 elapsedMs)
     {
+        double step = 0.6 * qMin<qint64>(elapsedMs, 160) / 80;
+
         if (m_waveForwardOrientation)
         {
-            m_offset += 0.6;
+            m_offset += step;
             if (m_offset > m_radius)
                 m_offset = -m_radius;
         }
         else
         {
-            m_offset -= 0.6;
+            m_offset -= step;
             if (m_offset < -m_radius)
                 m_offset = m_radius;
         }
         update();
     });
-
-    m_timer.start(80);
 }
 
 WareProgressBar::~WareProgressBar()
-{ }
+{
+    FrameClock::instance()->unsubscribe(this);
+}
 
 void WareProgressBar::paintEvent(QPaintEvent *event)
 {
@@ -42,6 +47,9 @@ void WareProgressBar::paintEvent(QPaintEvent *event)
     painter.translate(width()/2.0, height()/2.0);
     m_radius = qMin(width(), height()) / 2.0;
 
+    if (m_spriteDirty || m_waveSprite.devicePixelRatioF() != devicePixelRatioF())
+        updateWaveSprite();
+
     drawBackground(&painter);
     if (m_peiCircleIsvisible) drawPieCircel(&painter);
     if (m_waterIsvisible)     drawWater(&painter);
@@ -50,6 +58,82 @@ void WareProgressBar::paintEvent(QPaintEvent *event)
     return QWidget::paintEvent(event);
 }
 
+void WareProgressBar::resizeEvent(QResizeEvent *event)
+{
+    m_spriteDirty = true;
+
+    return QWidget::resizeEvent(event);
+}
+
+void WareProgressBar::updateWaveSprite()
+{
+    double radius = m_radius * 0.8;
+    double w = m_waveDensity * M_PI / radius;
+    double A = radius * m_waveHeight / 40;
+    qreal dpr = devicePixelRatioF();
+
+    m_spriteDirty = false;
+
+    if (radius <= 0)
+    {
+        m_waveSprite = m_waterMask = m_waterFrame = QImage();
+        return;
+    }
+
+    m_wavePeriod = (w > 0) ? 2 * M_PI / w : 0;
+
+    int spriteWidth  = qCeil(m_wavePeriod + 2 * radius) + 2;
+    int spriteHeight = qCeil(2 * radius + 2 * A) + 2;
+
+    m_waveSprite = QImage(QSize(spriteWidth, spriteHeight) * dpr, QImage::Format_ARGB32_Premultiplied);
+    m_waveSprite.setDevicePixelRatio(dpr);
+    m_waveSprite.fill(Qt::transparent);
+
+    QPainter sprite(&m_waveSprite);
+    sprite.setRenderHint(QPainter::Antialiasing, true);
+    sprite.setPen(Qt::NoPen);
+
+    // 精灵图第 0 行为波峰所在高度；第二层水波相位超前 radius / 2，颜色更深
+    const double phases[2] = {0, radius / 2 * w};
+    const int alphas[2] = {100, 180};
+
+    for (int i=0; i<2; ++i)
+    {
+        QPainterPath wavePath;
+        wavePath.moveTo(0, spriteHeight);
+
+        for (double x=0; x<=spriteWidth; ++x)
+        {
+            wavePath.lineTo(QPointF(x, A + A * qSin(w * x + phases[i])));
+        }
+
+        wavePath.lineTo(spriteWidth, spriteHeight);
+
+        QColor watercolor = m_waterColor;
+        watercolor.setAlpha(alphas[i]);
+        sprite.setBrush(watercolor);
+        sprite.drawPath(wavePath);
+    }
+
+    sprite.end();
+
+    int size = qCeil(2 * radius);
+
+    m_waterMask = QImage(QSize(size, size) * dpr, QImage::Format_ARGB32_Premultiplied);
+    m_waterMask.setDevicePixelRatio(dpr);
+    m_waterMask.fill(Qt::transparent);
+
+    QPainter mask(&m_waterMask);
+    mask.setRenderHint(QPainter::Antialiasing, true);
+    mask.setPen(Qt::NoPen);
+    mask.setBrush(Qt::black);
+    mask.drawEllipse(QPointF(radius, radius), radius, radius);
+    mask.end();
+
+    m_waterFrame = QImage(m_waterMask.size(), QImage::Format_ARGB32_Premultiplied);
+    m_waterFrame.setDevicePixelRatio(dpr);
+}
+
 void WareProgressBar::drawPieCircel(QPainter *painter)
 {
     double pen_width = m_radius * 0.1;
@@ -90,58 +174,46 @@ void WareProgressBar::drawWater(QPainter *painter)
     double A = radius * m_waveHeight / 40;
     double k = (0.5 - percent) * radius * 2;
 
-    painter->save();
+    if (m_value == m_minValue || m_waterFrame.isNull())
+        return;
 
-    QPainterPath wavePath1;
-    QPainterPath wavePath2;
-    wavePath1.moveTo(-radius, radius);
-    wavePath2.moveTo(-radius, radius);
+    m_waterFrame.fill(Qt::transparent);
 
-    for (double x=-radius; x<=radius; ++x)
+    QPainter frame(&m_waterFrame);
+
+    if (m_value == m_maxValue)
+    {
+        QColor watercolor = m_waterColor;
+        watercolor.setAlpha(100);
+        frame.fillRect(m_waterFrame.rect(), watercolor);
+        watercolor.setAlpha(180);
+        frame.fillRect(m_waterFrame.rect(), watercolor);
+    }
+    else
     {
-        double waterY1 = 0.0;
-        double waterY2 = 0.0;
+        // 离屏图像原点在圆的左上角；水波相位 w * x + offset 折算为精灵图的水平偏移，取一个周期内的值
+        double spriteX = 0.0;
+        double spriteY = radius + k - A;
 
-        if (m_value == m_minValue)
+        if (m_wavePeriod > 0)
         {
-            waterY2 = waterY1 = radius;
-        }
-        else if (m_value == m_maxValue)
-        {
-            waterY2 = waterY1 = -radius;
+            spriteX = std::fmod(m_offset / w - radius, m_wavePeriod);
+            if (spriteX < 0)
+                spriteX += m_wavePeriod;
         }
         else
         {
-            waterY1 = (double)(A * qSin(w * x + m_offset)) + k;
-            waterY2 = (double)(A * qSin(w * x + m_offset + (radius / 2 * w))) + k;
+            spriteY += A * qSin(m_offset);
         }
 
-        wavePath1.lineTo(QPointF(x, waterY1));
-        wavePath2.lineTo(QPointF(x, waterY2));
+        frame.drawImage(QPointF(-qRound(spriteX), qRound(spriteY)), m_waveSprite);
     }
 
-    wavePath1.lineTo(radius, radius);
-    wavePath2.lineTo(radius, radius);
-
-    QPainterPath bigPath;
-    bigPath.addEllipse(QPointF(0, 0), radius, radius);
+    frame.setCompositionMode(QPainter::CompositionMode_DestinationIn);
+    frame.drawImage(0, 0, m_waterMask);
+    frame.end();
 
-    QColor watercolor1 = m_waterColor;
-    QColor watercolor2 = m_waterColor;
-
-    painter->setPen(Qt::NoPen);
-
-    QPainterPath intersectedPath = bigPath.intersected(wavePath1);
-    watercolor1.setAlpha(100);
-    painter->setBrush(watercolor1);
-    painter->drawPath(intersectedPath);
-
-    intersectedPath = bigPath.intersected(wavePath2);
-    watercolor2.setAlpha(180);
-    painter->setBrush(watercolor2);
-    painter->drawPath(intersectedPath);
-
-    painter->restore();
+    painter->drawImage(QPointF(-radius, -radius), m_waterFrame);
 }
 
 void WareProgressBar::drawText(QPainter *painter)
@@ -165,6 +237,7 @@ void WareProgressBar::setPieCircleColor(const QColor &color)
 void WareProgressBar::setwaterColor(const QColor &color)
 {
     m_waterColor = color;
+    m_spriteDirty = true;
     update();
 }
 
@@ -213,12 +286,14 @@ void WareProgressBar::setMinValue(int value)
 void WareProgressBar::setWaveDensity(int density)
 {
     m_waveDensity = density;
+    m_spriteDirty = true;
     update();
 }
 
 void WareProgressBar::setWaveHeight(int height)
 {
     m_waveHeight = height;
+    m_spriteDirty = true;
     update();
 }
 
@@ -2,8 +2,8 @@
 #define WAREPROGRESSBAR_H
 
 #include <QColor>
+#include <QImage>
 #include <QString>
-#include <QTimer>
 #include <QWidget>
 
 /* 多彩仪表盘自定义控件 实现的功能
@@ -15,6 +15,8 @@
  * 6. 可设置是否显示水纹
  * 7. 可设置进度色、水纹色、文字色
  * 8. 可设置进度条前进方向
+ * 9. 水波由全局动画时钟驱动，控件不可见时暂停
+ * 10. 两层水波预先绘制为一张周期精灵图，每帧只平移精灵图并用圆形遮罩裁剪，值变化只改变精灵图的高度
  */
 
 class WareProgressBar : public QWidget
@@ -75,6 +77,8 @@ public slots:
 
 protected:
     void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void updateWaveSprite();
     void drawPieCircel(QPainter *painter);
     void drawBackground(QPainter *painter);
     void drawWater(QPainter *painter);
@@ -99,7 +103,12 @@ private:
     bool m_peiForwardOrientation  = true;
 
     double m_offset               = 50;
-    QTimer m_timer;
+
+    QImage m_waveSprite;                            // 两层水波，宽度大于直径加一个周期，水面以下填满
+    QImage m_waterMask;                             // 水的圆形遮罩
+    QImage m_waterFrame;                            // 每帧合成水波的离屏图像
+    double m_wavePeriod           = 0;              // 水波周期，单位像素，密度为 0 时为 0
+    bool m_spriteDirty            = true;           // 尺寸、颜色、密度或高度变化后需要重新生成
 };
 
 #endif // WAREPROGRESSBAR_H
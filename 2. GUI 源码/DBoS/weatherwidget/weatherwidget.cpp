@@ -74,9 +74,26 @@ void WeatherWidget::initCtrl()
     connect(&m_airNowNetworkAccessManager, &QNetworkAccessManager::finished, this, &WeatherWidget::airNowReplyFinished);
     connect(&m_timer, &QTimer::timeout, this, &WeatherWidget::timerTimeout);
 
-    timerTimeout();
+    m_timer.setInterval(5 * 60 * 1000);
+}
+
+void WeatherWidget::showEvent(QShowEvent *event)
+{
+    QDialog::showEvent(event);
+
+    // 从预热池再次打开时，距上次更新不足一个周期则沿用已有数据
+    if (!m_lastUpdate.isValid() || m_lastUpdate.hasExpired(m_timer.interval())) {
+        timerTimeout();
+    }
 
-    m_timer.start(5 * 60 * 1000);
+    m_timer.start();
+}
+
+void WeatherWidget::hideEvent(QHideEvent *event)
+{
+    m_timer.stop();
+
+    QDialog::hideEvent(event);
 }
 
 QWidget *WeatherWidget::initCurrentWeatherUi()
@@ -203,7 +220,7 @@ QWidget *WeatherWidget::initHoursWeatherUi()
     pHourshWeather->setObjectName("weather_hourshWeather");
 
     auto pHoursChartView = new QChartView;
-    pHoursChartView->setStyleSheet("background: transparent");
+    pHoursChartView->setObjectName("weather_hoursChartView");
 
     for (int i=0; i<8; ++i) {
         m_hoursLine << QPointF(i, i*4);
@@ -313,6 +330,8 @@ QWidget *WeatherWidget::initDayWeatherUi()
 
 void WeatherWidget::timerTimeout()
 {
+    m_lastUpdate.start();
+
     m_weatherNowNetworkAccessManager.get(m_weatherNowNetWorkRequest);
 
     m_weather7DayNetworkAccessManager.get(m_weather7DayNetWorkRequest);
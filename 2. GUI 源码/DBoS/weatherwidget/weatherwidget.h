@@ -16,6 +16,7 @@
 #include <QNetworkReply>
 #include <QUrl>
 #include <QTimer>
+#include <QElapsedTimer>
 
 using namespace QtCharts;
 
@@ -40,6 +41,10 @@ class WeatherWidget : public QDialog
 public:
     explicit WeatherWidget(QWidget *parent = nullptr);
 
+protected:
+    void showEvent(QShowEvent *event);
+    void hideEvent(QHideEvent *event);
+
 private:
     void initUi();
     void initCtrl();
@@ -101,7 +106,8 @@ private:
     QNetworkRequest m_weather24HourNetWorkRequest;
     QNetworkRequest m_airNowNetWorkRequest;
 
-    QTimer m_timer;
+    QTimer m_timer;                 // 只在页面显示时运行，隐藏或预热的页面不访问网络
+    QElapsedTimer m_lastUpdate;
 };
 
 #endif // WEATHERWIDGET_H
@@ -24,86 +24,522 @@
 #include <linux/uaccess.h>
 #include <linux/version.h>
 #include <linux/i2c.h>
+#include <linux/moduleparam.h>
+#include <linux/mutex.h>
+#include <linux/poll.h>
+#include <linux/spinlock.h>
+#include <linux/timer.h>
+#include <linux/iio/iio.h>
+#include <linux/iio/buffer.h>
+#include <linux/iio/kfifo_buf.h>
+
+#define AP3216C_REG_SYS_CONFIG	0x00
+#define AP3216C_REG_INT_CLEAR	0x02
+#define AP3216C_REG_IR_DATA	0x0A	/* 0x0A~0x0F：IR、ALS、PS 数据，一次连续读出 */
+#define AP3216C_REG_ALS_THRES	0x1A	/* 0x1A~0x1D：ALS 低阈值、高阈值，16 位 */
+#define AP3216C_REG_PS_INT_MODE	0x22
+#define AP3216C_REG_PS_THRES	0x2A	/* 0x2A~0x2D：PS 低阈值、高阈值，10 位 */
+
+#define AP3216C_MODE_RESET	0x04
+#define AP3216C_MODE_ALS_PS_IR	0x03
+#define AP3216C_DATA_LEN	6
+#define AP3216C_CONVERSION_MS	120	/* ALS+PS+IR 一轮转换约 112.5 ms */
+#define AP3216C_ALS_MAX		0xFFFF
+#define AP3216C_PS_MAX		0x3FF
+#define AP3216C_READ_TIMEOUT_MS	1000	/* IIO 直接读取等待第一次采样的时间 */
+
+#define AP3216C_EVENT_ALS	0x01
+#define AP3216C_EVENT_PS	0x02
+
+/* read() 读取 24 字节时得到完整结果；读取 6 字节时只返回 data，与旧版本兼容 */
+struct ap3216c_reading {
+	unsigned short data[3];	/* ir、als（lux）、ps */
+	unsigned short events;	/* 最近一次通知的原因：AP3216C_EVENT_ALS / AP3216C_EVENT_PS */
+	u32 seq;		/* 每次通知加一，0 表示尚无结果 */
+	u32 reserved;
+	s64 timestamp_ns;	/* 最近一次采样的时刻，CLOCK_MONOTONIC */
+};
+
+/* 每个打开的文件记录已读到的序号，poll() 据此判断是否有变化 */
+struct ap3216c_file {
+	u32 seq;
+};
+
+static unsigned int sample_ms = 200;
+module_param(sample_ms, uint, 0644);
+MODULE_PARM_DESC(sample_ms, "cache refresh interval in milliseconds (>= 120)");
+
+static unsigned int als_delta = 30;
+module_param(als_delta, uint, 0644);
+MODULE_PARM_DESC(als_delta, "ALS change in raw counts (0.35 lux each) that wakes poll()");
+
+static unsigned int ps_delta = 20;
+module_param(ps_delta, uint, 0644);
+MODULE_PARM_DESC(ps_delta, "PS change in raw counts (0-1023) that wakes poll()");
 
 static struct i2c_client *ap3216c_client;
+static struct iio_dev *ap3216c_indio;
 static int ap3216c_major;
 static struct class *ap3216c_class;
 
-static ssize_t ap3216c_read (struct file *file, char __user *buf, size_t size, loff_t *offset)
+static DEFINE_MUTEX(ap3216c_lock);		/* 保护 ap3216c_users 与芯片的启停 */
+static int ap3216c_users;
+static bool ap3216c_running;
+static struct timer_list ap3216c_timer;
+static struct work_struct ap3216c_work;
+
+static DEFINE_MUTEX(ap3216c_io_lock);		/* 定时采样与中断线程互斥访问 I2C */
+static u16 ap3216c_als_low, ap3216c_als_high;	/* 当前阈值窗口，原始值 */
+static u16 ap3216c_ps_low, ap3216c_ps_high;
+
+static DEFINE_SPINLOCK(ap3216c_cache_lock);
+static struct ap3216c_reading ap3216c_cache;
+static u16 ap3216c_raw_als;			/* 缓存中的 als 已换算为 lux，IIO 返回原始值 */
+static DECLARE_WAIT_QUEUE_HEAD(ap3216c_wq);
+
+static int ap3216c_write_thres(u8 reg, u16 low, u16 high, int shift)
+{
+	/* ALS 阈值按低字节、高字节存放；PS 阈值低 2 位与高 8 位分开存放 */
+	u8 mask = shift ? 0x03 : 0xFF;
+	u8 values[4] = {
+		low & mask, low >> (shift ? 2 : 8),
+		high & mask, high >> (shift ? 2 : 8),
+	};
+	int i;
+	int ret;
+
+	for (i=0; i<4; ++i) {
+		ret = i2c_smbus_write_byte_data(ap3216c_client, reg + i, values[i]);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+/* 以当前值为中心重新设置阈值窗口，只有超出窗口的变化才会触发 INT 与通知 */
+static void ap3216c_arm(u16 als, u16 ps)
+{
+	ap3216c_als_low = (als > als_delta) ? als - als_delta : 0;
+	ap3216c_als_high = min_t(unsigned int, als + als_delta, AP3216C_ALS_MAX);
+	ap3216c_ps_low = (ps > ps_delta) ? ps - ps_delta : 0;
+	ap3216c_ps_high = min_t(unsigned int, ps + ps_delta, AP3216C_PS_MAX);
+
+	if (ap3216c_write_thres(AP3216C_REG_ALS_THRES, ap3216c_als_low, ap3216c_als_high, 0) < 0 ||
+	    ap3216c_write_thres(AP3216C_REG_PS_THRES, ap3216c_ps_low, ap3216c_ps_high, 2) < 0) {
+		printk(KERN_ERR "aoe: failed to program thresholds\n");
+	}
+}
+
+/* 一次块读取 0x0A~0x0F 更新缓存；超出阈值窗口时通知等待者并重新设置窗口 */
+static void ap3216c_sample(void)
 {
-	unsigned char  reg_buff[6];
-	unsigned short convert_buff[3];
+	u8 regs[AP3216C_DATA_LEN];
+	u16 ir, als, ps;
+	unsigned short events = 0;
+	bool notify;
+	s64 timestamp_ns;
+	int ret;
+
+	mutex_lock(&ap3216c_io_lock);
+
+	ret = i2c_smbus_read_i2c_block_data(ap3216c_client, AP3216C_REG_IR_DATA, sizeof(regs), regs);
+	timestamp_ns = ktime_get_ns();
+	if (ret != sizeof(regs)) {
+		mutex_unlock(&ap3216c_io_lock);
+		printk(KERN_ERR "aoe: block read failed: %d\n", ret);
+		return;
+	}
 
-	if (size != 6)
-		return -EINVAL;
+	// ir 红外值，溢出时无效
+	ir = (regs[0] & 0x80) ? 0 : ((regs[1] << 2) | (regs[0] & 0x03));
 
-	reg_buff[0] = i2c_smbus_read_byte_data(ap3216c_client, 0xA);
-	reg_buff[1] = i2c_smbus_read_byte_data(ap3216c_client, 0xB);
+	// als 光强
+	als = (regs[3] << 8) | regs[2];
 
-	reg_buff[2] = i2c_smbus_read_byte_data(ap3216c_client, 0xC);
-	reg_buff[3] = i2c_smbus_read_byte_data(ap3216c_client, 0xD);
+	// ps 距离，红外过强时无效
+	ps = (regs[5] & 0x40) ? 0 : (((regs[5] & 0x3F) << 4) | (regs[4] & 0x0F));
 
-	reg_buff[4] = i2c_smbus_read_byte_data(ap3216c_client, 0xE);
-	reg_buff[5] = i2c_smbus_read_byte_data(ap3216c_client, 0xF);
+	if (als < ap3216c_als_low || als > ap3216c_als_high) {
+		events |= AP3216C_EVENT_ALS;
+	}
+	if (ps < ap3216c_ps_low || ps > ap3216c_ps_high) {
+		events |= AP3216C_EVENT_PS;
+	}
 
-	// ir 红外值
-	if (reg_buff[0] & 0x80)  
-		convert_buff[0] = 0;
-	else
-		convert_buff[0] = (unsigned short)((reg_buff[1] << 2)|(reg_buff[0] & 0x03));
+	spin_lock(&ap3216c_cache_lock);
+	ap3216c_raw_als = als;
+	ap3216c_cache.data[0] = ir;
+	ap3216c_cache.data[1] = (unsigned short)(als * 35 / 100);
+	ap3216c_cache.data[2] = ps;
+	ap3216c_cache.timestamp_ns = timestamp_ns;
+	notify = (events != 0) || (ap3216c_cache.seq == 0);	/* 窗口内的变化只刷新缓存 */
+	if (notify) {
+		ap3216c_cache.events = events;
+		if (++ap3216c_cache.seq == 0) {
+			ap3216c_cache.seq = 1;
+		}
+	}
+	spin_unlock(&ap3216c_cache_lock);
+
+	if (notify) {
+		ap3216c_arm(als, ps);
+		wake_up_interruptible(&ap3216c_wq);
+
+		/* IIO 缓冲区与 poll() 一致，只记录超出阈值窗口的样本 */
+		if (ap3216c_indio && iio_buffer_enabled(ap3216c_indio)) {
+			struct {
+				u16 channels[3];	/* ir、als、ps，原始值 */
+				u16 reserved;
+				s64 timestamp;
+			} scan = { { ir, als, ps }, 0, 0 };
+
+			iio_push_to_buffers_with_timestamp(ap3216c_indio, &scan, timestamp_ns);
+		}
+	}
 
-	// als  光强
-	convert_buff[1] = (unsigned short)(((reg_buff[3] << 8) | reg_buff[2]) * 35 / 100);
+	mutex_unlock(&ap3216c_io_lock);
+}
 
-	// ps 距离
-	if(reg_buff[5] & 0x40)
-		convert_buff[2]=0;
-	else
-		convert_buff[2]= (unsigned short)(((reg_buff[5] & 0x3F) << 4) | (reg_buff[4] & 0x0F));
+static void ap3216c_work_func(struct work_struct *work)
+{
+	ap3216c_sample();
+
+	if (READ_ONCE(ap3216c_running)) {
+		mod_timer(&ap3216c_timer, jiffies + msecs_to_jiffies(max_t(unsigned int, sample_ms, AP3216C_CONVERSION_MS)));
+	}
+}
 
-	if (copy_to_user(buf, convert_buff, size))
+static void ap3216c_timer_func(unsigned long data)
+{
+	schedule_work(&ap3216c_work);
+}
+
+/* INT 引脚：亮度或距离超出阈值窗口，读取数据寄存器即清除中断 */
+static irqreturn_t ap3216c_irq_thread(int irq, void *dev_id)
+{
+	if (READ_ONCE(ap3216c_running)) {
+		ap3216c_sample();
+	}
+
+	return IRQ_HANDLED;
+}
+
+static void ap3216c_stop(void)
+{
+	WRITE_ONCE(ap3216c_running, false);
+
+	/* 工作函数可能在检查标志之前重新启动了定时器，取消后再删除一次 */
+	del_timer_sync(&ap3216c_timer);
+	cancel_work_sync(&ap3216c_work);
+	del_timer_sync(&ap3216c_timer);
+}
+
+static u32 ap3216c_cache_seq(void)
+{
+	u32 seq;
+
+	spin_lock(&ap3216c_cache_lock);
+	seq = ap3216c_cache.seq;
+	spin_unlock(&ap3216c_cache_lock);
+
+	return seq;
+}
+
+/* 直接返回缓存的结果，不访问 I2C；尚无结果时阻塞等待或返回 -EAGAIN */
+static ssize_t ap3216c_read (struct file *file, char __user *buf, size_t size, loff_t *offset)
+{
+	int ret;
+	struct ap3216c_file *priv = file->private_data;
+	struct ap3216c_reading reading;
+	size_t len = (size >= sizeof(reading)) ? sizeof(reading) : min_t(size_t, size, sizeof(reading.data));
+
+	if (ap3216c_cache_seq() == 0) {
+		if (file->f_flags & O_NONBLOCK) {
+			return -EAGAIN;
+		}
+		if (wait_event_interruptible(ap3216c_wq, ap3216c_cache_seq() != 0)) {
+			return -ERESTARTSYS;
+		}
+	}
+
+	spin_lock(&ap3216c_cache_lock);
+	reading = ap3216c_cache;
+	spin_unlock(&ap3216c_cache_lock);
+
+	priv->seq = reading.seq;
+
+	if (copy_to_user(buf, &reading, len))
 		return -EFAULT;
 	
-	return size;
+	return len;
 }
 
+static unsigned int ap3216c_poll(struct file *file, poll_table *wait)
+{
+	struct ap3216c_file *priv = file->private_data;
 
-static int ap3216c_open (struct inode *inode, struct file *file)
+	poll_wait(file, &ap3216c_wq, wait);
+
+	return (ap3216c_cache_seq() != priv->seq) ? (POLLIN | POLLRDNORM) : 0;
+}
+
+static int ap3216c_start(void)
 {
-	if (i2c_smbus_write_byte_data(ap3216c_client, 0x00, 0x04) < 0)
-		return ENXIO;
-	
-	schedule_timeout(msecs_to_jiffies(15));
-	
-	if (i2c_smbus_write_byte_data(ap3216c_client, 0x00, 0x03) < 0)
-		return ENXIO;
+	int ret;
 
-	schedule_timeout(msecs_to_jiffies(15));
+	if (i2c_smbus_write_byte_data(ap3216c_client, AP3216C_REG_SYS_CONFIG, AP3216C_MODE_RESET) < 0)
+		return -ENXIO;
 	
+	msleep(15);
+
+	/* 读取数据寄存器即清除中断；PS 使用窗口模式，与 ALS 一致 */
+	if (i2c_smbus_write_byte_data(ap3216c_client, AP3216C_REG_INT_CLEAR, 0x00) < 0 ||
+	    i2c_smbus_write_byte_data(ap3216c_client, AP3216C_REG_PS_INT_MODE, 0x00) < 0)
+		return -ENXIO;
+
+	/* 第一次采样之前不产生中断 */
+	mutex_lock(&ap3216c_io_lock);
+	ap3216c_als_low = 0;
+	ap3216c_als_high = AP3216C_ALS_MAX;
+	ap3216c_ps_low = 0;
+	ap3216c_ps_high = AP3216C_PS_MAX;
+	ret = ap3216c_write_thres(AP3216C_REG_ALS_THRES, 0, AP3216C_ALS_MAX, 0);
+	if (ret == 0) {
+		ret = ap3216c_write_thres(AP3216C_REG_PS_THRES, 0, AP3216C_PS_MAX, 2);
+	}
+	mutex_unlock(&ap3216c_io_lock);
+	if (ret < 0)
+		return -ENXIO;
+
+	if (i2c_smbus_write_byte_data(ap3216c_client, AP3216C_REG_SYS_CONFIG, AP3216C_MODE_ALS_PS_IR) < 0)
+		return -ENXIO;
+
+	spin_lock(&ap3216c_cache_lock);
+	memset(&ap3216c_cache, 0, sizeof(ap3216c_cache));
+	spin_unlock(&ap3216c_cache_lock);
+
+	/* 等第一轮转换完成后再采样 */
+	WRITE_ONCE(ap3216c_running, true);
+	mod_timer(&ap3216c_timer, jiffies + msecs_to_jiffies(AP3216C_CONVERSION_MS));
+
+	return 0;
+}
+
+/* 设备文件与 IIO 缓冲区都算作使用者，第一个使用者启动芯片，最后一个复位芯片 */
+static int ap3216c_get(void)
+{
+	int ret = 0;
+
+	mutex_lock(&ap3216c_lock);
+	if (ap3216c_users == 0) {
+		ret = ap3216c_start();
+	}
+	if (ret == 0) {
+		++ap3216c_users;
+	}
+	mutex_unlock(&ap3216c_lock);
+
+	return ret;
+}
+
+static void ap3216c_put(void)
+{
+	mutex_lock(&ap3216c_lock);
+	if (--ap3216c_users == 0) {
+		ap3216c_stop();
+		i2c_smbus_write_byte_data(ap3216c_client, AP3216C_REG_SYS_CONFIG, AP3216C_MODE_RESET);
+	}
+	mutex_unlock(&ap3216c_lock);
+}
+
+static int ap3216c_open (struct inode *inode, struct file *file)
+{
+	int ret;
+	struct ap3216c_file *priv;
+
+	priv = kzalloc(sizeof(*priv), GFP_KERNEL);
+	if (!priv) {
+		return -ENOMEM;
+	}
+
+	ret = ap3216c_get();
+	if (ret) {
+		kfree(priv);
+		return ret;
+	}
+
+	/* 第一次打开时缓存已清空；其他文件打开时只有之后的变化才算新数据 */
+	priv->seq = ap3216c_cache_seq();
+	file->private_data = priv;
+
 	return 0;
 }
 
 static int ap3216c_release (struct inode *inode, struct file *file)
 {
-	if (i2c_smbus_write_byte_data(ap3216c_client, 0x00, 0x04) < 0)
-		return ENXIO;
-	
+	ap3216c_put();
+
+	kfree(file->private_data);
+
 	return 0;
 }
 
 static const struct file_operations ap3216c_fops = {
 	.owner   = THIS_MODULE,
 	.read    = ap3216c_read,
+	.poll    = ap3216c_poll,
 	.open    = ap3216c_open,
 	.release = ap3216c_release
 };
 
+/* IIO 接口：红外、光强、接近三个通道均为原始值，光强乘以 scale 得到 lux
+ * 时间戳为块读取完成的时刻，CLOCK_MONOTONIC；缓冲区只记录超出阈值窗口的样本
+ */
+static const struct iio_chan_spec ap3216c_channels[] = {
+	{
+		.type = IIO_INTENSITY,
+		.modified = 1,
+		.channel2 = IIO_MOD_LIGHT_IR,
+		.info_mask_separate = BIT(IIO_CHAN_INFO_RAW),
+		.scan_index = 0,
+		.scan_type = { .sign = 'u', .realbits = 10, .storagebits = 16, .endianness = IIO_CPU },
+	},
+	{
+		.type = IIO_LIGHT,
+		.info_mask_separate = BIT(IIO_CHAN_INFO_RAW) | BIT(IIO_CHAN_INFO_SCALE),
+		.scan_index = 1,
+		.scan_type = { .sign = 'u', .realbits = 16, .storagebits = 16, .endianness = IIO_CPU },
+	},
+	{
+		.type = IIO_PROXIMITY,
+		.info_mask_separate = BIT(IIO_CHAN_INFO_RAW),
+		.scan_index = 2,
+		.scan_type = { .sign = 'u', .realbits = 10, .storagebits = 16, .endianness = IIO_CPU },
+	},
+	IIO_CHAN_SOFT_TIMESTAMP(3),
+};
+
+/* 每次推入全部通道，只打开部分通道时由 IIO 核心挑选 */
+static const unsigned long ap3216c_scan_masks[] = { 0x7, 0 };
+
+/* 直接读取：没有使用者时临时启动芯片，等待第一次采样 */
+static int ap3216c_read_raw(struct iio_dev *indio_dev, struct iio_chan_spec const *chan, int *val, int *val2, long mask)
+{
+	long ret;
+
+	switch (mask) {
+	case IIO_CHAN_INFO_RAW:
+		ret = ap3216c_get();
+		if (ret) {
+			return ret;
+		}
+		ret = wait_event_interruptible_timeout(ap3216c_wq, ap3216c_cache_seq() != 0, msecs_to_jiffies(AP3216C_READ_TIMEOUT_MS));
+		if (ret > 0) {
+			spin_lock(&ap3216c_cache_lock);
+			if (chan->type == IIO_INTENSITY) {
+				*val = ap3216c_cache.data[0];
+			}
+			else if (chan->type == IIO_LIGHT) {
+				*val = ap3216c_raw_als;
+			}
+			else {
+				*val = ap3216c_cache.data[2];
+			}
+			spin_unlock(&ap3216c_cache_lock);
+		}
+		ap3216c_put();
+
+		if (ret < 0) {
+			return ret;
+		}
+		return (ret == 0) ? -ETIMEDOUT : IIO_VAL_INT;
+
+	case IIO_CHAN_INFO_SCALE:
+		*val = 0;
+		*val2 = 350000;
+		return IIO_VAL_INT_PLUS_MICRO;
+	}
+
+	return -EINVAL;
+}
+
+static const struct iio_info ap3216c_iio_info = {
+	.driver_module = THIS_MODULE,
+	.read_raw = ap3216c_read_raw,
+};
+
+static int ap3216c_buffer_postenable(struct iio_dev *indio_dev)
+{
+	return ap3216c_get();
+}
+
+static int ap3216c_buffer_predisable(struct iio_dev *indio_dev)
+{
+	ap3216c_put();
+
+	return 0;
+}
+
+static const struct iio_buffer_setup_ops ap3216c_buffer_ops = {
+	.postenable = ap3216c_buffer_postenable,
+	.predisable = ap3216c_buffer_predisable,
+};
+
+static int ap3216c_iio_register(struct device *parent)
+{
+	struct iio_dev *indio_dev;
+	struct iio_buffer *buffer;
+	int ret;
+
+	indio_dev = devm_iio_device_alloc(parent, 0);
+	if (!indio_dev) {
+		return -ENOMEM;
+	}
+
+	buffer = devm_iio_kfifo_allocate(parent);
+	if (!buffer) {
+		return -ENOMEM;
+	}
+
+	indio_dev->name = "ap3216c";
+	indio_dev->dev.parent = parent;
+	indio_dev->info = &ap3216c_iio_info;
+	indio_dev->modes = INDIO_DIRECT_MODE | INDIO_BUFFER_SOFTWARE;
+	indio_dev->channels = ap3216c_channels;
+	indio_dev->num_channels = ARRAY_SIZE(ap3216c_channels);
+	indio_dev->available_scan_masks = ap3216c_scan_masks;
+	indio_dev->setup_ops = &ap3216c_buffer_ops;
+	iio_device_attach_buffer(indio_dev, buffer);
+
+	ret = iio_device_register(indio_dev);
+	if (ret) {
+		return ret;
+	}
+
+	ap3216c_indio = indio_dev;
+
+	return 0;
+}
+
 static int ap3216c_probe(struct i2c_client *client, const struct i2c_device_id *id)
 {
 	struct device *dev;
+	int ret;
 
 	ap3216c_client = client;
 
+	/* 设备树中描述了 INT 引脚时由中断通知变化，否则只靠定时采样比较阈值窗口 */
+	if (client->irq > 0) {
+		ret = devm_request_threaded_irq(&client->dev, client->irq, NULL, ap3216c_irq_thread,
+						IRQF_ONESHOT, "ap3216c_irq", NULL);
+		if (ret) {
+			printk(KERN_ERR "aoe: failed to request irq\n");
+			return ret;
+		}
+	}
+
 	ap3216c_major = register_chrdev(0, "ap3216c", &ap3216c_fops);
 	if (ap3216c_major < 0) {
 		return ap3216c_major;
@@ -122,11 +558,23 @@ static int ap3216c_probe(struct i2c_client *client, const struct i2c_device_id *
 		return PTR_ERR(dev);
 	}
 
+	ret = ap3216c_iio_register(&client->dev);
+	if (ret) {
+		device_destroy(ap3216c_class, MKDEV(ap3216c_major, 0));
+		class_destroy(ap3216c_class);
+		unregister_chrdev(ap3216c_major, "ap3216c");
+		return ret;
+	}
+
 	return 0;
 }	
 
 static int ap3216c_remove(struct i2c_client *client)
 {
+	/* 注销时 IIO 核心关闭缓冲区，释放其对芯片的引用 */
+	iio_device_unregister(ap3216c_indio);
+	ap3216c_indio = NULL;
+
 	device_destroy(ap3216c_class, MKDEV(ap3216c_major, 0));
 
 	class_destroy(ap3216c_class);
@@ -157,6 +605,9 @@ static struct i2c_driver ap3216c_driver = {
 
 static int __init ap3216c_init(void)
 {
+	INIT_WORK(&ap3216c_work, ap3216c_work_func);
+	setup_timer(&ap3216c_timer, ap3216c_timer_func, 0);
+
 	return i2c_add_driver(&ap3216c_driver);
 }
 
@@ -23,40 +23,359 @@
 #include <linux/spinlock.h>
 #include <asm/uaccess.h>
 #include <linux/spi/spi.h>
+#include <linux/hrtimer.h>
+#include <linux/kfifo.h>
+#include <linux/math64.h>
+#include <linux/mutex.h>
+#include <linux/poll.h>
+
+#define DAC_VALUE_MAX		1023		/* TLC5615，10 位 */
+#define DAC_RATE_MAX_HZ		20000
+#define DAC_FIFO_SIZE		4096		/* 样本数，20 kHz 时约 200 ms */
+
+#define DAC_MODE_STATIC		0		/* write() 2 字节立即输出，与旧版本兼容 */
+#define DAC_MODE_STREAM		1		/* write() 的样本进入队列，由定时器按固定速率输出 */
+#define DAC_MODE_WAVE		2		/* 定时器按相位累加器生成波形 */
+
+#define DAC_WAVE_SINE		0
+#define DAC_WAVE_SQUARE		1
+#define DAC_WAVE_TRIANGLE	2
+#define DAC_WAVE_SAWTOOTH	3
+
+/* 输出 offset ± amplitude 之间的波形，超出 0-1023 的部分被截掉 */
+struct dac_wave {
+	u32 shape;		/* DAC_WAVE_* */
+	u32 freq_mhz;		/* 频率，毫赫兹，须小于 rate_hz 的一半 */
+	u32 rate_hz;		/* 采样率，1-20000 */
+	u16 amplitude;		/* 峰值，0-1023 */
+	u16 offset;		/* 中心值，0-1023 */
+};
+
+struct dac_stats {
+	u32 underruns;		/* 流模式下队列为空的采样周期数 */
+	u32 late;		/* 上一次 SPI 传输尚未完成而推迟的采样周期数 */
+};
+
+#define DAC_IOC_MAGIC		'D'
+#define DAC_IOC_STREAM		_IOW(DAC_IOC_MAGIC, 0, u32)	/* 参数为采样率，1-20000 Hz */
+#define DAC_IOC_WAVE		_IOW(DAC_IOC_MAGIC, 1, struct dac_wave)
+#define DAC_IOC_STOP		_IO(DAC_IOC_MAGIC, 2)		/* 回到 DAC_MODE_STATIC，保持最后的输出 */
+#define DAC_IOC_STATS		_IOR(DAC_IOC_MAGIC, 3, struct dac_stats)
 
 static unsigned int dac_major;
 static struct class *dac_class;
 static struct spi_device *dac_spi;
 
+static DEFINE_MUTEX(dac_lock);		/* 保护 dac_mode 的切换与同步 SPI 传输 */
+static int dac_mode = DAC_MODE_STATIC;
+static struct hrtimer dac_timer;
+static ktime_t dac_period;
+static DECLARE_WAIT_QUEUE_HEAD(dac_wq);
+static DEFINE_KFIFO(dac_fifo, u16, DAC_FIFO_SIZE);
+
+/* 定时器中不能睡眠，用 spi_async 发送；同一时刻最多一个传输 */
+static struct spi_message dac_msg;
+static struct spi_transfer dac_xfer;
+static unsigned char *dac_tx;		/* 2 字节，SPI 传输需要可 DMA 的内存 */
+static atomic_t dac_busy = ATOMIC_INIT(0);
+
+/* 波形模式下 ioctl 直接修改参数，dac_wave_lock 保证定时器不会读到一半新一半旧的参数 */
+static DEFINE_SPINLOCK(dac_wave_lock);
+static struct dac_wave dac_wave_cfg;
+static u32 dac_phase;			/* 只在定时器中修改 */
+static u32 dac_phase_step;
+static struct dac_stats dac_stats;
+
+/* 四分之一周期的正弦表，sin(i * 90° / 64) * 32767 */
+static const s16 dac_sine_quarter[65] = {
+	0, 804, 1608, 2410, 3212, 4011, 4808, 5602, 6393, 7179, 7962, 8739, 9512, 10278, 11039, 11793,
+	12539, 13279, 14010, 14732, 15446, 16151, 16846, 17530, 18204, 18868, 19519, 20159, 20787, 21403, 22005, 22594,
+	23170, 23731, 24279, 24811, 25329, 25832, 26319, 26790, 27245, 27683, 28105, 28510, 28898, 29268, 29621, 29956,
+	30273, 30571, 30852, 31113, 31356, 31580, 31785, 31971, 32137, 32285, 32412, 32521, 32609, 32678, 32728, 32757,
+	32767
+};
+
+static void dac_encode(unsigned char *buf, unsigned short val)
+{
+	val <<= 2;
+	val = val & 0x0FFF;
+
+	buf[0] = val >> 8;
+	buf[1] = val;
+}
+
+static void dac_complete(void *context)
+{
+	atomic_set(&dac_busy, 0);
+	wake_up(&dac_wq);
+}
+
+static void dac_send_async(unsigned short val)
+{
+	dac_encode(dac_tx, val);
+
+	spi_message_init(&dac_msg);
+	dac_msg.complete = dac_complete;
+	spi_message_add_tail(&dac_xfer, &dac_msg);
+
+	if (spi_async(dac_spi, &dac_msg)) {
+		atomic_set(&dac_busy, 0);
+	}
+}
+
+/* 相位的高 8 位为一个周期内的位置，返回 -32767 ~ 32767 */
+static int dac_wave_point(u32 shape, u32 phase)
+{
+	unsigned int index = phase >> 24;
+	int t = phase >> 16;
+
+	switch (shape) {
+	case DAC_WAVE_SQUARE:
+		return (phase < 0x80000000U) ? 32767 : -32767;
+	case DAC_WAVE_TRIANGLE:
+		return (t < 32768) ? t * 2 - 32767 : (65535 - t) * 2 - 32767;
+	case DAC_WAVE_SAWTOOTH:
+		return t - 32768;
+	}
+
+	switch (index >> 6) {
+	case 0: return dac_sine_quarter[index & 63];
+	case 1: return dac_sine_quarter[64 - (index & 63)];
+	case 2: return -dac_sine_quarter[index & 63];
+	default: return -dac_sine_quarter[64 - (index & 63)];
+	}
+}
+
+static enum hrtimer_restart dac_timer_func(struct hrtimer *timer)
+{
+	u16 val;
+	int point;
+
+	spin_lock(&dac_wave_lock);
+	hrtimer_forward_now(timer, dac_period);
+	spin_unlock(&dac_wave_lock);
+
+	if (atomic_xchg(&dac_busy, 1)) {
+		++dac_stats.late;
+		return HRTIMER_RESTART;
+	}
+
+	if (dac_mode == DAC_MODE_STREAM) {
+		/* 单生产者单消费者，无需加锁 */
+		if (!kfifo_get(&dac_fifo, &val)) {
+			atomic_set(&dac_busy, 0);
+			++dac_stats.underruns;
+			return HRTIMER_RESTART;
+		}
+		wake_up_interruptible(&dac_wq);
+	}
+	else {
+		spin_lock(&dac_wave_lock);
+		point = dac_wave_point(dac_wave_cfg.shape, dac_phase);
+		point = dac_wave_cfg.offset + point * dac_wave_cfg.amplitude / 32767;
+		dac_phase += dac_phase_step;
+		spin_unlock(&dac_wave_lock);
+
+		val = clamp_t(int, point, 0, DAC_VALUE_MAX);
+	}
+
+	dac_send_async(val);
+
+	return HRTIMER_RESTART;
+}
+
+/* 停止定时器并等待最后一次传输完成，调用者持有 dac_lock */
+static void dac_stop_locked(void)
+{
+	if (dac_mode == DAC_MODE_STATIC)
+		return;
+
+	hrtimer_cancel(&dac_timer);
+	wait_event(dac_wq, atomic_read(&dac_busy) == 0);
+
+	dac_mode = DAC_MODE_STATIC;
+	wake_up_interruptible(&dac_wq);
+}
+
+static void dac_start_locked(int mode, u32 rate_hz)
+{
+	dac_stop_locked();
+
+	memset(&dac_stats, 0, sizeof(dac_stats));
+	dac_period = ns_to_ktime(div_u64(NSEC_PER_SEC, rate_hz));
+	dac_mode = mode;
+
+	hrtimer_start(&dac_timer, dac_period, HRTIMER_MODE_REL);
+}
+
 ssize_t dac_write (struct file *file, const char __user *user, size_t size, loff_t *offset)
 {
 	unsigned char ker_buf[2];
 	unsigned short val;
-	
+	unsigned int copied = 0;
+	int ret;
+
+	if (mutex_lock_interruptible(&dac_lock)) {
+		return -ERESTARTSYS;
+	}
+
+	if (dac_mode == DAC_MODE_STREAM) {
+		mutex_unlock(&dac_lock);
+
+		if (size < 2) {
+			return -EINVAL;
+		}
+
+		if (kfifo_is_full(&dac_fifo)) {
+			if (file->f_flags & O_NONBLOCK) {
+				return -EAGAIN;
+			}
+			if (wait_event_interruptible(dac_wq, !kfifo_is_full(&dac_fifo) || dac_mode != DAC_MODE_STREAM)) {
+				return -ERESTARTSYS;
+			}
+		}
+
+		/* 只有一个写者时无需加锁；队列剩余空间不足时只写入一部分 */
+		ret = kfifo_from_user(&dac_fifo, user, size - size % 2, &copied);
+
+		return ret ? ret : copied;
+	}
+
+	if (dac_mode == DAC_MODE_WAVE) {
+		mutex_unlock(&dac_lock);
+		return -EBUSY;
+	}
+
 	if (size != 2) {
+		mutex_unlock(&dac_lock);
 		return -EINVAL;
 	}
 
 	if (copy_from_user(&val, user, 2)) {
+		mutex_unlock(&dac_lock);
 		return -EFAULT;
 	}
 
-	val <<= 2;
-	val = val & 0x0FFF;
-	
-	ker_buf[0] = val >> 8;
-	ker_buf[1] = val;
-	
-	if (spi_write(dac_spi, ker_buf, 2)) {
-		return EIO;
+	dac_encode(ker_buf, val);
+
+	ret = spi_write(dac_spi, ker_buf, 2);
+
+	mutex_unlock(&dac_lock);
+
+	return ret ? -EIO : 2;
+}
+
+static unsigned int dac_poll(struct file *file, poll_table *wait)
+{
+	poll_wait(file, &dac_wq, wait);
+
+	/* 波形模式下 write() 返回 -EBUSY，不报告可写，回到其他模式时 dac_wq 会被唤醒 */
+	if (dac_mode == DAC_MODE_WAVE) {
+		return 0;
+	}
+
+	if (dac_mode == DAC_MODE_STREAM && kfifo_is_full(&dac_fifo)) {
+		return 0;
+	}
+
+	return POLLOUT | POLLWRNORM;
+}
+
+static long dac_ioctl (struct file *file, unsigned int cmd, unsigned long arg)
+{
+	struct dac_wave wave;
+	struct dac_stats stats;
+	unsigned long flags;
+	u32 phase_step;
+	u32 rate_hz;
+
+	switch (cmd) {
+	case DAC_IOC_STREAM:
+		if (get_user(rate_hz, (u32 __user *)arg))
+			return -EFAULT;
+
+		if (rate_hz == 0 || rate_hz > DAC_RATE_MAX_HZ)
+			return -EINVAL;
+
+		mutex_lock(&dac_lock);
+		dac_stop_locked();
+		kfifo_reset(&dac_fifo);
+		dac_start_locked(DAC_MODE_STREAM, rate_hz);
+		mutex_unlock(&dac_lock);
+
+		return 0;
+
+	case DAC_IOC_WAVE:
+		if (copy_from_user(&wave, (void __user *)arg, sizeof(wave)))
+			return -EFAULT;
+
+		if (wave.shape > DAC_WAVE_SAWTOOTH || wave.rate_hz == 0 || wave.rate_hz > DAC_RATE_MAX_HZ ||
+		    (u64)wave.freq_mhz * 2 >= (u64)wave.rate_hz * 1000 ||
+		    wave.amplitude > DAC_VALUE_MAX || wave.offset > DAC_VALUE_MAX) {
+			return -EINVAL;
+		}
+
+		/* 每个采样周期的相位增量：freq / rate * 2^32 */
+		phase_step = (u32)div_u64((u64)wave.freq_mhz << 32, wave.rate_hz * 1000);
+
+		mutex_lock(&dac_lock);
+		if (dac_mode == DAC_MODE_WAVE) {
+			/* 已在输出波形时原地替换参数，保留相位和运行中的定时器，拖动滑块时输出保持连续 */
+			rate_hz = dac_wave_cfg.rate_hz;
+
+			spin_lock_irqsave(&dac_wave_lock, flags);
+			dac_wave_cfg = wave;
+			dac_phase_step = phase_step;
+			if (wave.rate_hz != rate_hz)
+				dac_period = ns_to_ktime(div_u64(NSEC_PER_SEC, wave.rate_hz));
+			spin_unlock_irqrestore(&dac_wave_lock, flags);
+
+			/* 只有采样率变化时才重新设定定时器 */
+			if (wave.rate_hz != rate_hz)
+				hrtimer_start(&dac_timer, dac_period, HRTIMER_MODE_REL);
+		}
+		else {
+			dac_stop_locked();
+			dac_wave_cfg = wave;
+			dac_phase = 0;
+			dac_phase_step = phase_step;
+			dac_start_locked(DAC_MODE_WAVE, wave.rate_hz);
+		}
+		mutex_unlock(&dac_lock);
+
+		return 0;
+
+	case DAC_IOC_STOP:
+		mutex_lock(&dac_lock);
+		dac_stop_locked();
+		mutex_unlock(&dac_lock);
+
+		return 0;
+
+	case DAC_IOC_STATS:
+		stats = dac_stats;
+
+		return copy_to_user((void __user *)arg, &stats, sizeof(stats)) ? -EFAULT : 0;
 	}
 
-	return 2;
+	return -ENOTTY;
+}
+
+static int dac_release (struct inode *inode, struct file *file)
+{
+	mutex_lock(&dac_lock);
+	dac_stop_locked();
+	mutex_unlock(&dac_lock);
+
+	return 0;
 }
 
 struct file_operations dac_fops = {
 	.owner = THIS_MODULE,
-	.write = dac_write
+	.write = dac_write,
+	.poll = dac_poll,
+	.unlocked_ioctl = dac_ioctl,
+	.release = dac_release
 };
 
 static int dac_spi_probe(struct spi_device *spi)
@@ -65,14 +384,24 @@ static int dac_spi_probe(struct spi_device *spi)
 
 	dac_spi = spi;
 
+	dac_tx = kzalloc(2, GFP_KERNEL);
+	if (!dac_tx) {
+		return -ENOMEM;
+	}
+
+	dac_xfer.tx_buf = dac_tx;
+	dac_xfer.len = 2;
+
 	dac_major = register_chrdev(0, "dac", &dac_fops);
 	if (dac_major < 0) {
+		kfree(dac_tx);
 		return dac_major;
 	}
 
 	dac_class = class_create(THIS_MODULE, "dac_class");
  	if (IS_ERR(dac_class)) {
 		unregister_chrdev(dac_major, "dac");
+		kfree(dac_tx);
 		return PTR_ERR(dac_class);
 	}
 
@@ -80,6 +409,7 @@ static int dac_spi_probe(struct spi_device *spi)
 	if (IS_ERR(dev)) {
 		class_destroy(dac_class);
 		unregister_chrdev(dac_major, "dac");
+		kfree(dac_tx);
 		return PTR_ERR(dev);
 	}
 
@@ -94,6 +424,8 @@ static int dac_spi_remove(struct spi_device *spi)
 
 	unregister_chrdev(dac_major, "dac");
 
+	kfree(dac_tx);
+
 	return 0;
 }
 
@@ -120,6 +452,9 @@ static struct spi_driver dac_driver = {
 
 static int __init dac_init(void)
 {
+	hrtimer_init(&dac_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	dac_timer.function = dac_timer_func;
+
 	return spi_register_driver(&dac_driver);
 }
 
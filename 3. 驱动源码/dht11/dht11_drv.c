@@ -21,172 +21,463 @@
 #include <linux/uaccess.h>
 #include <linux/interrupt.h>
 #include <linux/math64.h>
+#include <linux/mutex.h>
+#include <linux/completion.h>
+#include <linux/moduleparam.h>
+#include <linux/poll.h>
+#include <linux/spinlock.h>
+#include <linux/timer.h>
 #include <linux/uaccess.h>
+#include <linux/iio/iio.h>
+#include <linux/iio/buffer.h>
+#include <linux/iio/kfifo_buf.h>
+
+#define DHT11_START_US_MIN		18000	/* 主机起始信号至少 18 ms */
+#define DHT11_START_US_MAX		20000
+#define DHT11_TIMEOUT_MS		20	/* 一次传输约 4~5.5 ms */
+#define DHT11_BITS_PER_READ		40
+#define DHT11_EDGES_PER_READ		(2 * DHT11_BITS_PER_READ + 4)	/* 应答低、应答高、40 位、结束 */
+#define DHT11_EDGES_MAX			(DHT11_EDGES_PER_READ + 8)
+#define DHT11_BIT_THRESHOLD_NS		50000	/* 高电平 26~28 us 为 0，70 us 为 1 */
+#define DHT11_INTERVAL_MIN_MS		1000	/* 两次采样间隔不能小于 1 s */
+#define DHT11_RETRY_MS			200
+#define DHT11_READ_TIMEOUT_MS		2000	/* IIO 直接读取等待新结果的时间，包含重试 */
+
+struct dht11_edge {
+	u64 ts;
+	int value;
+};
+
+/* read() 读取 16 字节时得到完整结果；读取 4 字节时只返回 data，与旧版本兼容 */
+struct dht11_reading {
+	unsigned char data[4];	/* 湿度整数、湿度小数、温度整数、温度小数 */
+	u32 seq;		/* 每次成功采样加一，0 表示尚无结果 */
+	s64 timestamp_ns;	/* 采样时刻，CLOCK_MONOTONIC */
+};
+
+/* 每个打开的文件记录已读到的序号，poll() 据此判断是否有新数据 */
+struct dht11_file {
+	u32 seq;
+};
+
+static unsigned int sample_ms = 1500;
+module_param(sample_ms, uint, 0644);
+MODULE_PARM_DESC(sample_ms, "sampling interval in milliseconds (>= 1000)");
+
+static unsigned int retries = 2;
+module_param(retries, uint, 0644);
+MODULE_PARM_DESC(retries, "retries after a failed transfer before giving up until the next interval");
 
 static int dht11_major;
 static struct class *dht11_class;
 static struct gpio_desc *dht11_gpio;
+static int dht11_irq;
+static struct iio_dev *dht11_indio;
 
-static void dht11_reset(void)
-{
-	gpiod_direction_output(dht11_gpio, 1);
-}
+static DEFINE_MUTEX(dht11_lock);		/* 保护 dht11_users 与采样的启停 */
+static int dht11_users;
+static bool dht11_running;
+static struct timer_list dht11_timer;
+static struct work_struct dht11_work;
+static struct completion dht11_edges_done;
 
-static void dht11_start(void)
+static struct dht11_edge dht11_edges[DHT11_EDGES_MAX];
+static int dht11_num_edges;
+
+static DEFINE_SPINLOCK(dht11_cache_lock);
+static struct dht11_reading dht11_cache;
+static DECLARE_WAIT_QUEUE_HEAD(dht11_wq);
+
+/* 只记录边沿的时间与电平，解码在工作队列中完成 */
+static irqreturn_t dht11_irq_handler(int irq, void *dev_id)
 {
-	gpiod_direction_output(dht11_gpio, 0);
-	mdelay(18);
-	gpiod_set_value(dht11_gpio, 1);
-	udelay(30);
+	int n = dht11_num_edges;
+
+	if (n < DHT11_EDGES_MAX) {
+		dht11_edges[n].ts = ktime_get_ns();
+		dht11_edges[n].value = gpiod_get_value(dht11_gpio);
+		dht11_num_edges = ++n;
+
+		/* 传感器释放总线的上升沿是最后一个边沿；主机释放总线时的上升沿可能被记录，也可能没有 */
+		if (n >= DHT11_EDGES_PER_READ && dht11_edges[n - 1].value) {
+			complete(&dht11_edges_done);
+		}
+	}
+
+	return IRQ_HANDLED;
 }
 
-static int dht11_wait_for_ready(void)
+/* 以最后一个上升沿为基准向前取 40 个高电平脉宽，开头多出或缺少应答边沿都不影响 */
+static int dht11_decode(unsigned char *data)
 {
-	int timeout_us = 200;
+	int i;
+	int n = dht11_num_edges;
+	int first = n - 1 - 2 * DHT11_BITS_PER_READ;
 
-	gpiod_direction_input(dht11_gpio);
+	if (first < 0 || !dht11_edges[n - 1].value) {
+		return -ETIMEDOUT;
+	}
+
+	memset(data, 0, 5);
+
+	for (i=0; i<DHT11_BITS_PER_READ; ++i) {
+		const struct dht11_edge *rise = &dht11_edges[first + 2 * i];
+		const struct dht11_edge *fall = rise + 1;
+
+		if (!rise->value || fall->value) {
+			return -EIO;
+		}
 
-	/* 等待低电平 */
-	timeout_us = 200; 
-	while (gpiod_get_value(dht11_gpio) && --timeout_us) {
-		udelay(1);
+		data[i / 8] <<= 1;
+		if (fall->ts - rise->ts > DHT11_BIT_THRESHOLD_NS) {
+			data[i / 8] |= 1;
+		}
 	}
 
-	if (timeout_us == 0) {
-		return -1;
+	if (data[4] != (unsigned char)(data[0] + data[1] + data[2] + data[3])) {
+		return -EIO;
 	}
 
-	/* 等待高电平 */
-	timeout_us = 200;
-	while (!gpiod_get_value(dht11_gpio) && --timeout_us) {
-		udelay(1);
+	return 0;
+}
+
+/* 执行一次传输：起始信号期间睡眠，数据位由中断记录，全程不关中断、不忙等 */
+static int dht11_transfer(unsigned char *data, s64 *timestamp_ns)
+{
+	int ret;
+
+	dht11_num_edges = 0;
+	reinit_completion(&dht11_edges_done);
+
+	gpiod_direction_output(dht11_gpio, 0);
+	usleep_range(DHT11_START_US_MIN, DHT11_START_US_MAX);
+	gpiod_direction_input(dht11_gpio);
+
+	/* 作为中断使用的 GPIO 不能设为输出，中断只在接收期间申请 */
+	ret = request_irq(dht11_irq, dht11_irq_handler, IRQF_TRIGGER_RISING | IRQF_TRIGGER_FALLING, "dht11_irq", NULL);
+	if (ret) {
+		printk(KERN_ERR "aoe: failed to request irq\n");
 	}
-	
-	if (timeout_us == 0) {
-		return -1;
+	else {
+		wait_for_completion_timeout(&dht11_edges_done, msecs_to_jiffies(DHT11_TIMEOUT_MS));
+		free_irq(dht11_irq, NULL);
+		ret = dht11_decode(data);
+		if (ret == 0) {
+			*timestamp_ns = dht11_edges[dht11_num_edges - 1].ts;
+		}
 	}
 
-	/* 等待低电平 */
-	timeout_us = 200;
-	while (gpiod_get_value(dht11_gpio) && --timeout_us) {
-		udelay(1);
-	}
+	gpiod_direction_output(dht11_gpio, 1);
+
+	return ret;
+}
 
-	if (timeout_us == 0) {
-		return -1;
+/* 成功的结果写入缓存，唤醒等待者；IIO 缓冲区打开时同时推入一条记录 */
+static void dht11_store(const unsigned char *data, s64 timestamp_ns)
+{
+	struct {
+		s32 channels[2];	/* 湿度、温度，单位 0.1 */
+		s64 timestamp;
+	} scan;
+
+	spin_lock(&dht11_cache_lock);
+	memcpy(dht11_cache.data, data, sizeof(dht11_cache.data));
+	dht11_cache.timestamp_ns = timestamp_ns;
+	if (++dht11_cache.seq == 0) {
+		dht11_cache.seq = 1;
 	}
+	spin_unlock(&dht11_cache_lock);
 
-	return 0;
+	wake_up_interruptible(&dht11_wq);
+
+	if (dht11_indio && iio_buffer_enabled(dht11_indio)) {
+		memset(&scan, 0, sizeof(scan));
+		scan.channels[0] = data[0] * 10 + data[1];
+		scan.channels[1] = data[2] * 10 + data[3];
+		iio_push_to_buffers_with_timestamp(dht11_indio, &scan, timestamp_ns);
+	}
 }
 
-static int dht11_read_byte(unsigned char *buf)
+/* 采样在工作队列中进行，失败时重试 */
+static void dht11_work_func(struct work_struct *work)
 {
 	int i;
-	int timeout_us = 200;
-	u64 sustained_time_ns = 0;
-	unsigned char data = 0;
-
-	for (i=0; i<8; ++i) {
-		
-		timeout_us = 200;
-		while (!gpiod_get_value(dht11_gpio) && --timeout_us) {  /* 等待高电平 */
-			udelay(1);
-		}
-		if (timeout_us == 0) {
-			return -1;
-		}
+	int ret = -EIO;
+	unsigned char data[5];
+	s64 timestamp_ns = 0;
 
-		timeout_us = 200;
-		sustained_time_ns = ktime_get_ns();
-		while (gpiod_get_value(dht11_gpio) && --timeout_us) {  /* 等待低电平 */
-			udelay(1);
+	for (i=0; i<=retries && READ_ONCE(dht11_running); ++i) {
+		if (i > 0) {
+			msleep(DHT11_RETRY_MS);
 		}
-		if (timeout_us == 0) {
-			return -1;
-		}
-		sustained_time_ns = ktime_get_ns() - sustained_time_ns;
 
-		data <<= 1;
-		if (sustained_time_ns > 40000) {
-			data |=  1;
+		ret = dht11_transfer(data, &timestamp_ns);
+		if (ret == 0) {
+			break;
 		}
 	}
 
-	*buf = data;
-	
-	return 0;
+	if (ret == 0) {
+		dht11_store(data, timestamp_ns);
+	}
+
+	if (READ_ONCE(dht11_running)) {
+		mod_timer(&dht11_timer, jiffies + msecs_to_jiffies(max_t(unsigned int, sample_ms, DHT11_INTERVAL_MIN_MS)));
+	}
 }
 
-static int dht11_wait_for_end(void)
+static void dht11_timer_func(unsigned long data)
 {
-	int timeout_us = 200;
-	/* 等待高电平 */
-	timeout_us = 200;
-	while (!gpiod_get_value(dht11_gpio) && --timeout_us) {
-		udelay(1);
+	schedule_work(&dht11_work);
+}
+
+static void dht11_stop(void)
+{
+	WRITE_ONCE(dht11_running, false);
+
+	/* 工作函数可能在检查标志之前重新启动了定时器，取消后再删除一次 */
+	del_timer_sync(&dht11_timer);
+	cancel_work_sync(&dht11_work);
+	del_timer_sync(&dht11_timer);
+}
+
+/* 设备文件与 IIO 缓冲区都算作使用者，第一个使用者开始后台采样，最后一个停止 */
+static void dht11_get(void)
+{
+	mutex_lock(&dht11_lock);
+	if (dht11_users++ == 0) {
+		WRITE_ONCE(dht11_running, true);
+		schedule_work(&dht11_work);
 	}
+	mutex_unlock(&dht11_lock);
+}
 
-	if (timeout_us == 0) {
-		return -1;
+static void dht11_put(void)
+{
+	mutex_lock(&dht11_lock);
+	if (--dht11_users == 0) {
+		dht11_stop();
 	}
+	mutex_unlock(&dht11_lock);
+}
 
-	return 0;
+static u32 dht11_cache_seq(void)
+{
+	u32 seq;
+
+	spin_lock(&dht11_cache_lock);
+	seq = dht11_cache.seq;
+	spin_unlock(&dht11_cache_lock);
+
+	return seq;
 }
 
+/* 直接返回缓存的结果，不触发传输；尚无结果时阻塞等待或返回 -EAGAIN */
 static ssize_t dht11_read (struct file *file, char __user *buff, size_t size, loff_t *offset)
 {
 	int ret;
-	unsigned long flags;
-	unsigned char data[5];
-	int len = size < 4 ? size : 4;
-	int i;
+	struct dht11_file *priv = file->private_data;
+	struct dht11_reading reading;
+	size_t len = (size >= sizeof(reading)) ? sizeof(reading) : min_t(size_t, size, sizeof(reading.data));
+
+	if (dht11_cache_seq() == 0) {
+		if (file->f_flags & O_NONBLOCK) {
+			return -EAGAIN;
+		}
+		if (wait_event_interruptible(dht11_wq, dht11_cache_seq() != 0)) {
+			return -ERESTARTSYS;
+		}
+	}
 
-	local_irq_save(flags);
+	spin_lock(&dht11_cache_lock);
+	reading = dht11_cache;
+	spin_unlock(&dht11_cache_lock);
 
-	dht11_start();
+	priv->seq = reading.seq;
 
-	if (dht11_wait_for_ready()) {
-		dht11_reset();
-		local_irq_restore(flags);
-		return -1;
-	}
+	ret = copy_to_user(buff, &reading, len);
+	
+	return ret ? -EFAULT : len;
+}
 
-	for (i=0; i<5; ++i) {
-		if (dht11_read_byte(&data[i])) {
-			dht11_reset();
-			local_irq_restore(flags);
-			return -1;
-		}
-	}
+static unsigned int dht11_poll(struct file *file, poll_table *wait)
+{
+	struct dht11_file *priv = file->private_data;
 
-	if (dht11_wait_for_end()) {
-		dht11_reset();
-		local_irq_restore(flags);
-		return -1;
-	}
+	poll_wait(file, &dht11_wq, wait);
 
-	if (data[4] != (unsigned char)(data[0] + data[1] + data[2] + data[3])) {
-		dht11_reset();
-		local_irq_restore(flags);
-		return -1;
+	return (dht11_cache_seq() != priv->seq) ? (POLLIN | POLLRDNORM) : 0;
+}
+
+static int dht11_open (struct inode *inode, struct file *file)
+{
+	struct dht11_file *priv;
+
+	priv = kzalloc(sizeof(*priv), GFP_KERNEL);
+	if (!priv) {
+		return -ENOMEM;
 	}
 
-	dht11_reset();
+	/* 只有打开后的新结果才算新数据，缓存中的旧结果仍可直接读取 */
+	priv->seq = dht11_cache_seq();
+	file->private_data = priv;
 
-	local_irq_restore(flags);
+	dht11_get();
 
-	ret = copy_to_user(buff, &data, len);
-	
-	return ret ? -EFAULT : len;
+	return 0;
+}
+
+static int dht11_release (struct inode *inode, struct file *file)
+{
+	dht11_put();
+
+	kfree(file->private_data);
+
+	return 0;
 }
 
 static const struct file_operations dht11_fops = {
+	.owner          = THIS_MODULE,
 	.read           = dht11_read,
+	.poll           = dht11_poll,
+	.open           = dht11_open,
+	.release        = dht11_release,
+};
+
+/* IIO 接口：湿度与温度两个通道，原始值单位 0.1，乘以 scale 得到 IIO 规定的千分之一 %RH 与千分之一摄氏度
+ * 时间戳为完成接收的时刻，CLOCK_MONOTONIC；缓冲区只在有新结果时推入记录
+ */
+static const struct iio_chan_spec dht11_channels[] = {
+	{
+		.type = IIO_HUMIDITYRELATIVE,
+		.info_mask_separate = BIT(IIO_CHAN_INFO_RAW) | BIT(IIO_CHAN_INFO_SCALE),
+		.scan_index = 0,
+		.scan_type = { .sign = 's', .realbits = 32, .storagebits = 32, .endianness = IIO_CPU },
+	},
+	{
+		.type = IIO_TEMP,
+		.info_mask_separate = BIT(IIO_CHAN_INFO_RAW) | BIT(IIO_CHAN_INFO_SCALE),
+		.scan_index = 1,
+		.scan_type = { .sign = 's', .realbits = 32, .storagebits = 32, .endianness = IIO_CPU },
+	},
+	IIO_CHAN_SOFT_TIMESTAMP(2),
 };
 
+/* 每次推入全部通道，只打开部分通道时由 IIO 核心挑选 */
+static const unsigned long dht11_scan_masks[] = { 0x3, 0 };
+
+/* 直接读取：缓存不超过一个采样间隔时直接返回，否则临时启动采样并等待新结果 */
+static int dht11_read_raw(struct iio_dev *indio_dev, struct iio_chan_spec const *chan, int *val, int *val2, long mask)
+{
+	struct dht11_reading reading;
+	u32 seq;
+	long ret = 0;
+
+	switch (mask) {
+	case IIO_CHAN_INFO_RAW:
+		spin_lock(&dht11_cache_lock);
+		reading = dht11_cache;
+		spin_unlock(&dht11_cache_lock);
+
+		if (reading.seq == 0 || (s64)ktime_get_ns() - reading.timestamp_ns > (s64)max_t(unsigned int, sample_ms, DHT11_INTERVAL_MIN_MS) * NSEC_PER_MSEC) {
+			seq = reading.seq;
+
+			dht11_get();
+			ret = wait_event_interruptible_timeout(dht11_wq, dht11_cache_seq() != seq, msecs_to_jiffies(DHT11_READ_TIMEOUT_MS));
+			dht11_put();
+
+			if (ret < 0) {
+				return ret;
+			}
+			if (ret == 0) {
+				return -ETIMEDOUT;
+			}
+
+			spin_lock(&dht11_cache_lock);
+			reading = dht11_cache;
+			spin_unlock(&dht11_cache_lock);
+		}
+
+		if (chan->type == IIO_TEMP) {
+			*val = reading.data[2] * 10 + reading.data[3];
+		}
+		else {
+			*val = reading.data[0] * 10 + reading.data[1];
+		}
+		return IIO_VAL_INT;
+
+	case IIO_CHAN_INFO_SCALE:
+		*val = 100;
+		return IIO_VAL_INT;
+	}
+
+	return -EINVAL;
+}
+
+static const struct iio_info dht11_iio_info = {
+	.driver_module = THIS_MODULE,
+	.read_raw = dht11_read_raw,
+};
+
+static int dht11_buffer_postenable(struct iio_dev *indio_dev)
+{
+	dht11_get();
+
+	return 0;
+}
+
+static int dht11_buffer_predisable(struct iio_dev *indio_dev)
+{
+	dht11_put();
+
+	return 0;
+}
+
+static const struct iio_buffer_setup_ops dht11_buffer_ops = {
+	.postenable = dht11_buffer_postenable,
+	.predisable = dht11_buffer_predisable,
+};
+
+static int dht11_iio_register(struct device *parent)
+{
+	struct iio_dev *indio_dev;
+	struct iio_buffer *buffer;
+	int ret;
+
+	indio_dev = devm_iio_device_alloc(parent, 0);
+	if (!indio_dev) {
+		return -ENOMEM;
+	}
+
+	buffer = devm_iio_kfifo_allocate(parent);
+	if (!buffer) {
+		return -ENOMEM;
+	}
+
+	indio_dev->name = "dht11";
+	indio_dev->dev.parent = parent;
+	indio_dev->info = &dht11_iio_info;
+	indio_dev->modes = INDIO_DIRECT_MODE | INDIO_BUFFER_SOFTWARE;
+	indio_dev->channels = dht11_channels;
+	indio_dev->num_channels = ARRAY_SIZE(dht11_channels);
+	indio_dev->available_scan_masks = dht11_scan_masks;
+	indio_dev->setup_ops = &dht11_buffer_ops;
+	iio_device_attach_buffer(indio_dev, buffer);
+
+	ret = iio_device_register(indio_dev);
+	if (ret) {
+		return ret;
+	}
+
+	dht11_indio = indio_dev;
+
+	return 0;
+}
+
 static int dht11_probe(struct platform_device *pdev)
 {
 	struct device *dev;
+	int ret;
 
 	dht11_gpio = gpiod_get(&pdev->dev, NULL, GPIOD_OUT_HIGH);
 	if (IS_ERR(dht11_gpio)) {
@@ -194,18 +485,39 @@ static int dht11_probe(struct platform_device *pdev)
 		return PTR_ERR(dht11_gpio);
 	}
 
+	dht11_irq = gpiod_to_irq(dht11_gpio);
+	if (dht11_irq < 0) {
+		gpiod_put(dht11_gpio);
+		printk(KERN_ERR "aoe: failed to translate GPIO to IRQ\n");
+		return dht11_irq;
+	}
+
 	dev = device_create(dht11_class, NULL, MKDEV(dht11_major, 0), NULL, "mydht11");
 	if (IS_ERR(dev)) {
 		gpiod_put(dht11_gpio);
 		printk(KERN_ERR "aoe: can't create device\n");
 		return PTR_ERR(dev);
 	}
+
+	ret = dht11_iio_register(&pdev->dev);
+	if (ret) {
+		device_destroy(dht11_class, MKDEV(dht11_major, 0));
+		gpiod_put(dht11_gpio);
+		printk(KERN_ERR "aoe: can't register iio device\n");
+		return ret;
+	}
 	
 	return 0;
 }	
 
 static int dht11_remove(struct platform_device *pdev)
 {
+	/* 注销时 IIO 核心关闭缓冲区，释放其对采样的引用 */
+	iio_device_unregister(dht11_indio);
+	dht11_indio = NULL;
+
+	dht11_stop();
+
 	device_destroy(dht11_class, MKDEV(dht11_major, 0));
 
 	gpiod_put(dht11_gpio);
@@ -231,6 +543,10 @@ static int __init dht11_init(void)
 {
 	int ret;
 
+	INIT_WORK(&dht11_work, dht11_work_func);
+	setup_timer(&dht11_timer, dht11_timer_func, 0);
+	init_completion(&dht11_edges_done);
+
 	dht11_major = register_chrdev(0, "dht11", &dht11_fops);
 	if (dht11_major < 0) {
 		printk(KERN_ERR "aoe: can't register char device\n");
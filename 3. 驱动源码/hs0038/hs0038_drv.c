@@ -24,90 +24,89 @@
 #include <linux/uaccess.h>
 #include <linux/version.h>
 #include <linux/input.h>
+#include <linux/hrtimer.h>
+#include <linux/spinlock.h>
 
-static struct gpio_desc *hs0038_gpio;
-static unsigned int hs0038_irq;
+#include "nec_decoder.h"
 
-static unsigned int hs0038_pre_data;
+#define HS0038_KEYUP_MS		150	/* 重复码间隔 108 ms，超过该时间没有收到视为松开 */
 
-static u64 hs0038_edge_time[100];
-static int hs0038_edge_cnt;
+static struct gpio_desc *hs0038_gpio;
+static unsigned int hs0038_irq;
 
 static struct input_dev *hs0038_input_dev;
 
-/*
- * 0 成功, *val 中保存数据
- * -1 未接收完成
- * -2 解析错误
- * -3 接收超时
- */
+/* 以下受 hs0038_lock 保护，中断与定时器都会访问 */
+static DEFINE_SPINLOCK(hs0038_lock);
+static struct nec_decoder hs0038_decoder;
+static u64 hs0038_last_edge_ns;
+static unsigned int hs0038_key;		/* 当前按下的按键，0 表示没有 */
+static struct hrtimer hs0038_keyup_timer;
 
-int hs0038_parse_data(unsigned int *val)
+static unsigned int hs0038_keycode(unsigned int code)
 {
-	hs0038_edge_time[hs0038_edge_cnt++] = ktime_get_boot_ns();
+	if (code == 0x5e)      return KEY_1;
+	else if (code == 0x5a) return KEY_2;
+	else if (code == 0x1c) return KEY_3;
+	else if (code == 0x0c) return KEY_4;
 
-	if ((hs0038_edge_cnt >= 2) && (hs0038_edge_time[hs0038_edge_cnt-1] - hs0038_edge_time[hs0038_edge_cnt-2] > 30000000)) {
-		hs0038_edge_time[0] = hs0038_edge_time[hs0038_edge_cnt-1];
-		hs0038_edge_cnt = 1;
-		return -3;
-	}
+	return code;
+}
 
-	if (hs0038_edge_cnt == 3) {
-		u64 tmp1 = hs0038_edge_time[1] - hs0038_edge_time[0];
-		u64 tmp2 = hs0038_edge_time[2] - hs0038_edge_time[1];
-		if ((tmp1 > 8000000 && tmp1 < 10000000) && (tmp2 < 3000000)) {
-			hs0038_edge_cnt = 0;
-			*val = hs0038_pre_data;
-			return 0;
-		}
+/* 调用者持有 hs0038_lock */
+static void hs0038_keyup(void)
+{
+	if (hs0038_key) {
+		input_report_key(hs0038_input_dev, hs0038_key, 0);
+		input_sync(hs0038_input_dev);
+		hs0038_key = 0;
 	}
-	else if (hs0038_edge_cnt >= 68) {
-		unsigned char data[4] = {0};
-		int i, j;
-		int index = 3;
-
-		hs0038_edge_cnt = 0;
-
-		for (i=0; i<4; ++i) {
-			for (j=0; j<8; j++) {
-				if ((hs0038_edge_time[index+1] - hs0038_edge_time[index]) > 1000000) {
-					data[i] |= 1 << j;
-				}
-				index += 2;
-			}
-		}
-
-		data[1] = ~data[1];
-		data[3] = ~data[3];
-		
-		if (data[0] != data[1] || data[2] != data[3]) {
-			return -2;
-		}
+}
 
-		*val = data[0] << 8 | data[2];
-		hs0038_pre_data = *val;
+static enum hrtimer_restart hs0038_keyup_func(struct hrtimer *timer)
+{
+	unsigned long flags;
 
-		return 0;
-	}
+	spin_lock_irqsave(&hs0038_lock, flags);
+	hs0038_keyup();
+	spin_unlock_irqrestore(&hs0038_lock, flags);
 
-	return -1;
+	return HRTIMER_NORESTART;
 }
 
+/* 每个边沿只做一次状态转移；按住期间由输入子系统产生自动重复，松开由定时器判定 */
 static irqreturn_t hs0038_irq_handler(int irq, void *dev_id)
 {
-	unsigned int val = 0;
+	u64 now = ktime_get_ns();
+	unsigned int key;
+	unsigned long flags;
+
+	spin_lock_irqsave(&hs0038_lock, flags);
+
+	switch (nec_decoder_edge(&hs0038_decoder, now - hs0038_last_edge_ns)) {
+	case NEC_FRAME:
+		key = hs0038_keycode(hs0038_decoder.code);
+		if (key != hs0038_key) {
+			hs0038_keyup();
+			hs0038_key = key;
+			input_report_key(hs0038_input_dev, key, 1);
+			input_sync(hs0038_input_dev);
+		}
+		hrtimer_start(&hs0038_keyup_timer, ns_to_ktime(HS0038_KEYUP_MS * NSEC_PER_MSEC), HRTIMER_MODE_REL);
+		break;
 
-	if (hs0038_parse_data(&val) == 0) {
-		if (val == 0x5e)      val = KEY_1;
-		else if (val == 0x5a) val = KEY_2;
-		else if (val == 0x1c) val = KEY_3;
-		else if (val == 0x0c) val = KEY_4;
-	
-		input_event(hs0038_input_dev, EV_KEY, val, 1);
-		input_event(hs0038_input_dev, EV_KEY, val, 0);
-		input_sync(hs0038_input_dev);
+	case NEC_REPEAT:
+		/* 松开之后才收到的重复码无法确定是哪个按键，忽略 */
+		if (hs0038_key) {
+			hrtimer_start(&hs0038_keyup_timer, ns_to_ktime(HS0038_KEYUP_MS * NSEC_PER_MSEC), HRTIMER_MODE_REL);
+		}
+		break;
 	}
 
+	hs0038_last_edge_ns = now;
+
+	spin_unlock_irqrestore(&hs0038_lock, flags);
+
 	return IRQ_HANDLED;
 }
 
@@ -126,12 +125,6 @@ static int hs0038_probe(struct platform_device *pdev)
 		return hs0038_irq;
 	}
 
-	ret = request_irq(hs0038_irq, hs0038_irq_handler, IRQF_TRIGGER_RISING | IRQF_TRIGGER_FALLING, "myhs0038_irq", NULL);
-	if (ret) {
-		gpiod_put(hs0038_gpio);
-		return ret;
-	}
-
 	hs0038_input_dev = devm_input_allocate_device(&pdev->dev);
 	hs0038_input_dev->name = "hs0038";
 	hs0038_input_dev->phys = "hs0038";
@@ -142,7 +135,18 @@ static int hs0038_probe(struct platform_device *pdev)
 
 	ret = input_register_device(hs0038_input_dev);
 	if (ret) {
-		free_irq(hs0038_irq, NULL);
+		gpiod_put(hs0038_gpio);
+		return ret;
+	}
+
+	/* 输入设备注册之后再申请中断，中断处理函数会上报按键 */
+	nec_decoder_reset(&hs0038_decoder);
+	hs0038_key = 0;
+	hs0038_last_edge_ns = ktime_get_ns() - NEC_GAP_NS - 1;
+
+	ret = request_irq(hs0038_irq, hs0038_irq_handler, IRQF_TRIGGER_RISING | IRQF_TRIGGER_FALLING, "myhs0038_irq", NULL);
+	if (ret) {
+		input_unregister_device(hs0038_input_dev);
 		gpiod_put(hs0038_gpio);
 		return ret;
 	}
@@ -152,10 +156,12 @@ static int hs0038_probe(struct platform_device *pdev)
 
 static int hs0038_remove(struct platform_device *pdev)
 {
-	input_unregister_device(hs0038_input_dev);
-
 	free_irq(hs0038_irq, NULL);
 
+	hrtimer_cancel(&hs0038_keyup_timer);
+
+	input_unregister_device(hs0038_input_dev);
+
 	gpiod_put(hs0038_gpio);
 
 	return 0;
@@ -177,6 +183,9 @@ static struct platform_driver hs0038_driver = {
 
 static int __init hs0038_init(void)
 {
+	hrtimer_init(&hs0038_keyup_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	hs0038_keyup_timer.function = hs0038_keyup_func;
+
 	return platform_driver_register(&hs0038_driver);
 }
 
@@ -0,0 +1,139 @@
+#ifndef NEC_DECODER_H
+#define NEC_DECODER_H
+
+/* NEC 红外协议解码，驱动与用户空间的回放工具 nec_replay 共用
+ * 每个边沿调用一次 nec_decoder_edge()，传入与上一个边沿的间隔，常数时间完成
+ *
+ * 帧格式（HS0038 输出低电平有效，驱动在两个边沿都产生中断）：
+ *   引导码 9 ms 脉冲 + 4.5 ms 间隔，32 位数据（地址、地址反码、命令、命令反码，低位在前），结束脉冲
+ *   每位 560 us 脉冲，之后 560 us 间隔为 0，1690 us 间隔为 1
+ *   按住按键时每 108 ms 发送一次重复码：9 ms 脉冲 + 2.25 ms 间隔 + 结束脉冲
+ */
+
+#ifdef __KERNEL__
+#include <linux/types.h>
+#else
+#include <stdint.h>
+typedef uint32_t u32;
+typedef uint64_t u64;
+#endif
+
+#define NEC_GAP_NS		30000000ULL	/* 超过 30 ms 没有边沿，视为新的一帧开始 */
+
+#define NEC_NONE		0
+#define NEC_FRAME		1		/* 收到完整的一帧，code 有效 */
+#define NEC_REPEAT		2		/* 收到重复码 */
+#define NEC_ERROR		3		/* 时序或校验错误，等待下一个引导码 */
+
+enum nec_state {
+	NEC_STATE_IDLE,
+	NEC_STATE_LEADER_PULSE,
+	NEC_STATE_LEADER_SPACE,
+	NEC_STATE_BIT_PULSE,
+	NEC_STATE_BIT_SPACE,
+	NEC_STATE_TRAILER
+};
+
+struct nec_decoder {
+	enum nec_state state;
+	u32 bits;
+	int count;
+	unsigned int code;		/* 地址 << 8 | 命令 */
+};
+
+static inline int nec_in_range(u64 value, u64 min_ns, u64 max_ns)
+{
+	return value >= min_ns && value <= max_ns;
+}
+
+static inline void nec_decoder_reset(struct nec_decoder *dec)
+{
+	dec->state = NEC_STATE_IDLE;
+	dec->bits = 0;
+	dec->count = 0;
+}
+
+/* delta_ns 为本边沿与上一个边沿的间隔；第一个边沿传入大于 NEC_GAP_NS 的值 */
+static inline int nec_decoder_edge(struct nec_decoder *dec, u64 delta_ns)
+{
+	unsigned int addr, naddr, cmd, ncmd;
+
+	/* 长时间没有边沿：本边沿是引导码脉冲的开始 */
+	if (delta_ns > NEC_GAP_NS) {
+		dec->state = NEC_STATE_LEADER_PULSE;
+		return NEC_NONE;
+	}
+
+	switch (dec->state) {
+	case NEC_STATE_IDLE:
+		return NEC_NONE;
+
+	case NEC_STATE_LEADER_PULSE:
+		if (nec_in_range(delta_ns, 8000000, 10000000)) {
+			dec->state = NEC_STATE_LEADER_SPACE;
+		}
+		/* 否则本边沿可能是下一个引导码的开始，状态不变 */
+		return NEC_NONE;
+
+	case NEC_STATE_LEADER_SPACE:
+		if (nec_in_range(delta_ns, 3500000, 5500000)) {
+			dec->bits = 0;
+			dec->count = 0;
+			dec->state = NEC_STATE_BIT_PULSE;
+			return NEC_NONE;
+		}
+		if (nec_in_range(delta_ns, 1750000, 3000000)) {
+			dec->state = NEC_STATE_TRAILER;
+			return NEC_REPEAT;
+		}
+		break;
+
+	case NEC_STATE_BIT_PULSE:
+		if (nec_in_range(delta_ns, 300000, 900000)) {
+			dec->state = NEC_STATE_BIT_SPACE;
+			return NEC_NONE;
+		}
+		break;
+
+	case NEC_STATE_BIT_SPACE:
+		if (nec_in_range(delta_ns, 300000, 1000000)) {
+			/* 0 */
+		}
+		else if (nec_in_range(delta_ns, 1000001, 2500000)) {
+			dec->bits |= 1U << dec->count;
+		}
+		else {
+			break;
+		}
+
+		if (++dec->count < 32) {
+			dec->state = NEC_STATE_BIT_PULSE;
+			return NEC_NONE;
+		}
+
+		dec->state = NEC_STATE_TRAILER;
+
+		addr  = dec->bits & 0xff;
+		naddr = (dec->bits >> 8) & 0xff;
+		cmd   = (dec->bits >> 16) & 0xff;
+		ncmd  = (dec->bits >> 24) & 0xff;
+
+		if ((addr ^ naddr) != 0xff || (cmd ^ ncmd) != 0xff) {
+			return NEC_ERROR;
+		}
+
+		dec->code = addr << 8 | cmd;
+		return NEC_FRAME;
+
+	case NEC_STATE_TRAILER:
+		/* 结束脉冲的后沿 */
+		dec->state = NEC_STATE_IDLE;
+		return NEC_NONE;
+	}
+
+	/* 时序不符：把本边沿当作可能的引导码开始，重新同步 */
+	dec->state = NEC_STATE_LEADER_PULSE;
+	return NEC_ERROR;
+}
+
+#endif /* NEC_DECODER_H */
@@ -0,0 +1,88 @@
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "nec_decoder.h"
+
+/*
+ * nec_replay [file]
+ * 回放录制的边沿间隔，检查解码结果；每行一个间隔，单位微秒，缺省从标准输入读取
+ * 编译：gcc -o nec_replay nec_replay.c
+ */
+
+#define KEYUP_MS	150	/* 与 hs0038_drv.c 中的 HS0038_KEYUP_MS 一致 */
+
+int main(int argc, char **argv)
+{
+	FILE *fp = stdin;
+	struct nec_decoder dec;
+	unsigned long long delta_us;
+	unsigned long long now_us = 0;
+	unsigned long long keyup_us = 0;
+	unsigned int key = 0;
+	int errors = 0;
+
+	if (argc > 2)
+	{
+		printf("Usage: %s [file]\n", argv[0]);
+		return -1;
+	}
+
+	if (argc == 2)
+	{
+		fp = fopen(argv[1], "r");
+		if (!fp)
+		{
+			printf(" can not open %s\n", argv[1]);
+			return -1;
+		}
+	}
+
+	nec_decoder_reset(&dec);
+
+	while (fscanf(fp, "%llu", &delta_us) == 1)
+	{
+		now_us += delta_us;
+
+		/* 与驱动的松开定时器相同：超时发生在本边沿之前 */
+		if (key && now_us >= keyup_us)
+		{
+			printf("%10llu us  up     0x%04x\n", keyup_us, key);
+			key = 0;
+		}
+
+		switch (nec_decoder_edge(&dec, delta_us * 1000))
+		{
+		case NEC_FRAME:
+			if (key != dec.code)
+			{
+				if (key)
+					printf("%10llu us  up     0x%04x\n", now_us, key);
+				key = dec.code;
+				printf("%10llu us  down   0x%04x\n", now_us, key);
+			}
+			keyup_us = now_us + KEYUP_MS * 1000;
+			break;
+
+		case NEC_REPEAT:
+			if (key)
+			{
+				printf("%10llu us  repeat 0x%04x\n", now_us, key);
+				keyup_us = now_us + KEYUP_MS * 1000;
+			}
+			break;
+
+		case NEC_ERROR:
+			printf("%10llu us  error\n", now_us);
+			++errors;
+			break;
+		}
+	}
+
+	if (key)
+		printf("%10llu us  up     0x%04x\n", keyup_us, key);
+
+	if (fp != stdin)
+		fclose(fp);
+
+	return errors ? 1 : 0;
+}
@@ -23,15 +23,69 @@
 #include <linux/spinlock.h>
 #include <linux/spi/spi.h>
 #include <linux/uaccess.h>
+#include <linux/mm.h>
+#include <linux/moduleparam.h>
+#include <linux/mutex.h>
 
 #define OLED_CMD 	0
 #define OLED_DATA 	1
 
+#define OLED_WIDTH		128
+#define OLED_PAGES		8	/* 每页 8 行，字节的 bit0 在最上面 */
+#define OLED_FB_SIZE		(OLED_WIDTH * OLED_PAGES)
+#define OLED_REFRESH_MIN_MS	10
+#define OLED_TEXT_ROWS		4	/* 8x16 字符占两页，每屏 4 行 */
+#define OLED_TEXT_COLS		16
+#define OLED_TX_SIZE		16
+
+/* 硬件滚动方向，对应 SSD1306 的 0x26 / 0x27 / 0x29 / 0x2A 命令 */
+#define OLED_SCROLL_RIGHT		0
+#define OLED_SCROLL_LEFT		1
+#define OLED_SCROLL_VERTICAL_RIGHT	2
+#define OLED_SCROLL_VERTICAL_LEFT	3
+
+/* 写入一行文字：占 row*2、row*2+1 两页，不足 16 个字符的部分（遇到 '\0'）填空格 */
+struct oled_text {
+	unsigned char row;		/* 0-3 */
+	char text[OLED_TEXT_COLS];
+};
+
+/* 由面板自行滚动 start_row 至 end_row 所在的页，设置后不再占用 CPU 与 SPI */
+struct oled_scroll {
+	unsigned char direction;	/* OLED_SCROLL_* */
+	unsigned char start_row;	/* 0-3 */
+	unsigned char end_row;		/* start_row-3 */
+	unsigned char speed;		/* 0 最慢（256 帧移动一列），7 最快（2 帧） */
+	unsigned char vertical_offset;	/* 斜向滚动时每次移动的行数，1-63，水平滚动时忽略 */
+};
+
+#define OLED_IOC_MAGIC		'O'
+#define OLED_IOC_TEXT		_IOW(OLED_IOC_MAGIC, 0, struct oled_text)
+#define OLED_IOC_SCROLL		_IOW(OLED_IOC_MAGIC, 1, struct oled_scroll)
+#define OLED_IOC_SCROLL_STOP	_IO(OLED_IOC_MAGIC, 2)
+
+static unsigned int refresh_ms = 50;
+module_param(refresh_ms, uint, 0644);
+MODULE_PARM_DESC(refresh_ms, "interval in milliseconds for flushing an mmap'ed framebuffer (>= 10)");
+
 static unsigned int oled_major;
 static struct class *oled_class;
 static struct gpio_desc *oled_gpio;
 static struct spi_device *oled_spi_dev;
 
+/* 显存按 SSD1306 的页格式排列：fb[page * 128 + x]
+ * oled_fb 可被 mmap 到用户空间；oled_shadow 为面板上的当前内容，刷新时逐页比较，只发送变化的页
+ */
+static DEFINE_MUTEX(oled_lock);		/* 保护 oled_shadow、oled_dirty 与 SPI 传输 */
+static unsigned char *oled_fb;
+static unsigned char *oled_shadow;
+static unsigned char *oled_tx;		/* 命令缓冲区，OLED_TX_SIZE 字节，SPI 传输需要可 DMA 的内存 */
+static unsigned long oled_dirty;	/* 必须刷新的页，不论内容是否与 oled_shadow 相同 */
+static bool oled_scrolling;		/* 受 oled_lock 保护，oled_scroll_cfg 为当前的滚动设置 */
+static struct oled_scroll oled_scroll_cfg;
+static atomic_t oled_maps = ATOMIC_INIT(0);
+static struct delayed_work oled_flush_work;
+
 const unsigned char oled_asc2_8x16[95][16]=
 {
     {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},// 0
@@ -149,6 +203,8 @@ static int oled_hardware_init(void)
 	
 	ret = ret || oled_write_cmd_data(0xae,OLED_CMD);//关闭显示
 
+	ret = ret || oled_write_cmd_data(0x2e,OLED_CMD);//停止滚动
+
 	ret = ret || oled_write_cmd_data(0x00,OLED_CMD);//设置 lower column address
 	ret = ret || oled_write_cmd_data(0x10,OLED_CMD);//设置 higher column address
 
@@ -191,38 +247,173 @@ static int oled_hardware_init(void)
 	return 0;
 }
 
-void oled_disp_set_pos(int x, int y)
-{ 	
-	oled_write_cmd_data(0xb0+y, OLED_CMD);
-	oled_write_cmd_data((x&0x0f), OLED_CMD); 
-	oled_write_cmd_data(((x&0xf0)>>4) | 0x10,OLED_CMD);
-}   
+/* 调用者持有 oled_lock */
+static int oled_write_cmds(const unsigned char *cmds, int len)
+{
+	memcpy(oled_tx, cmds, len);
+
+	gpiod_set_value(oled_gpio, 0);
+	return spi_write(oled_spi_dev, oled_tx, len);
+}
+
+/* speed 0-7 对应的时间间隔编码，按移动一列所需的帧数从多到少排列：256、128、64、25、5、4、3、2 */
+static const unsigned char oled_scroll_intervals[8] = { 0x03, 0x02, 0x01, 0x06, 0x00, 0x05, 0x04, 0x07 };
+
+/* 按 oled_scroll_cfg 设置并启动硬件滚动，调用者持有 oled_lock */
+static int oled_scroll_start_locked(void)
+{
+	const struct oled_scroll *cfg = &oled_scroll_cfg;
+	unsigned char cmds[OLED_TX_SIZE];
+	int len = 0;
+
+	if (cfg->direction == OLED_SCROLL_RIGHT || cfg->direction == OLED_SCROLL_LEFT) {
+		cmds[len++] = 0x26 + cfg->direction;
+	}
+	else {
+		/* 斜向滚动时整屏 64 行都参与垂直移动 */
+		cmds[len++] = 0xa3;
+		cmds[len++] = 0x00;
+		cmds[len++] = 0x40;
+		cmds[len++] = 0x29 + cfg->direction - OLED_SCROLL_VERTICAL_RIGHT;
+	}
+
+	cmds[len++] = 0x00;
+	cmds[len++] = cfg->start_row * 2;
+	cmds[len++] = oled_scroll_intervals[cfg->speed];
+	cmds[len++] = cfg->end_row * 2 + 1;
+
+	if (cfg->direction == OLED_SCROLL_RIGHT || cfg->direction == OLED_SCROLL_LEFT) {
+		cmds[len++] = 0x00;
+		cmds[len++] = 0xff;
+	}
+	else {
+		cmds[len++] = cfg->vertical_offset;
+	}
+
+	cmds[len++] = 0x2f;
+
+	return oled_write_cmds(cmds, len);
+}
+
+/* 把变化的页写到面板：每页一次命令传输设置地址，一次数据传输发送 128 字节
+ * 滚动期间不能写显存，先停止滚动；停止后面板的显存需要全部重写，写完再按原设置重新启动滚动
+ */
+static int oled_flush(void)
+{
+	static const unsigned char stop = 0x2e;
+	int page;
+	int ret = 0;
+	unsigned long pending;
+	unsigned char *line;
+
+	mutex_lock(&oled_lock);
+
+	pending = oled_dirty;
+	for (page=0; page<OLED_PAGES; ++page) {
+		if (memcmp(oled_shadow + page * OLED_WIDTH, oled_fb + page * OLED_WIDTH, OLED_WIDTH) != 0)
+			set_bit(page, &pending);
+	}
+
+	if (pending == 0)
+		goto out;
+
+	if (oled_scrolling) {
+		ret = oled_write_cmds(&stop, 1);
+		if (ret)
+			goto out;
+
+		pending = (1UL << OLED_PAGES) - 1;
+	}
+
+	oled_dirty = 0;
+
+	for (page=0; page<OLED_PAGES; ++page) {
+		if (!test_bit(page, &pending))
+			continue;
+
+		line = oled_shadow + page * OLED_WIDTH;
+
+		/* 从副本发送，传输期间用户空间仍可修改 oled_fb */
+		memcpy(line, oled_fb + page * OLED_WIDTH, OLED_WIDTH);
+
+		oled_tx[0] = 0xb0 + page;
+		oled_tx[1] = 0x00;
+		oled_tx[2] = 0x10;
+
+		gpiod_set_value(oled_gpio, 0);
+		ret = spi_write(oled_spi_dev, oled_tx, 3);
+		if (ret == 0) {
+			gpiod_set_value(oled_gpio, 1);
+			ret = spi_write(oled_spi_dev, line, OLED_WIDTH);
+		}
+		if (ret) {
+			/* 本页及之后尚未发送的页留到下一次刷新 */
+			oled_dirty = pending & ~((1UL << page) - 1);
+			goto out;
+		}
+	}
+
+	if (oled_scrolling)
+		ret = oled_scroll_start_locked();
+
+out:
+	mutex_unlock(&oled_lock);
+
+	return ret;
+}
+
+static int oled_scroll_stop(void)
+{
+	static const unsigned char stop = 0x2e;
+	int ret = 0;
+
+	mutex_lock(&oled_lock);
+
+	if (oled_scrolling) {
+		ret = oled_write_cmds(&stop, 1);
+		if (ret == 0) {
+			oled_scrolling = false;
+			oled_dirty = (1UL << OLED_PAGES) - 1;
+		}
+	}
+
+	mutex_unlock(&oled_lock);
+
+	return ret ? ret : oled_flush();
+}
+
+/* 显存被映射期间按 refresh_ms 周期刷新，相当于 fbdev 的 deferred I/O */
+static void oled_flush_work_func(struct work_struct *work)
+{
+	oled_flush();
+
+	if (atomic_read(&oled_maps) > 0) {
+		schedule_delayed_work(&oled_flush_work, msecs_to_jiffies(max_t(unsigned int, refresh_ms, OLED_REFRESH_MIN_MS)));
+	}
+}
 
 static void oled_disp_clear(void)  
 {
-    unsigned char x, y;
-    for (y = 0; y < 8; y++)
-    {
-        oled_disp_set_pos(0, y);
-        for (x = 0; x < 128; x++)
-            oled_write_cmd_data(0, OLED_DATA);
-    }
+	memset(oled_fb, 0, OLED_FB_SIZE);
+	oled_flush();
 }
 
 static void oled_disp_char(int x, int y, unsigned char c)
 {
 	int i = 0;
+	const unsigned char *dots;
 
-	const unsigned char *dots = oled_asc2_8x16[c - ' '];
-
-	oled_disp_set_pos(x, y);
-	for (i = 0; i < 8; i++)
-		oled_write_cmd_data(dots[i], OLED_DATA);
+	if (c < ' ' || c > '~')
+		c = ' ';
 
-	oled_disp_set_pos(x, y+1);
+	dots = oled_asc2_8x16[c - ' '];
 
-	for (i = 0; i < 8; i++)
-		oled_write_cmd_data(dots[i+8], OLED_DATA);
+	/* 字符为 8x16，超出右边或底部的部分裁掉 */
+	for (i = 0; i < 8 && x + i < OLED_WIDTH; i++) {
+		oled_fb[y * OLED_WIDTH + x + i] = dots[i];
+		if (y + 1 < OLED_PAGES)
+			oled_fb[(y + 1) * OLED_WIDTH + x + i] = dots[i+8];
+	}
 }
 
 static int oled_open (struct inode *node, struct file *file)
@@ -230,6 +421,9 @@ static int oled_open (struct inode *node, struct file *file)
 	if (oled_hardware_init() != 0)
 		return -EIO;
 
+	/* 重新初始化后面板内容未知，全部重发 */
+	oled_scrolling = false;
+	oled_dirty = (1UL << OLED_PAGES) - 1;
 	oled_disp_clear();
 
 	return 0;
@@ -237,11 +431,13 @@ static int oled_open (struct inode *node, struct file *file)
 
 static int oled_release (struct inode *node, struct file *file)
 {
+	oled_scroll_stop();
 	oled_disp_clear();
 
 	return 0;
 }
 
+/* 旧接口：3 字节（x、page、字符），写入显存后立即刷新，只涉及两页 */
 static ssize_t oled_write (struct file *file, const char __user *buf, size_t size, loff_t *offset)
 {
 	unsigned char kern_buf[3];
@@ -259,57 +455,196 @@ static ssize_t oled_write (struct file *file, const char __user *buf, size_t siz
 
 	oled_disp_char(kern_buf[0], kern_buf[1], kern_buf[2]);
 
+	if (oled_flush())
+		return -EIO;
+
 	return 3;
 }
 
+static void oled_disp_text(const struct oled_text *text)
+{
+	int i;
+	unsigned char c = ' ';
+
+	for (i=0; i<OLED_TEXT_COLS; ++i) {
+		if (c != '\0')
+			c = text->text[i];
+
+		oled_disp_char(i * 8, text->row * 2, c != '\0' ? c : ' ');
+	}
+}
+
+static long oled_ioctl (struct file *file, unsigned int cmd, unsigned long arg)
+{
+	struct oled_text text;
+	struct oled_scroll scroll;
+	bool diagonal;
+
+	switch (cmd) {
+	case OLED_IOC_TEXT:
+		if (copy_from_user(&text, (void __user *)arg, sizeof(text)))
+			return -EFAULT;
+
+		if (text.row >= OLED_TEXT_ROWS)
+			return -EINVAL;
+
+		oled_disp_text(&text);
+
+		return oled_flush() ? -EIO : 0;
+
+	case OLED_IOC_SCROLL:
+		if (copy_from_user(&scroll, (void __user *)arg, sizeof(scroll)))
+			return -EFAULT;
+
+		diagonal = scroll.direction == OLED_SCROLL_VERTICAL_RIGHT || scroll.direction == OLED_SCROLL_VERTICAL_LEFT;
+
+		if (scroll.direction > OLED_SCROLL_VERTICAL_LEFT ||
+		    scroll.end_row >= OLED_TEXT_ROWS || scroll.start_row > scroll.end_row ||
+		    scroll.speed >= ARRAY_SIZE(oled_scroll_intervals) ||
+		    (diagonal && (scroll.vertical_offset < 1 || scroll.vertical_offset > 63))) {
+			return -EINVAL;
+		}
+
+		/* 由 oled_flush() 停止当前的滚动、重写显存后按新设置启动 */
+		mutex_lock(&oled_lock);
+		oled_scroll_cfg = scroll;
+		oled_scrolling = true;
+		oled_dirty = (1UL << OLED_PAGES) - 1;
+		mutex_unlock(&oled_lock);
+
+		return oled_flush() ? -EIO : 0;
+
+	case OLED_IOC_SCROLL_STOP:
+		return oled_scroll_stop() ? -EIO : 0;
+	}
+
+	return -ENOTTY;
+}
+
+/* mmap 后直接修改显存，由定时刷新或 fsync() 写到面板 */
+static int oled_fsync (struct file *file, loff_t start, loff_t end, int datasync)
+{
+	return oled_flush() ? -EIO : 0;
+}
+
+static void oled_vm_open(struct vm_area_struct *vma)
+{
+	atomic_inc(&oled_maps);
+}
+
+static void oled_vm_close(struct vm_area_struct *vma)
+{
+	/* 解除映射前把最后的修改刷新出去 */
+	if (atomic_dec_and_test(&oled_maps))
+		mod_delayed_work(system_wq, &oled_flush_work, 0);
+}
+
+static const struct vm_operations_struct oled_vm_ops = {
+	.open  = oled_vm_open,
+	.close = oled_vm_close,
+};
+
+static int oled_mmap (struct file *file, struct vm_area_struct *vma)
+{
+	int ret;
+	unsigned long size = vma->vm_end - vma->vm_start;
+
+	/* 显存只有 1 KB，映射一页；超出 OLED_FB_SIZE 的部分不显示 */
+	if (vma->vm_pgoff != 0 || size > PAGE_SIZE)
+		return -EINVAL;
+
+	ret = remap_pfn_range(vma, vma->vm_start, virt_to_phys(oled_fb) >> PAGE_SHIFT, size, vma->vm_page_prot);
+	if (ret)
+		return ret;
+
+	vma->vm_ops = &oled_vm_ops;
+	oled_vm_open(vma);
+
+	mod_delayed_work(system_wq, &oled_flush_work, 0);
+
+	return 0;
+}
+
 static struct file_operations oled_fop = {
 	.owner = THIS_MODULE,	
 	.open = oled_open,
 	.release = oled_release,
-	.write = oled_write
+	.write = oled_write,
+	.unlocked_ioctl = oled_ioctl,
+	.mmap = oled_mmap,
+	.fsync = oled_fsync
 };
 
 static int oled_spi_dev_probe(struct spi_device *spi)
 {
 	struct device *dev;
 
+	int ret;
+
 	oled_spi_dev = spi;
 
+	/* 显存占一整页，可以映射到用户空间 */
+	oled_fb = (unsigned char *)get_zeroed_page(GFP_KERNEL);
+	oled_shadow = kzalloc(OLED_FB_SIZE, GFP_KERNEL);
+	oled_tx = kzalloc(OLED_TX_SIZE, GFP_KERNEL);
+	if (!oled_fb || !oled_shadow || !oled_tx) {
+		ret = -ENOMEM;
+		goto err_free;
+	}
+	SetPageReserved(virt_to_page(oled_fb));
+
 	oled_gpio = gpiod_get(&spi->dev, "dc", GPIOD_OUT_HIGH);
 	if (IS_ERR(oled_gpio)) {
-		return PTR_ERR(oled_gpio);
+		ret = PTR_ERR(oled_gpio);
+		goto err_unreserve;
 	}
 
 	oled_major = register_chrdev(0, "myoled", &oled_fop);
 	if (oled_major < 0) {
-		gpiod_put(oled_gpio);
-		return oled_major;
+		ret = oled_major;
+		goto err_gpio;
 	}
 	
 	oled_class = class_create(THIS_MODULE, "myoled");
 	if (IS_ERR(oled_class)) {
-		unregister_chrdev(oled_major, "myoled");
-		gpiod_put(oled_gpio);
-		return PTR_ERR(oled_class);
+		ret = PTR_ERR(oled_class);
+		goto err_chrdev;
 	}
 
 	dev = device_create(oled_class, NULL, MKDEV(oled_major, 0), NULL, "myoled");
 	if (IS_ERR(dev)) {
-		class_destroy(oled_class);
-		unregister_chrdev(oled_major, "myoled");
-		gpiod_put(oled_gpio);
-		return PTR_ERR(dev);
+		ret = PTR_ERR(dev);
+		goto err_class;
 	}
 
 	oled_hardware_init();
 
+	oled_scrolling = false;
+	oled_dirty = (1UL << OLED_PAGES) - 1;
 	oled_disp_clear();
 	
 	return 0;
+
+err_class:
+	class_destroy(oled_class);
+err_chrdev:
+	unregister_chrdev(oled_major, "myoled");
+err_gpio:
+	gpiod_put(oled_gpio);
+err_unreserve:
+	ClearPageReserved(virt_to_page(oled_fb));
+err_free:
+	kfree(oled_tx);
+	kfree(oled_shadow);
+	free_page((unsigned long)oled_fb);
+	return ret;
 }
 
 static int oled_spi_dev_remove(struct spi_device *spi)
 {
+	cancel_delayed_work_sync(&oled_flush_work);
+
+	oled_scroll_stop();
 	oled_disp_clear();
 
 	device_destroy(oled_class, MKDEV(oled_major, 0));
@@ -320,6 +655,11 @@ static int oled_spi_dev_remove(struct spi_device *spi)
 
 	gpiod_put(oled_gpio);
 
+	ClearPageReserved(virt_to_page(oled_fb));
+	free_page((unsigned long)oled_fb);
+	kfree(oled_shadow);
+	kfree(oled_tx);
+
 	return 0;
 }
 
@@ -346,6 +686,8 @@ static struct spi_driver oled_driver = {
 
 static int __init oled_init(void)
 {
+	INIT_DELAYED_WORK(&oled_flush_work, oled_flush_work_func);
+
 	return spi_register_driver(&oled_driver);
 }
 
@@ -22,90 +22,399 @@
 #include <linux/interrupt.h>
 #include <linux/math64.h>
 #include <linux/uaccess.h>
+#include <linux/hrtimer.h>
+#include <linux/kfifo.h>
+#include <linux/moduleparam.h>
+#include <linux/mutex.h>
+#include <linux/poll.h>
+#include <linux/spinlock.h>
+#include <linux/iio/iio.h>
+#include <linux/iio/buffer.h>
+#include <linux/iio/kfifo_buf.h>
+
+#define SR04_RATE_MAX_HZ	40		/* 回波最长约 25 ms（4 m） */
+#define SR04_MEDIAN_MAX		9
+#define SR04_FIFO_SIZE		64		/* 20 Hz 时可缓存约 3 s */
+#define SR04_RANGE_MIN_MM	20
+#define SR04_RANGE_MAX_MM	4500
+#define SR04_READ_TIMEOUT_MS	500		/* IIO 直接读取等待回波的时间 */
+
+/* read() 每次返回若干个完整的样本；读取少于 16 字节时只返回最新距离（int，毫米），与旧版本兼容 */
+struct sr04_sample {
+	s64 timestamp_ns;	/* 发出超声波的时刻，CLOCK_MONOTONIC */
+	u32 distance_mm;	/* 中值滤波后的距离 */
+	u32 raw_mm;		/* 本次回波的距离 */
+};
+
+static unsigned int rate_hz = 20;
+module_param(rate_hz, uint, 0644);
+MODULE_PARM_DESC(rate_hz, "ranging rate in Hz (1-40)");
+
+static unsigned int median = 5;
+module_param(median, uint, 0644);
+MODULE_PARM_DESC(median, "median filter length over the last echoes (1 disables, max 9)");
 
 static int sr04_major;
 static struct class *sr04_class;
 static struct gpio_desc *sr04_trig;
 static struct gpio_desc *sr04_echo;
 
-static unsigned int sr04_irq;
-static u64 sr04_data_ns;
-static wait_queue_head_t sr04_wq;
+static int sr04_irq;
+static struct iio_dev *sr04_indio;
+static DEFINE_MUTEX(sr04_lock);		/* 保护 sr04_users 与读端 */
+static int sr04_users;
+static struct hrtimer sr04_timer;
+static DECLARE_WAIT_QUEUE_HEAD(sr04_wq);
+static DEFINE_KFIFO(sr04_fifo, struct sr04_sample, SR04_FIFO_SIZE);
+
+/* 最新的样本，供 IIO 直接读取；sr04_last_seq 每个样本加一 */
+static DEFINE_SPINLOCK(sr04_last_lock);
+static struct sr04_sample sr04_last;
+static u32 sr04_last_seq;
+
+/* 以下只在定时器与回波中断中访问 */
+static s64 sr04_ping_ns;
+static s64 sr04_echo_ns;		/* 回波上升沿时刻，0 表示尚未收到 */
+static u32 sr04_history[SR04_MEDIAN_MAX];
+static unsigned int sr04_history_len;
+static unsigned int sr04_history_pos;
+static unsigned long sr04_overruns;
+
+static u32 sr04_median(u32 raw_mm)
+{
+	u32 sorted[SR04_MEDIAN_MAX];
+	unsigned int n = clamp_t(unsigned int, median, 1, SR04_MEDIAN_MAX);
+	unsigned int i, j;
+
+	sr04_history[sr04_history_pos] = raw_mm;
+	sr04_history_pos = (sr04_history_pos + 1) % SR04_MEDIAN_MAX;
+	if (sr04_history_len < SR04_MEDIAN_MAX) {
+		++sr04_history_len;
+	}
+
+	n = min(n, sr04_history_len);
+
+	/* 取最近 n 个值插入排序，n 不超过 9 */
+	for (i=0; i<n; ++i) {
+		u32 value = sr04_history[(sr04_history_pos + SR04_MEDIAN_MAX - 1 - i) % SR04_MEDIAN_MAX];
+		for (j=i; j>0 && sorted[j - 1] > value; --j) {
+			sorted[j] = sorted[j - 1];
+		}
+		sorted[j] = value;
+	}
+
+	return sorted[n / 2];
+}
 
 static irqreturn_t sr04_irq_handler(int irq, void *dev_id)
 {
-	int val = gpiod_get_value(sr04_echo);
+	s64 now = ktime_get_ns();
+	struct sr04_sample sample;
+	u32 raw_mm;
 
-	if (val) {
-		sr04_data_ns = ktime_get_ns();	
+	if (gpiod_get_value(sr04_echo)) {
+		sr04_echo_ns = now;
+		return IRQ_HANDLED;
 	}
-	else {
-		sr04_data_ns = ktime_get_ns() - sr04_data_ns;
 
-		do_div(sr04_data_ns, 10);
-	
-		wake_up(&sr04_wq);
+	if (sr04_echo_ns == 0) {
+		return IRQ_HANDLED;
+	}
+
+	/* 声速 340 m/s，往返：每微秒 0.17 毫米 */
+	raw_mm = (u32)div_u64((u64)(now - sr04_echo_ns) * 17, 100000);
+	sr04_echo_ns = 0;
+
+	if (raw_mm < SR04_RANGE_MIN_MM || raw_mm > SR04_RANGE_MAX_MM) {
+		return IRQ_HANDLED;
+	}
+
+	sample.timestamp_ns = sr04_ping_ns;
+	sample.raw_mm = raw_mm;
+	sample.distance_mm = sr04_median(raw_mm);
+
+	/* 队列满时丢弃新样本；单生产者单消费者，无需加锁 */
+	if (!kfifo_put(&sr04_fifo, sample)) {
+		++sr04_overruns;
+	}
+
+	spin_lock(&sr04_last_lock);
+	sr04_last = sample;
+	++sr04_last_seq;
+	spin_unlock(&sr04_last_lock);
+
+	wake_up_interruptible(&sr04_wq);
+
+	if (sr04_indio && iio_buffer_enabled(sr04_indio)) {
+		struct {
+			u32 channels[2];	/* 滤波后的距离、原始距离，毫米 */
+			s64 timestamp;
+		} scan = { { sample.distance_mm, sample.raw_mm }, 0 };
+
+		iio_push_to_buffers_with_timestamp(sr04_indio, &scan, sample.timestamp_ns);
 	}
 
 	return IRQ_HANDLED;
 }
 
-static ssize_t sr04_read (struct file *file, char __user *buff, size_t size, loff_t *offset)
+/* 按 rate_hz 周期发出触发脉冲；上一次回波尚未结束时视为超时丢弃 */
+static enum hrtimer_restart sr04_timer_func(struct hrtimer *timer)
 {
+	unsigned int hz = clamp_t(unsigned int, rate_hz, 1, SR04_RATE_MAX_HZ);
+
+	sr04_echo_ns = 0;
+	sr04_ping_ns = ktime_get_ns();
+
 	gpiod_set_value(sr04_trig, 1);
 	udelay(11);
 	gpiod_set_value(sr04_trig, 0);
 
-	if (wait_event_interruptible_timeout(sr04_wq, sr04_data_ns, msecs_to_jiffies(1500)) > 0) {
-		int ret;
-		int len = size < sizeof(4) ? size : sizeof(4);
-		int distance_cm;
+	hrtimer_forward_now(timer, ns_to_ktime(NSEC_PER_SEC / hz));
 
-		do_div(sr04_data_ns, 1000);
-		distance_cm = (int)(sr04_data_ns) * 340 / 2 / 100;
-		ret = copy_to_user(buff, &distance_cm, len);
-		sr04_data_ns = 0;
-		
-		return ret ? -EFAULT : len;
+	return HRTIMER_RESTART;
+}
+
+static ssize_t sr04_read (struct file *file, char __user *buff, size_t size, loff_t *offset)
+{
+	int ret;
+	unsigned int copied = 0;
+
+	if (kfifo_is_empty(&sr04_fifo)) {
+		if (file->f_flags & O_NONBLOCK) {
+			return -EAGAIN;
+		}
+		if (wait_event_interruptible(sr04_wq, !kfifo_is_empty(&sr04_fifo))) {
+			return -ERESTARTSYS;
+		}
+	}
+
+	if (mutex_lock_interruptible(&sr04_lock)) {
+		return -ERESTARTSYS;
 	}
 
-	return -EAGAIN;
+	if (size < sizeof(struct sr04_sample)) {
+		/* 旧接口：取出所有样本，只返回最新的距离 */
+		struct sr04_sample sample = {0};
+		int distance;
+		int len = (size < sizeof(distance)) ? size : sizeof(distance);
+
+		while (kfifo_get(&sr04_fifo, &sample)) {
+		}
+
+		distance = sample.distance_mm;
+		ret = copy_to_user(buff, &distance, len);
+		copied = len;
+	}
+	else {
+		ret = kfifo_to_user(&sr04_fifo, buff, size - size % sizeof(struct sr04_sample), &copied);
+	}
+
+	mutex_unlock(&sr04_lock);
+
+	return ret ? -EFAULT : copied;
 }
 
-static int sr04_open (struct inode *inode, struct file *file)
+static unsigned int sr04_poll(struct file *file, poll_table *wait)
+{
+	poll_wait(file, &sr04_wq, wait);
+
+	return kfifo_is_empty(&sr04_fifo) ? 0 : (POLLIN | POLLRDNORM);
+}
+
+/* 设备文件与 IIO 缓冲区都算作使用者，第一个使用者开始测距，最后一个停止 */
+static int sr04_get(void)
 {
 	int ret = 0;
-	sr04_irq = gpiod_to_irq(sr04_echo);
-	if (sr04_irq < 0) {
-		printk(KERN_ERR "aoe: failed to translate GPIO to IRQ\n");
-		return sr04_irq;
-	}
 
-	ret = request_irq(sr04_irq, sr04_irq_handler, IRQF_TRIGGER_RISING | IRQF_TRIGGER_FALLING, "sr04_irq", NULL);
-	if (ret) {
-		printk(KERN_ERR "aoe: failed to request irq\n");
-		return ret;
+	mutex_lock(&sr04_lock);
+
+	if (sr04_users == 0) {
+		ret = request_irq(sr04_irq, sr04_irq_handler, IRQF_TRIGGER_RISING | IRQF_TRIGGER_FALLING, "sr04_irq", NULL);
+		if (ret) {
+			mutex_unlock(&sr04_lock);
+			printk(KERN_ERR "aoe: failed to request irq\n");
+			return ret;
+		}
+
+		kfifo_reset(&sr04_fifo);
+		sr04_history_len = 0;
+		sr04_history_pos = 0;
+		hrtimer_start(&sr04_timer, ktime_set(0, 0), HRTIMER_MODE_REL);
 	}
 
+	++sr04_users;
+
+	mutex_unlock(&sr04_lock);
+
 	return ret;
 }
 
+static void sr04_put(void)
+{
+	mutex_lock(&sr04_lock);
+
+	if (--sr04_users == 0) {
+		hrtimer_cancel(&sr04_timer);
+		free_irq(sr04_irq, NULL);
+		gpiod_set_value(sr04_trig, 0);
+	}
+
+	mutex_unlock(&sr04_lock);
+}
+
+static int sr04_open (struct inode *inode, struct file *file)
+{
+	return sr04_get();
+}
+
 static int sr04_release (struct inode *inode, struct file *file)
 {
-	free_irq(sr04_irq, NULL);
+	sr04_put();
 	
 	return 0;
 }
 
 static const struct file_operations sr04_fops = {
+	.owner          = THIS_MODULE,
 	.read           = sr04_read,
+	.poll           = sr04_poll,
 	.open           = sr04_open,
 	.release        = sr04_release
 };
 
+/* IIO 接口：通道 0 为中值滤波后的距离，通道 1 为本次回波的距离，原始值单位毫米，scale 换算为米
+ * 时间戳为发出超声波的时刻，CLOCK_MONOTONIC
+ */
+static const struct iio_chan_spec sr04_channels[] = {
+	{
+		.type = IIO_DISTANCE,
+		.indexed = 1,
+		.channel = 0,
+		.info_mask_separate = BIT(IIO_CHAN_INFO_RAW),
+		.info_mask_shared_by_type = BIT(IIO_CHAN_INFO_SCALE),
+		.scan_index = 0,
+		.scan_type = { .sign = 'u', .realbits = 32, .storagebits = 32, .endianness = IIO_CPU },
+	},
+	{
+		.type = IIO_DISTANCE,
+		.indexed = 1,
+		.channel = 1,
+		.info_mask_separate = BIT(IIO_CHAN_INFO_RAW),
+		.info_mask_shared_by_type = BIT(IIO_CHAN_INFO_SCALE),
+		.scan_index = 1,
+		.scan_type = { .sign = 'u', .realbits = 32, .storagebits = 32, .endianness = IIO_CPU },
+	},
+	IIO_CHAN_SOFT_TIMESTAMP(2),
+};
+
+/* 每次推入全部通道，只打开部分通道时由 IIO 核心挑选 */
+static const unsigned long sr04_scan_masks[] = { 0x3, 0 };
+
+/* 直接读取：等待下一次有效回波，没有使用者时临时启动测距 */
+static int sr04_read_raw(struct iio_dev *indio_dev, struct iio_chan_spec const *chan, int *val, int *val2, long mask)
+{
+	struct sr04_sample sample;
+	u32 seq;
+	long ret;
+
+	switch (mask) {
+	case IIO_CHAN_INFO_RAW:
+		spin_lock_irq(&sr04_last_lock);
+		seq = sr04_last_seq;
+		spin_unlock_irq(&sr04_last_lock);
+
+		ret = sr04_get();
+		if (ret) {
+			return ret;
+		}
+		ret = wait_event_interruptible_timeout(sr04_wq, READ_ONCE(sr04_last_seq) != seq, msecs_to_jiffies(SR04_READ_TIMEOUT_MS));
+		sr04_put();
+
+		if (ret < 0) {
+			return ret;
+		}
+		if (ret == 0) {
+			return -ETIMEDOUT;
+		}
+
+		spin_lock_irq(&sr04_last_lock);
+		sample = sr04_last;
+		spin_unlock_irq(&sr04_last_lock);
+
+		*val = (chan->channel == 0) ? sample.distance_mm : sample.raw_mm;
+		return IIO_VAL_INT;
+
+	case IIO_CHAN_INFO_SCALE:
+		*val = 0;
+		*val2 = 1000;
+		return IIO_VAL_INT_PLUS_MICRO;
+	}
+
+	return -EINVAL;
+}
+
+static const struct iio_info sr04_iio_info = {
+	.driver_module = THIS_MODULE,
+	.read_raw = sr04_read_raw,
+};
+
+static int sr04_buffer_postenable(struct iio_dev *indio_dev)
+{
+	return sr04_get();
+}
+
+static int sr04_buffer_predisable(struct iio_dev *indio_dev)
+{
+	sr04_put();
+
+	return 0;
+}
+
+static const struct iio_buffer_setup_ops sr04_buffer_ops = {
+	.postenable = sr04_buffer_postenable,
+	.predisable = sr04_buffer_predisable,
+};
+
+static int sr04_iio_register(struct device *parent)
+{
+	struct iio_dev *indio_dev;
+	struct iio_buffer *buffer;
+	int ret;
+
+	indio_dev = devm_iio_device_alloc(parent, 0);
+	if (!indio_dev) {
+		return -ENOMEM;
+	}
+
+	buffer = devm_iio_kfifo_allocate(parent);
+	if (!buffer) {
+		return -ENOMEM;
+	}
+
+	indio_dev->name = "sr04";
+	indio_dev->dev.parent = parent;
+	indio_dev->info = &sr04_iio_info;
+	indio_dev->modes = INDIO_DIRECT_MODE | INDIO_BUFFER_SOFTWARE;
+	indio_dev->channels = sr04_channels;
+	indio_dev->num_channels = ARRAY_SIZE(sr04_channels);
+	indio_dev->available_scan_masks = sr04_scan_masks;
+	indio_dev->setup_ops = &sr04_buffer_ops;
+	iio_device_attach_buffer(indio_dev, buffer);
+
+	ret = iio_device_register(indio_dev);
+	if (ret) {
+		return ret;
+	}
+
+	sr04_indio = indio_dev;
+
+	return 0;
+}
+
 static int sr04_probe(struct platform_device *pdev)
 {
 	struct device *dev;
+	int ret;
 
 	sr04_trig = gpiod_get(&pdev->dev, "trig", GPIOD_OUT_LOW);
 	if (IS_ERR(sr04_trig)) {
@@ -119,6 +428,14 @@ static int sr04_probe(struct platform_device *pdev)
 		printk(KERN_ERR "aoe: can't get echo-gpios\n");
 		return PTR_ERR(sr04_echo);
 	}
+
+	sr04_irq = gpiod_to_irq(sr04_echo);
+	if (sr04_irq < 0) {
+		gpiod_put(sr04_trig);
+		gpiod_put(sr04_echo);
+		printk(KERN_ERR "aoe: failed to translate GPIO to IRQ\n");
+		return sr04_irq;
+	}
 	
 	dev = device_create(sr04_class, NULL, MKDEV(sr04_major, 0), NULL, "sr04");
 	if (IS_ERR(dev)) {
@@ -127,12 +444,25 @@ static int sr04_probe(struct platform_device *pdev)
 		printk(KERN_ERR "aoe: can't create device\n");
 		return PTR_ERR(dev);
 	}
+
+	ret = sr04_iio_register(&pdev->dev);
+	if (ret) {
+		device_destroy(sr04_class, MKDEV(sr04_major, 0));
+		gpiod_put(sr04_trig);
+		gpiod_put(sr04_echo);
+		printk(KERN_ERR "aoe: can't register iio device\n");
+		return ret;
+	}
 	
 	return 0;
 }	
 
 static int sr04_remove(struct platform_device *pdev)
 {
+	/* 注销时 IIO 核心关闭缓冲区，释放其对测距的引用 */
+	iio_device_unregister(sr04_indio);
+	sr04_indio = NULL;
+
 	device_destroy(sr04_class, MKDEV(sr04_major, 0));
 
 	gpiod_put(sr04_trig);
@@ -159,7 +489,8 @@ static int __init sr04_init(void)
 {
 	int ret;
 
-	init_waitqueue_head(&sr04_wq);
+	hrtimer_init(&sr04_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	sr04_timer.function = sr04_timer_func;
 
 	sr04_major = register_chrdev(0, "sr04", &sr04_fops);
 	if (sr04_major < 0) {
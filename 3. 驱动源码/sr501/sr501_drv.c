@@ -20,19 +20,71 @@
 #include <linux/of_irq.h>
 #include <linux/uaccess.h>
 #include <linux/interrupt.h>
+#include <linux/kfifo.h>
+#include <linux/list.h>
+#include <linux/mutex.h>
+#include <linux/poll.h>
+#include <linux/spinlock.h>
+
+#define SR501_EVENTS_PER_FILE	16
+
+/* read() 每次返回若干个完整的事件；读取少于 16 字节时返回电平（int），与旧版本兼容 */
+struct sr501_event {
+	s64 timestamp_ns;	/* 电平变化的时刻，CLOCK_MONOTONIC */
+	u32 value;		/* 1 有人，0 无人 */
+	u32 seq;		/* 每个边沿加一，不连续说明队列满时丢弃了旧事件 */
+};
+
+/* 每个打开的文件有自己的事件队列，打开时先放入当前电平 */
+struct sr501_file {
+	struct list_head node;
+	struct fasync_struct *fasync;
+	DECLARE_KFIFO(events, struct sr501_event, SR501_EVENTS_PER_FILE);
+};
 
 static int sr501_major;
 static struct class *sr501_class;
 static struct gpio_desc *sr501_gpio;
-static unsigned int sr501_irq;
-static int sr501_data = 0;
+static int sr501_irq;
 static wait_queue_head_t sr501_wq;
 
+static DEFINE_MUTEX(sr501_lock);	/* 保护 sr501_users 与中断的申请、释放 */
+static int sr501_users;
+
+static DEFINE_SPINLOCK(sr501_files_lock);	/* 保护 sr501_files、各文件的队列与 sr501_seq */
+static LIST_HEAD(sr501_files);
+static u32 sr501_seq;
+
+/* 调用者持有 sr501_files_lock；队列满时丢弃最旧的事件，最新状态总能读到 */
+static void sr501_push(struct sr501_file *priv, const struct sr501_event *event)
+{
+	if (kfifo_is_full(&priv->events)) {
+		kfifo_skip(&priv->events);
+	}
+
+	kfifo_put(&priv->events, *event);
+}
+
 static irqreturn_t sr501_irq_handler(int irq, void *dev_id)
 {
-	sr501_data = 0x80 | gpiod_get_value(sr501_gpio);
+	struct sr501_event event;
+	struct sr501_file *priv;
+
+	event.timestamp_ns = ktime_get_ns();
+	event.value = gpiod_get_value(sr501_gpio);
 
-	wake_up(&sr501_wq);
+	spin_lock(&sr501_files_lock);
+
+	event.seq = ++sr501_seq;
+
+	list_for_each_entry(priv, &sr501_files, node) {
+		sr501_push(priv, &event);
+		kill_fasync(&priv->fasync, SIGIO, POLL_IN);
+	}
+
+	spin_unlock(&sr501_files_lock);
+
+	wake_up_interruptible(&sr501_wq);
 
 	return IRQ_HANDLED;
 }
@@ -40,57 +92,132 @@ static irqreturn_t sr501_irq_handler(int irq, void *dev_id)
 static ssize_t sr501_read (struct file *file, char __user *buff, size_t size, loff_t *offset)
 {
 	int ret;
-	int len = (size < 4) ? size : 4;
+	struct sr501_file *priv = file->private_data;
+	struct sr501_event events[SR501_EVENTS_PER_FILE];
+	unsigned int count;
 
-	if (file->f_flags & O_NONBLOCK) {
+	if (size < sizeof(struct sr501_event) && (file->f_flags & O_NONBLOCK)) {
+		/* 旧接口：非阻塞读取直接返回当前电平 */
 		int value = gpiod_get_value(sr501_gpio);
-		ret = copy_to_user(buff, &value, (size < 4) ? size : 4);
+		int len = (size < 4) ? size : 4;
+
+		ret = copy_to_user(buff, &value, len);
 		return ret ? -EFAULT : len;
 	}
-	else if (wait_event_interruptible(sr501_wq, sr501_data) == 0) {
-		sr501_data &= ~(0x80);
-		ret = copy_to_user(buff, &sr501_data, len);
-		sr501_data = 0;
 
+	if (kfifo_is_empty(&priv->events)) {
+		if (file->f_flags & O_NONBLOCK) {
+			return -EAGAIN;
+		}
+		if (wait_event_interruptible(sr501_wq, !kfifo_is_empty(&priv->events))) {
+			return -ERESTARTSYS;
+		}
+	}
+
+	count = (size < sizeof(struct sr501_event)) ? 1 : min_t(size_t, size / sizeof(struct sr501_event), SR501_EVENTS_PER_FILE);
+
+	spin_lock_irq(&sr501_files_lock);
+	count = kfifo_out(&priv->events, events, count);
+	spin_unlock_irq(&sr501_files_lock);
+
+	if (size < sizeof(struct sr501_event)) {
+		/* 旧接口：阻塞读取等到下一次电平变化 */
+		int value = events[0].value;
+		int len = (size < 4) ? size : 4;
+
+		ret = copy_to_user(buff, &value, len);
 		return ret ? -EFAULT : len;
 	}
 
-	return -EAGAIN;
+	ret = copy_to_user(buff, events, count * sizeof(struct sr501_event));
+
+	return ret ? -EFAULT : count * sizeof(struct sr501_event);
+}
+
+static unsigned int sr501_poll(struct file *file, poll_table *wait)
+{
+	struct sr501_file *priv = file->private_data;
+
+	poll_wait(file, &sr501_wq, wait);
+
+	return kfifo_is_empty(&priv->events) ? 0 : (POLLIN | POLLRDNORM);
+}
+
+static int sr501_fasync(int fd, struct file *file, int on)
+{
+	struct sr501_file *priv = file->private_data;
+
+	return fasync_helper(fd, file, on, &priv->fasync);
 }
 
 static int sr501_open (struct inode *inode, struct file *file)
 {
 	int ret = 0;
+	struct sr501_file *priv;
+	struct sr501_event event;
 
-	if (!(file->f_flags & O_NONBLOCK)) {
-		
-		sr501_irq = gpiod_to_irq(sr501_gpio);
-		if (sr501_irq < 0) {
-			printk(KERN_ERR "aoe: failed to translate GPIO to IRQ\n");
-			return sr501_irq;
-		}
+	priv = kzalloc(sizeof(*priv), GFP_KERNEL);
+	if (!priv) {
+		return -ENOMEM;
+	}
+
+	INIT_KFIFO(priv->events);
+	file->private_data = priv;
 
+	mutex_lock(&sr501_lock);
+
+	if (sr501_users == 0) {
 		ret = request_irq(sr501_irq, sr501_irq_handler, IRQF_TRIGGER_RISING | IRQF_TRIGGER_FALLING, "sr501_irq", NULL);
 		if (ret) {
+			mutex_unlock(&sr501_lock);
+			kfree(priv);
 			printk(KERN_ERR "aoe: failed to request irq\n");
 			return ret;
 		}
 	}
-		
-	return ret;
+
+	++sr501_users;
+
+	/* 先登记再读取电平，之后的变化都会进入队列 */
+	spin_lock_irq(&sr501_files_lock);
+	list_add_tail(&priv->node, &sr501_files);
+	event.timestamp_ns = ktime_get_ns();
+	event.value = gpiod_get_value(sr501_gpio);
+	event.seq = sr501_seq;
+	sr501_push(priv, &event);
+	spin_unlock_irq(&sr501_files_lock);
+
+	mutex_unlock(&sr501_lock);
+
+	return 0;
 }
 
 static int sr501_release (struct inode *inode, struct file *file)
 {
-	if (!(file->f_flags & O_NONBLOCK)) {
+	struct sr501_file *priv = file->private_data;
+
+	mutex_lock(&sr501_lock);
+
+	spin_lock_irq(&sr501_files_lock);
+	list_del(&priv->node);
+	spin_unlock_irq(&sr501_files_lock);
+
+	if (--sr501_users == 0) {
 		free_irq(sr501_irq, NULL);
 	}
 
+	mutex_unlock(&sr501_lock);
+
+	kfree(priv);
+
 	return 0;
 }
 
 static const struct file_operations sr501_fops = {
+	.owner          = THIS_MODULE,
 	.read           = sr501_read,
+	.poll           = sr501_poll,
+	.fasync         = sr501_fasync,
 	.open           = sr501_open,
 	.release        = sr501_release
 };
@@ -113,9 +240,15 @@ static int sr501_probe(struct platform_device *pdev)
 		return ret;
 	}
 
+	sr501_irq = gpiod_to_irq(sr501_gpio);
+	if (sr501_irq < 0) {
+		gpiod_put(sr501_gpio);
+		printk(KERN_ERR "aoe: failed to translate GPIO to IRQ\n");
+		return sr501_irq;
+	}
+
 	dev = device_create(sr501_class, NULL, MKDEV(sr501_major, 0), NULL, "sr501");
 	if (IS_ERR(dev)) {
-		free_irq(sr501_irq, NULL);
 		gpiod_put(sr501_gpio);
 		printk(KERN_ERR "aoe: can't create device\n");
 		return PTR_ERR(dev);